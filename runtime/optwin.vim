@@ -261,6 +261,10 @@ call append("$", "magic\tchange the way backslashes are used in search patterns"
 call <SID>BinOptionG("magic", &magic)
 call append("$", "regexpengine\tselect the default regexp engine used")
 call <SID>OptionG("re", &re)
+if has("reltime")
+  call append("$", "regexptimeout\tmaximum time in msec for matching a pattern")
+  call <SID>OptionG("rxt", &rxt)
+endif
 call append("$", "ignorecase\tignore case when using a search pattern")
 call <SID>BinOptionG("ic", &ic)
 call append("$", "smartcase\toverride 'ignorecase' when pattern has upper case characters")
@@ -367,6 +371,10 @@ call <SID>BinOptionG("lz", &lz)
 if has("reltime")
   call append("$", "redrawtime\ttimeout for 'hlsearch' and :match highlighting in msec")
   call append("$", " \tset rdt=" . &rdt)
+  if has("syntax")
+    call append("$", "syndefer\ttime in msec for syntax highlighting when redrawing")
+    call append("$", " \tset sdf=" . &sdf)
+  endif
 endif
 call append("$", "writedelay\tdelay in msec for each char written to the display")
 call append("$", "\t(for debugging)")
@@ -410,6 +418,10 @@ if has("syntax")
   call append("$", "synmaxcol\tmaximum column to look for syntax items")
   call append("$", "\t(local to buffer)")
   call <SID>OptionL("smc")
+  if exists("+syncachedir")
+    call append("$", "syncachedir\tdirectory to cache compiled syntax patterns in")
+    call <SID>OptionG("scd", &scd)
+  endif
 endif
 call append("$", "highlight\twhich highlighting to use for various occasions")
 call <SID>OptionG("hl", &hl)
@@ -1082,6 +1094,10 @@ call append("$", "maxmem\tmaximum amount of memory in Kbyte used for one buffer"
 call append("$", " \tset mm=" . &mm)
 call append("$", "maxmemtot\tmaximum amount of memory in Kbyte used for all buffers")
 call append("$", " \tset mmt=" . &mmt)
+call append("$", "memcompress\tcompress text not used recently in buffers without a swap file")
+call <SID>BinOptionG("mcp", &mcp)
+call append("$", "lazyload\tminimal size in Kbyte of a file to read lines only when used")
+call append("$", " \tset lzl=" . &lzl)
 
 
 call <SID>Header("command line editing")
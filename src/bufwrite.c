@@ -1628,6 +1628,14 @@ buf_write(
     if (buf->b_ml.ml_flags & ML_EMPTY)
 	start = end + 1;
 
+    // When lines of the buffer are still to be read from the original file
+    // they must be read now, before it gets overwritten.
+    if (overwriting && !append && ml_lazy_load_all(buf) == FAIL)
+    {
+	errmsg = (char_u *)_(e_interr);
+	goto restore_backup;
+    }
+
     // If the original file is being overwritten, there is a small chance that
     // we crash in the middle of writing. Therefore the file is preserved now.
     // This makes all block numbers positive so that recovery does not need
@@ -446,6 +446,11 @@ changed_common(
     // mark the buffer as modified
     changed();
 
+#ifdef FEAT_SEARCH_EXTRA
+    // forget the cached 'hlsearch' and match results for the changed lines
+    hlcache_changed(curbuf, lnum, lnume, xtra);
+#endif
+
 #ifdef FEAT_EVAL
     may_record_change(lnum, col, lnume, xtra);
 #endif
@@ -1289,16 +1294,17 @@ del_bytes(
     mch_memmove(newp + col, oldp + col + count, (size_t)movelen);
     if (alloc_newp)
 	ml_replace(lnum, newp, FALSE);
-#ifdef FEAT_PROP_POPUP
     else
     {
+#ifdef FEAT_PROP_POPUP
 	// Also move any following text properties.
 	if (oldlen + 1 < curbuf->b_ml.ml_line_len)
 	    mch_memmove(newp + newlen + 1, oldp + oldlen + 1,
 			       (size_t)curbuf->b_ml.ml_line_len - oldlen - 1);
 	curbuf->b_ml.ml_line_len -= count;
-    }
 #endif
+	curbuf->b_ml.ml_line_textlen = 0;
+    }
 
     // mark the buffer as changed and prepare for displaying
     inserted_bytes(lnum, curwin->w_cursor.col, -count);
@@ -2502,8 +2502,16 @@ invoke_one_time_callback(
     vim_free(item);
 }
 
+/*
+ * Append "count" lines from "lines" to "buffer".
+ */
     static void
-append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
+append_to_buffer(
+	buf_T	    *buffer,
+	char_u	    **lines,
+	long	    count,
+	channel_T   *channel,
+	ch_part_T   part)
 {
     bufref_T	save_curbuf = {NULL, 0, 0};
     win_T	*save_curwin = NULL;
@@ -2533,7 +2541,11 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
     }
 
     // Append to the buffer
-    ch_log(channel, "appending line %d to buffer", (int)lnum + 1 - empty);
+    if (count == 1)
+	ch_log(channel, "appending line %d to buffer", (int)lnum + 1 - empty);
+    else
+	ch_log(channel, "appending lines %d to %d to buffer",
+			(int)lnum + 1 - empty, (int)(lnum - empty + count));
 
     buffer->b_p_ma = TRUE;
 
@@ -2547,12 +2559,14 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
     if (empty)
     {
 	// The buffer is empty, replace the first (dummy) line.
-	ml_replace(lnum, msg, TRUE);
+	ml_replace(lnum, lines[0], TRUE);
+	if (count > 1)
+	    ml_append_many(curbuf, lnum, lines + 1, count - 1, FALSE);
 	lnum = 0;
     }
     else
-	ml_append(lnum, msg, 0, FALSE);
-    appended_lines_mark(lnum, 1L);
+	ml_append_many(curbuf, lnum, lines, count, FALSE);
+    appended_lines_mark(lnum, count);
 
     // Restore curbuf/curwin/curtab
     restore_win_for_buf(save_curwin, save_curtab, &save_curbuf);
@@ -2575,12 +2589,12 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
 			    : (wp->w_cursor.lnum == lnum
 				&& wp->w_cursor.col == 0);
 
-		// If the cursor is at or above the new line, move it one line
-		// down.  If the topline is outdated update it now.
+		// If the cursor is at or above the new lines, move it down to
+		// follow them.  If the topline is outdated update it now.
 		if (move_cursor || wp->w_topline > buffer->b_ml.ml_line_count)
 		{
 		    if (move_cursor)
-			++wp->w_cursor.lnum;
+			wp->w_cursor.lnum += count;
 		    save_curwin = curwin;
 		    curwin = wp;
 		    curbuf = curwin->w_buffer;
@@ -2611,6 +2625,59 @@ append_to_buffer(buf_T *buffer, char_u *msg, channel_T *channel, ch_part_T part)
     }
 }
 
+/*
+ * Append all the lines ending in a NL in the first buffer of
+ * "channel"/"part" to "buffer".
+ */
+    static void
+append_lines_to_buffer(buf_T *buffer, channel_T *channel, ch_part_T part)
+{
+    readq_T	*node = channel_peek(channel, part);
+    long_u	len = node->rq_buflen;
+    garray_T	ga;
+    char_u	*msg;
+    char_u	*start;
+    char_u	*p;
+
+    // Find the end of the last complete line.
+    while (len > 0 && node->rq_buffer[len - 1] != NL)
+	--len;
+    if (len == node->rq_buflen)
+	msg = channel_get(channel, part, NULL);
+    else
+    {
+	msg = alloc(len);
+	if (msg == NULL)
+	    return;
+	mch_memmove(msg, node->rq_buffer, len);
+	channel_consume(channel, part, (int)len);
+    }
+    if (msg == NULL)
+	return;
+
+    // Split the text at NL.  Convert NUL to NL, the internal representation.
+    ga_init2(&ga, (int)sizeof(char_u *), 50);
+    for (p = start = msg; p < msg + len; ++p)
+    {
+	if (*p == NL)
+	{
+	    *p = NUL;
+	    if (ga_grow(&ga, 1) == FAIL)
+		break;
+	    ((char_u **)ga.ga_data)[ga.ga_len++] = start;
+	    start = p + 1;
+	}
+	else if (*p == NUL)
+	    *p = NL;
+    }
+
+    if (ga.ga_len > 0)
+	append_to_buffer(buffer, (char_u **)ga.ga_data, ga.ga_len,
+							       channel, part);
+    ga_clear(&ga);
+    vim_free(msg);
+}
+
     static void
 drop_messages(channel_T *channel, ch_part_T part)
 {
@@ -2746,6 +2813,17 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 	    }
 	    buf = node->rq_buffer;
 
+	    if (nl != NULL && callback == NULL
+#ifdef FEAT_TERMINAL
+		    && buffer->b_term == NULL
+#endif
+	       )
+	    {
+		// Only appending to a buffer: do all complete lines at once.
+		append_lines_to_buffer(buffer, channel, part);
+		return TRUE;
+	    }
+
 	    // Convert NUL to NL, the internal representation.
 	    for (p = buf; (nl == NULL || p < nl)
 					    && p < buf + node->rq_buflen; ++p)
@@ -2825,7 +2903,7 @@ may_invoke_callback(channel_T *channel, ch_part_T part)
 		    write_to_term(buffer, msg, channel);
 		else
 #endif
-		    append_to_buffer(buffer, msg, channel, part);
+		    append_to_buffer(buffer, &msg, 1, channel, part);
 	    }
 	}
 
@@ -1746,6 +1746,7 @@ set_one_cmd_context(
 	    break;
 #if defined(FEAT_PROFILE)
 	case CMD_syntime:
+	case CMD_regtime:
 	    xp->xp_context = EXPAND_SYNTIME;
 	    xp->xp_pattern = arg;
 	    break;
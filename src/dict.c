@@ -382,6 +382,30 @@ dict_add_special(dict_T *d, char *key, varnumber_T nr)
     return dict_add_number_special(d, key, nr, TRUE);
 }
 
+#if defined(FEAT_FLOAT) || defined(PROTO)
+/*
+ * Add a float entry to dictionary "d".
+ * Returns FAIL when out of memory and when key already exists.
+ */
+    int
+dict_add_float(dict_T *d, char *key, float_T f)
+{
+    dictitem_T	*item;
+
+    item = dictitem_alloc((char_u *)key);
+    if (item == NULL)
+	return FAIL;
+    item->di_tv.v_type = VAR_FLOAT;
+    item->di_tv.vval.v_float = f;
+    if (dict_add(d, item) == FAIL)
+    {
+	dictitem_free(item);
+	return FAIL;
+    }
+    return OK;
+}
+#endif
+
 /*
  * Add a string entry to dictionary "d".
  * Returns FAIL when out of memory and when key already exists.
@@ -457,6 +457,7 @@ win_line(
 	if (syntax_present(wp) && !wp->w_s->b_syn_error
 # ifdef SYN_TIME_LIMIT
 		&& !wp->w_s->b_syn_slow
+		&& !syn_defer_line(wp, lnum)
 # endif
 	   )
 	{
@@ -710,7 +711,7 @@ win_line(
 	}
 	else
 	{
-	    v = (long)STRLEN(line);
+	    v = (long)ml_get_buf_len(wp->w_buffer, lnum);
 	    if (v < SPWORDLEN)
 	    {
 		// Short line, use it completely and append the start of the
@@ -738,7 +739,7 @@ win_line(
 	// find start of trailing whitespace
 	if (lcs_trail)
 	{
-	    trailcol = (colnr_T)STRLEN(ptr);
+	    trailcol = ml_get_buf_len(wp->w_buffer, lnum);
 	    while (trailcol > (colnr_T)0 && VIM_ISWHITE(ptr[trailcol - 1]))
 		--trailcol;
 	    trailcol += (colnr_T) (ptr - line);
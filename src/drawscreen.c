@@ -1422,6 +1422,7 @@ win_update(win_T *wp)
 #endif
 #ifdef SYN_TIME_LIMIT
     proftime_T	syntax_tm;
+    proftime_T	syntax_defer_tm;
 #endif
 
     type = wp->w_redr_type;
@@ -2055,6 +2056,14 @@ win_update(win_T *wp)
     // Set the time limit to 'redrawtime'.
     profile_setlimit(p_rdt, &syntax_tm);
     syn_set_timeout(&syntax_tm);
+    // After 'syndefer' lines are drawn without syntax highlighting.
+    if (p_sdf > 0)
+    {
+	profile_setlimit(p_sdf, &syntax_defer_tm);
+	syn_set_defer(&syntax_defer_tm);
+    }
+    else
+	syn_set_defer(NULL);
 #endif
 #ifdef FEAT_FOLDING
     win_foldinfo.fi_level = 0;
@@ -2362,7 +2371,11 @@ win_update(win_T *wp)
 #endif
 #ifdef FEAT_SYN_HL
 		did_update = DID_LINE;
-		syntax_last_parsed = lnum;
+# ifdef SYN_TIME_LIMIT
+		// A line drawn without syntax highlighting was not parsed.
+		if (!syn_is_deferring())
+# endif
+		    syntax_last_parsed = lnum;
 #endif
 	    }
 
@@ -2547,6 +2560,7 @@ win_update(win_T *wp)
 
 #ifdef SYN_TIME_LIMIT
     syn_set_timeout(NULL);
+    syn_set_defer(NULL);
 #endif
 
     // Reset the type of redrawing required, the window has been updated.
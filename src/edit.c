@@ -5609,6 +5609,7 @@ ins_tab(void)
 #ifdef FEAT_PROP_POPUP
 		curbuf->b_ml.ml_line_len -= i;
 #endif
+		curbuf->b_ml.ml_line_textlen = 0;
 	    }
 #ifdef FEAT_NETBEANS_INTG
 	    if (netbeans_active())
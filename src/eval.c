@@ -6423,6 +6423,7 @@ do_string_sub(
     char_u	*ret;
     char_u	*save_cpo;
     char_u	*zero_width = NULL;
+    regtimeout_T rt;
 
     // Make 'cpoptions' empty, so that the 'l' flag doesn't work here
     save_cpo = p_cpo;
@@ -6438,6 +6439,7 @@ do_string_sub(
     {
 	tail = str;
 	end = str + STRLEN(str);
+	regexp_timeout_start(0L, &rt);
 	while (vim_regexec_nl(&regmatch, str, (colnr_T)(tail - str)))
 	{
 	    // Skip empty match except for first match.
@@ -6484,6 +6486,8 @@ do_string_sub(
 	    if (!do_all)
 		break;
 	}
+	if (regexp_timeout_end(&rt))
+	    emsg(_(e_regexp_timeout));
 
 	if (ga.ga_data != NULL)
 	    STRCPY((char *)ga.ga_data + ga.ga_len, tail);
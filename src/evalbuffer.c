@@ -127,6 +127,69 @@ find_win_for_curbuf(void)
     }
 }
 
+/*
+ * Append the strings of the items of list "l" from "first" onwards below line
+ * "lnum" of the current buffer, with one call to ml_append_many().
+ * Returns the number of lines appended.  "*failp" is set when an item is not
+ * a string or appending failed.
+ */
+    static long
+append_list_lines(
+	linenr_T    lnum,
+	list_T	    *l,
+	listitem_T  *first,
+	int	    *failp)
+{
+    garray_T	ga;		// lines to append
+    garray_T	ga_alloced;	// converted items, to be freed
+    listitem_T	*li;
+    char_u	buf[NUMBUFLEN];
+    char_u	*p;
+    long	count = 0;
+
+    ga_init2(&ga, (int)sizeof(char_u *), 100);
+    ga_init2(&ga_alloced, (int)sizeof(char_u *), 10);
+    // Allocate for all items at once, it may be a long list.
+    if (ga_grow(&ga, list_len(l)) == FAIL)
+    {
+	*failp = TRUE;
+	return 0;
+    }
+    for (li = first; li != NULL; li = li->li_next)
+    {
+	p = tv_get_string_buf_chk(&li->li_tv, buf);
+	if (p == buf)
+	{
+	    p = vim_strsave(buf);
+	    if (p != NULL && ga_grow(&ga_alloced, 1) == OK)
+		((char_u **)ga_alloced.ga_data)[ga_alloced.ga_len++] = p;
+	    else
+	    {
+		vim_free(p);
+		p = NULL;
+	    }
+	}
+	if (p == NULL || ga_grow(&ga, 1) == FAIL)
+	{
+	    *failp = TRUE;
+	    break;
+	}
+	((char_u **)ga.ga_data)[ga.ga_len++] = p;
+    }
+
+    if (ga.ga_len > 0)
+    {
+	if (ml_append_many(curbuf, lnum, (char_u **)ga.ga_data, ga.ga_len,
+								FALSE) == OK)
+	    count = ga.ga_len;
+	else
+	    *failp = TRUE;
+    }
+    ga_clear(&ga);
+    ga_clear_strings(&ga_alloced);
+    return count;
+}
+
 /*
  * Set line or list of lines in buffer "buf".
  */
@@ -142,6 +205,7 @@ set_buffer_lines(
     char_u	*line = NULL;
     list_T	*l = NULL;
     listitem_T	*li = NULL;
+    listitem_T	*line_li = NULL;
     long	added = 0;
     linenr_T	append_lnum;
     buf_T	*curbuf_save = NULL;
@@ -190,6 +254,7 @@ set_buffer_lines(
 	    if (li == NULL)
 		break;
 	    line = tv_get_string_chk(&li->li_tv);
+	    line_li = li;
 	    li = li->li_next;
 	}
 
@@ -220,6 +285,17 @@ set_buffer_lines(
 	}
 	else if (added > 0 || u_save(lnum - 1, lnum) == OK)
 	{
+	    if (l != NULL && curbuf->b_ml.ml_mfp != NULL)
+	    {
+		int	failed = FALSE;
+
+		// Append this line and all the following ones at once.
+		added += append_list_lines(lnum - 1, l, line_li, &failed);
+		if (!failed)
+		    rettv->vval.v_number = 0;	// OK
+		break;
+	    }
+
 	    // append the line
 	    ++added;
 	    if (ml_append(lnum - 1, line, (colnr_T)0, FALSE) == OK)
@@ -552,6 +628,24 @@ get_buffer_info(buf_T *buf)
     dict_add_number(dict, "hidden",
 			    buf->b_ml.ml_mfp != NULL && buf->b_nwindows == 0);
 
+    if (buf->b_ml.ml_mfp != NULL)
+    {
+	dict_T	*mldict = dict_alloc();
+
+	// Statistics about finding lines in the memline
+	if (mldict != NULL)
+	{
+	    dict_add_number(mldict, "cachehits", buf->b_ml.ml_cache_hits);
+	    dict_add_number(mldict, "cachemisses", buf->b_ml.ml_cache_misses);
+	    dict_add_number(mldict, "resident",
+					    buf->b_ml.ml_mfp->mf_used_count);
+	    dict_add_number(mldict, "evicted", buf->b_ml.ml_mfp->mf_evicted);
+	    dict_add_number(mldict, "compressed",
+					      buf->b_ml.ml_mfp->mf_zcount);
+	    dict_add_dict(dict, "memline", mldict);
+	}
+    }
+
     // Get a reference to buffer variables
     dict_add_dict(dict, "variables", buf->b_vars);
 
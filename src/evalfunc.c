@@ -561,15 +561,15 @@ static funcentry_T global_functions[] =
     {"map",		2, 2, FEARG_1,	  f_map},
     {"maparg",		1, 4, FEARG_1,	  f_maparg},
     {"mapcheck",	1, 3, FEARG_1,	  f_mapcheck},
-    {"match",		2, 4, FEARG_1,	  f_match},
+    {"match",		2, 5, FEARG_1,	  f_match},
     {"matchadd",	2, 5, FEARG_1,	  f_matchadd},
     {"matchaddpos",	2, 5, FEARG_1,	  f_matchaddpos},
     {"matcharg",	1, 1, FEARG_1,	  f_matcharg},
     {"matchdelete",	1, 2, FEARG_1,	  f_matchdelete},
-    {"matchend",	2, 4, FEARG_1,	  f_matchend},
-    {"matchlist",	2, 4, FEARG_1,	  f_matchlist},
-    {"matchstr",	2, 4, FEARG_1,	  f_matchstr},
-    {"matchstrpos",	2, 4, FEARG_1,	  f_matchstrpos},
+    {"matchend",	2, 5, FEARG_1,	  f_matchend},
+    {"matchlist",	2, 5, FEARG_1,	  f_matchlist},
+    {"matchstr",	2, 5, FEARG_1,	  f_matchstr},
+    {"matchstrpos",	2, 5, FEARG_1,	  f_matchstrpos},
     {"max",		1, 1, FEARG_1,	  f_max},
     {"min",		1, 1, FEARG_1,	  f_min},
     {"mkdir",		1, 3, FEARG_1,	  f_mkdir},
@@ -644,6 +644,10 @@ static funcentry_T global_functions[] =
     {"readfile",	1, 3, FEARG_1,	  f_readfile},
     {"reg_executing",	0, 0, 0,	  f_reg_executing},
     {"reg_recording",	0, 0, 0,	  f_reg_recording},
+    {"regexpcacheinfo",	0, 0, 0,	  f_regexpcacheinfo},
+#ifdef FEAT_PROFILE
+    {"regtimeinfo",	0, 0, 0,	  f_regtimeinfo},
+#endif
     {"reltime",		0, 2, FEARG_1,	  f_reltime},
 #ifdef FEAT_FLOAT
     {"reltimefloat",	1, 1, FEARG_1,	  f_reltimefloat},
@@ -4543,6 +4547,8 @@ find_some_match(typval_T *argvars, typval_T *rettv, matchtype_T type)
     listitem_T	*li = NULL;
     long	idx = 0;
     char_u	*tofree = NULL;
+    long	timeout = 0;
+    regtimeout_T rt;
 
     // Make 'cpoptions' empty, the 'l' flag should not be used here.
     save_cpo = p_cpo;
@@ -4625,7 +4631,18 @@ find_some_match(typval_T *argvars, typval_T *rettv, matchtype_T type)
 	}
 
 	if (argvars[3].v_type != VAR_UNKNOWN)
+	{
 	    nth = (long)tv_get_number_chk(&argvars[3], &error);
+	    if (argvars[4].v_type != VAR_UNKNOWN)
+	    {
+		timeout = (long)tv_get_number_chk(&argvars[4], &error);
+		if (!error && timeout < 0)
+		{
+		    emsg(_(e_positive));
+		    error = TRUE;
+		}
+	    }
+	}
 	if (error)
 	    goto theend;
     }
@@ -4635,6 +4652,7 @@ find_some_match(typval_T *argvars, typval_T *rettv, matchtype_T type)
     {
 	regmatch.rm_ic = p_ic;
 
+	regexp_timeout_start(timeout, &rt);
 	for (;;)
 	{
 	    if (l != NULL)
@@ -4652,6 +4670,8 @@ find_some_match(typval_T *argvars, typval_T *rettv, matchtype_T type)
 
 	    match = vim_regexec_nl(&regmatch, str, (colnr_T)startcol);
 
+	    if (regexp_timed_out())
+		break;
 	    if (match && --nth <= 0)
 		break;
 	    if (l == NULL && !match)
@@ -4675,6 +4695,11 @@ find_some_match(typval_T *argvars, typval_T *rettv, matchtype_T type)
 		}
 	    }
 	}
+	if (regexp_timeout_end(&rt))
+	{
+	    emsg(_(e_regexp_timeout));
+	    match = FALSE;
+	}
 
 	if (match)
 	{
@@ -5811,6 +5836,7 @@ search_cmn(typval_T *argvars, pos_T *match_pos, int *flagsp)
     int		options = SEARCH_KEEP;
     int		subpatnum;
     searchit_arg_T sia;
+    regtimeout_T rt;
 
     pat = tv_get_string(&argvars[0]);
     dir = get_search_arg(&argvars[1], flagsp);	// may set p_ws
@@ -5862,10 +5888,15 @@ search_cmn(typval_T *argvars, pos_T *match_pos, int *flagsp)
     vim_memset(&sia, 0, sizeof(sia));
     sia.sa_stop_lnum = (linenr_T)lnum_stop;
 #ifdef FEAT_RELTIME
-    sia.sa_tm = &tm;
+    if (time_limit > 0)
+	sia.sa_tm = &tm;
 #endif
+    // Without a {timeout} use 'regexptimeout'.
+    regexp_timeout_start(sia.sa_tm != NULL ? -1L : 0L, &rt);
     subpatnum = searchit(curwin, curbuf, &pos, NULL, dir, pat, 1L,
 						     options, RE_SEARCH, &sia);
+    if (regexp_timeout_end(&rt))
+	emsg(_(e_regexp_timeout));
     if (subpatnum != FAIL)
     {
 	if (flags & SP_SUBPAT)
@@ -6127,6 +6158,7 @@ searchpair_cmn(typval_T *argvars, pos_T *match_pos)
     int		retval = 0;		// default: FAIL
     long	lnum_stop = 0;
     long	time_limit = 0;
+    regtimeout_T rt;
 
     // Get the three pattern arguments: start, middle, end. Will result in an
     // error if not a valid argument.
@@ -6190,8 +6222,12 @@ searchpair_cmn(typval_T *argvars, pos_T *match_pos)
 	}
     }
 
+    // Without a {timeout} use 'regexptimeout'.
+    regexp_timeout_start(time_limit > 0 ? -1L : 0L, &rt);
     retval = do_searchpair(spat, mpat, epat, dir, skip, flags,
 					    match_pos, lnum_stop, time_limit);
+    if (regexp_timeout_end(&rt))
+	emsg(_(e_regexp_timeout));
 
 theend:
     p_ws = save_p_ws;
@@ -6310,7 +6346,8 @@ do_searchpair(
 	vim_memset(&sia, 0, sizeof(sia));
 	sia.sa_stop_lnum = lnum_stop;
 #ifdef FEAT_RELTIME
-	sia.sa_tm = &tm;
+	if (time_limit > 0)
+	    sia.sa_tm = &tm;
 #endif
 	n = searchit(curwin, curbuf, &pos, NULL, dir, pat, 1L,
 						     options, RE_SEARCH, &sia);
@@ -386,6 +386,8 @@ ex_sort(exarg_T *eap)
     int		sort_what = 0;
     int		format_found = 0;
     int		change_occurred = FALSE; // Buffer contents changed.
+    regtimeout_T rt;
+    int		timed_out;
 
     // Sorting one line is really quick!
     if (count <= 1)
@@ -501,6 +503,7 @@ ex_sort(exarg_T *eap)
      * matching and number conversion only has to be done once per line.
      * Also get the longest line length for allocating "sortbuf".
      */
+    regexp_timeout_start(0L, &rt);
     for (lnum = eap->line1; lnum <= eap->line2; ++lnum)
     {
 	s = ml_get(lnum);
@@ -589,9 +592,14 @@ ex_sort(exarg_T *eap)
 
 	if (regmatch.regprog != NULL)
 	    fast_breakcheck();
-	if (got_int)
-	    goto sortend;
+	if (got_int || regexp_timed_out())
+	    break;
     }
+    timed_out = regexp_timeout_end(&rt);
+    if (timed_out)
+	emsg(_(e_regexp_timeout));
+    if (got_int || timed_out)
+	goto sortend;
 
     // Allocate a buffer that can hold the longest line.
     sortbuf1 = alloc(maxlen + 1);
@@ -665,6 +673,56 @@ sortend:
 	emsg(_(e_interr));
 }
 
+// Number of lines copied at a time by copy_lines().
+#define COPY_LINES_BATCH 1000
+
+/*
+ * Copy lines "line1" to "line2" of the current buffer to below line "dest".
+ * "dest" may be inside the range of lines.  The lines are appended in
+ * batches with ml_append_many().  The caller must take care of undo and
+ * marks.
+ * Return FAIL when out of memory.
+ */
+    static int
+copy_lines(linenr_T line1, linenr_T line2, linenr_T dest)
+{
+    char_u	**lines;
+    long	count = line2 - line1 + 1;
+    long	done = 0;
+    long	n;
+    long	i;
+    linenr_T	lnum;
+    int		ret = OK;
+
+    lines = ALLOC_MULT(char_u *,
+		       count < COPY_LINES_BATCH ? count : COPY_LINES_BATCH);
+    if (lines == NULL)
+	return FAIL;
+    while (done < count && ret == OK)
+    {
+	n = count - done < COPY_LINES_BATCH ? count - done : COPY_LINES_BATCH;
+	for (i = 0; i < n; ++i)
+	{
+	    // Lines below "dest" have moved down by the lines copied so far.
+	    lnum = line1 + done + i;
+	    if (lnum > dest)
+		lnum += done;
+	    // need to use vim_strsave() because the line will be unlocked
+	    // within ml_append_many()
+	    if ((lines[i] = vim_strsave(ml_get(lnum))) == NULL)
+		break;
+	}
+	if (i < n || ml_append_many(curbuf, dest + done, lines, n, FALSE)
+								      == FAIL)
+	    ret = FAIL;
+	while (--i >= 0)
+	    vim_free(lines[i]);
+	done += n;
+    }
+    vim_free(lines);
+    return ret;
+}
+
 /*
  * :move command - move lines line1-line2 to line dest
  *
@@ -673,8 +731,6 @@ sortend:
     int
 do_move(linenr_T line1, linenr_T line2, linenr_T dest)
 {
-    char_u	*str;
-    linenr_T	l;
     linenr_T	extra;	    // Num lines added before line1
     linenr_T	num_lines;  // Num lines moved
     linenr_T	last_line;  // Last line in file after adding new text
@@ -711,17 +767,9 @@ do_move(linenr_T line1, linenr_T line2, linenr_T dest)
      */
     if (u_save(dest, dest + 1) == FAIL)
 	return FAIL;
-    for (extra = 0, l = line1; l <= line2; l++)
-    {
-	str = vim_strsave(ml_get(l + extra));
-	if (str != NULL)
-	{
-	    ml_append(dest + l - line1, str, (colnr_T)0, FALSE);
-	    vim_free(str);
-	    if (dest < line1)
-		extra++;
-	}
-    }
+    if (copy_lines(line1, line2, dest) == FAIL)
+	return FAIL;
+    extra = dest < line1 ? num_lines : 0;
 
     /*
      * Now we must be careful adjusting our marks so that we don't overlap our
@@ -781,8 +829,7 @@ do_move(linenr_T line1, linenr_T line2, linenr_T dest)
     if (u_save(line1 + extra - 1, line2 + extra + 1) == FAIL)
 	return FAIL;
 
-    for (l = line1; l <= line2; l++)
-	ml_delete(line1 + extra, TRUE);
+    ml_delete_many(line1 + extra, (long)num_lines, TRUE);
 
     if (!global_busy && num_lines > p_report)
 	smsg(NGETTEXT("%ld line moved", "%ld lines moved", num_lines),
@@ -817,7 +864,6 @@ do_move(linenr_T line1, linenr_T line2, linenr_T dest)
 ex_copy(linenr_T line1, linenr_T line2, linenr_T n)
 {
     linenr_T	count;
-    char_u	*p;
 
     count = line2 - line1 + 1;
     if (!cmdmod.lockmarks)
@@ -827,41 +873,12 @@ ex_copy(linenr_T line1, linenr_T line2, linenr_T n)
 	curbuf->b_op_start.col = curbuf->b_op_end.col = 0;
     }
 
-    /*
-     * there are three situations:
-     * 1. destination is above line1
-     * 2. destination is between line1 and line2
-     * 3. destination is below line2
-     *
-     * n = destination (when starting)
-     * curwin->w_cursor.lnum = destination (while copying)
-     * line1 = start of source (while copying)
-     * line2 = end of source (while copying)
-     */
     if (u_save(n, n + 1) == FAIL)
 	return;
 
-    curwin->w_cursor.lnum = n;
-    while (line1 <= line2)
-    {
-	// need to use vim_strsave() because the line will be unlocked within
-	// ml_append()
-	p = vim_strsave(ml_get(line1));
-	if (p != NULL)
-	{
-	    ml_append(curwin->w_cursor.lnum, p, (colnr_T)0, FALSE);
-	    vim_free(p);
-	}
-	// situation 2: skip already copied lines
-	if (line1 == n)
-	    line1 = curwin->w_cursor.lnum;
-	++line1;
-	if (curwin->w_cursor.lnum < line1)
-	    ++line1;
-	if (curwin->w_cursor.lnum < line2)
-	    ++line2;
-	++curwin->w_cursor.lnum;
-    }
+    // The destination may be above, inside or below the lines.
+    (void)copy_lines(line1, line2, n);
+    curwin->w_cursor.lnum = n + count;
 
     appended_lines_mark(n, count);
 
@@ -3593,6 +3610,8 @@ do_sub(exarg_T *eap)
     int		endcolumn = FALSE;	// cursor in last column when done
     pos_T	old_cursor = curwin->w_cursor;
     int		start_nsubs;
+    regtimeout_T rt;
+    int		timed_out;
 #ifdef FEAT_EVAL
     int		save_ma = 0;
 #endif
@@ -3872,14 +3891,16 @@ do_sub(exarg_T *eap)
 	sub = regtilde(sub, p_magic);
 
     /*
-     * Check for a match on each line.
+     * Check for a match on each line.  When confirming the time spent waiting
+     * for the user must not count, don't use a time limit then.
      */
+    regexp_timeout_start(subflags.do_ask ? -1L : 0L, &rt);
     line2 = eap->line2;
     for (lnum = eap->line1; lnum <= line2 && !(got_quit
 #if defined(FEAT_EVAL)
 		|| aborting()
 #endif
-		); ++lnum)
+		|| regexp_timed_out()); ++lnum)
     {
 	nmatch = vim_regexec_multi(&regmatch, curwin, curbuf, lnum,
 						       (colnr_T)0, NULL, NULL);
@@ -4617,6 +4638,7 @@ skip:
 
 outofmem:
     vim_free(sub_firstline); // may have to free allocated copy of the line
+    timed_out = regexp_timeout_end(&rt);
 
     // ":s/pat//n" doesn't move the cursor
     if (subflags.do_count)
@@ -4651,7 +4673,7 @@ outofmem:
 	    print_line(curwin->w_cursor.lnum,
 					 subflags.do_number, subflags.do_list);
     }
-    else if (!global_busy)
+    else if (!global_busy && !timed_out)
     {
 	if (got_int)		// interrupted
 	    emsg(_(e_interr));
@@ -4660,6 +4682,8 @@ outofmem:
 	else if (subflags.do_error)	// nothing found
 	    semsg(_(e_patnotf2), get_search_pat());
     }
+    if (timed_out)
+	emsg(_(e_regexp_timeout));
 
 #ifdef FEAT_FOLDING
     if (subflags.do_ask && hasAnyFolding(curwin))
@@ -4769,6 +4793,8 @@ ex_global(exarg_T *eap)
     regmmatch_T	regmatch;
     int		match;
     int		which_pat;
+    regtimeout_T rt;
+    int		timed_out;
 
     // When nesting the command works on one line.  This allows for
     // ":g/found/v/notfound/command".
@@ -4842,7 +4868,9 @@ ex_global(exarg_T *eap)
 	/*
 	 * pass 1: set marks for each (not) matching line
 	 */
-	for (lnum = eap->line1; lnum <= eap->line2 && !got_int; ++lnum)
+	regexp_timeout_start(0L, &rt);
+	for (lnum = eap->line1; lnum <= eap->line2 && !got_int
+					    && !regexp_timed_out(); ++lnum)
 	{
 	    // a match on this line?
 	    match = vim_regexec_multi(&regmatch, curwin, curbuf, lnum,
@@ -4854,12 +4882,17 @@ ex_global(exarg_T *eap)
 	    }
 	    line_breakcheck();
 	}
+	timed_out = regexp_timeout_end(&rt);
 
 	/*
 	 * pass 2: execute the command for each line that has been marked
 	 */
 	if (got_int)
 	    msg(_(e_interr));
+	else if (timed_out)
+	    // Some lines were not checked, don't execute the command on the
+	    // others.
+	    emsg(_(e_regexp_timeout));
 	else if (ndone == 0)
 	{
 	    if (type == 'v')
@@ -1213,6 +1213,9 @@ EXCMD(CMD_redrawtabline, "redrawtabline", ex_redrawtabline,
 EXCMD(CMD_registers,	"registers",	ex_display,
 	EX_EXTRA|EX_NOTRLCOM|EX_TRLBAR|EX_CMDWIN,
 	ADDR_NONE),
+EXCMD(CMD_regtime,	"regtime",	ex_regtime,
+	EX_NEEDARG|EX_WORD1|EX_TRLBAR|EX_CMDWIN,
+	ADDR_NONE),
 EXCMD(CMD_resize,	"resize",	ex_resize,
 	EX_RANGE|EX_TRLBAR|EX_WORD1|EX_CMDWIN,
 	ADDR_OTHER),
@@ -162,6 +162,9 @@ static void	ex_popup(exarg_T *eap);
 #if !defined(FEAT_SYN_HL) || !defined(FEAT_PROFILE)
 # define ex_syntime		ex_ni
 #endif
+#ifndef FEAT_PROFILE
+# define ex_regtime		ex_ni
+#endif
 #ifndef FEAT_SPELL
 # define ex_spell		ex_ni
 # define ex_mkspell		ex_ni
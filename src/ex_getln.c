@@ -146,6 +146,11 @@ typedef struct {
     int		did_incsearch;
     int		incsearch_postponed;
     int		magic_save;
+    char_u	*resume_pat;	// pattern of a search that did not finish
+    pos_T	resume_start;	// "search_start" of that search
+    linenr_T	resume_lnum;	// line to continue that search in
+    int		resume_loop;	// 'wrapscan' loop to continue that search in
+    varnumber_T	resume_changedtick; // b:changedtick when that search stopped
 } incsearch_state_T;
 
     static void
@@ -155,6 +160,7 @@ init_incsearch_state(incsearch_state_T *is_state)
     is_state->did_incsearch = FALSE;
     is_state->incsearch_postponed = FALSE;
     is_state->magic_save = p_magic;
+    is_state->resume_pat = NULL;
     CLEAR_POS(&is_state->match_end);
     is_state->save_cursor = curwin->w_cursor;  // may be restored later
     is_state->search_start = curwin->w_cursor;
@@ -329,12 +335,39 @@ theend:
     return retval;
 }
 
+/*
+ * Return TRUE when a search for "pat" can continue where a search for
+ * "prev_pat" stopped: "pat" is equal to "prev_pat" or only has plain text
+ * appended, thus a line without a match for "prev_pat" has no match for "pat"
+ * either.
+ */
+    static int
+incsearch_can_resume(char_u *prev_pat, char_u *pat)
+{
+    size_t	len = STRLEN(prev_pat);
+    char_u	*p;
+
+    if (STRNCMP(prev_pat, pat, len) != 0)
+	return FALSE;
+    if (pat[len] == NUL)
+	return TRUE;
+    for (p = pat; *p != NUL; ++p)
+	if (vim_strchr((char_u *)"\\/?^$.*~[", *p) != NULL)
+	    return FALSE;
+    // Typing an upper case character may switch off 'ignorecase'.
+    if (p_ic && p_scs && !pat_has_uppercase(prev_pat)
+						     && pat_has_uppercase(pat))
+	return FALSE;
+    return TRUE;
+}
+
     static void
 finish_incsearch_highlighting(
 	int gotesc,
 	incsearch_state_T *is_state,
 	int call_update_screen)
 {
+    VIM_CLEAR(is_state->resume_pat);
     if (is_state->did_incsearch)
     {
 	is_state->did_incsearch = FALSE;
@@ -380,11 +413,12 @@ may_do_incsearch_highlighting(
     pos_T	end_pos;
 #ifdef FEAT_RELTIME
     proftime_T	tm;
-    searchit_arg_T sia;
 #endif
+    searchit_arg_T sia;
     int		next_char;
     int		use_last_pat;
     int		did_do_incsearch = is_state->did_incsearch;
+    char_u	*resume_pat;
 
     // Parsing range may already set the last search pattern.
     // NOTE: must call restore_last_search_pattern() before returning!
@@ -394,6 +428,7 @@ may_do_incsearch_highlighting(
     {
 	restore_last_search_pattern();
 	finish_incsearch_highlighting(FALSE, is_state, TRUE);
+	is_state->incsearch_postponed = FALSE;
 	if (did_do_incsearch && vpeekc() == NUL)
 	    // may have skipped a redraw, do it now
 	    redrawcmd();
@@ -409,6 +444,10 @@ may_do_incsearch_highlighting(
     }
     is_state->incsearch_postponed = FALSE;
 
+    // Take over the state of a search that stopped before it was done.
+    resume_pat = is_state->resume_pat;
+    is_state->resume_pat = NULL;
+
     if (search_first_line == 0)
 	// start at the original cursor position
 	curwin->w_cursor = is_state->search_start;
@@ -447,24 +486,44 @@ may_do_incsearch_highlighting(
 #ifdef FEAT_RELTIME
 	// Set the time limit to half a second.
 	profile_setlimit(500L, &tm);
+# ifdef FEAT_EVAL
+	if (incsearch_time_for_testing > 0)
+	    profile_setlimit(incsearch_time_for_testing, &tm);
+# endif
 #endif
 	if (!p_hls)
 	    search_flags += SEARCH_KEEP;
 	if (search_first_line != 0)
 	    search_flags += SEARCH_START;
 	ccline.cmdbuff[skiplen + patlen] = NUL;
-#ifdef FEAT_RELTIME
 	vim_memset(&sia, 0, sizeof(sia));
+#ifdef FEAT_RELTIME
 	sia.sa_tm = &tm;
 #endif
+	// When a search for the same pattern, or the start of it, stopped
+	// before it was done continue it, instead of searching the lines
+	// without a match again.  Not when a timer or job changed the text.
+	if (resume_pat != NULL
+		&& EQUAL_POS(is_state->resume_start, is_state->search_start)
+		&& is_state->resume_changedtick == CHANGEDTICK(curbuf)
+		&& incsearch_can_resume(resume_pat, ccline.cmdbuff + skiplen))
+	{
+	    sia.sa_resume_lnum = is_state->resume_lnum;
+	    sia.sa_resume_loop = is_state->resume_loop;
+	}
 	found = do_search(NULL, firstc == ':' ? '/' : firstc,
-				 ccline.cmdbuff + skiplen, count, search_flags,
-#ifdef FEAT_RELTIME
-		&sia
-#else
-		NULL
-#endif
-		);
+			 ccline.cmdbuff + skiplen, count, search_flags, &sia);
+	if (found == 0 && sia.sa_resume_lnum != 0 && !got_int && count == 1
+		&& search_first_line == 0 && patlen > 0)
+	{
+	    // Stopped for a typed character or at the time limit, remember
+	    // where to continue.
+	    is_state->resume_pat = vim_strsave(ccline.cmdbuff + skiplen);
+	    is_state->resume_start = is_state->search_start;
+	    is_state->resume_lnum = sia.sa_resume_lnum;
+	    is_state->resume_loop = sia.sa_resume_loop;
+	    is_state->resume_changedtick = CHANGEDTICK(curbuf);
+	}
 	ccline.cmdbuff[skiplen + patlen] = next_char;
 	--emsg_off;
 
@@ -487,6 +546,8 @@ may_do_incsearch_highlighting(
 	    // cancelled searching because a char was typed
 	    is_state->incsearch_postponed = TRUE;
     }
+    vim_free(resume_pat);
+
     if (found != 0)
 	highlight_match = TRUE;		// highlight position
     else
@@ -988,7 +1049,19 @@ getcmdline_int(
 	// Get a character.  Ignore K_IGNORE and K_NOP, they should not do
 	// anything, such as stop completion.
 	do
+	{
+#ifdef FEAT_SEARCH_EXTRA
+	    // Do an 'incsearch' search that was postponed, or continue one
+	    // that stopped before it was done, until a key is typed.  Input
+	    // that is ignored, such as a terminal response, may have caused
+	    // it.
+	    while ((is_state.incsearch_postponed
+					     || is_state.resume_pat != NULL)
+		    && !char_avail())
+		may_do_incsearch_highlighting(firstc, count, &is_state);
+#endif
 	    c = safe_vgetc();
+	}
 	while (c == K_IGNORE || c == K_NOP);
 
 	if (KeyTyped)
@@ -1162,6 +1162,11 @@
 # define SYN_TIME_LIMIT 1
 #endif
 
+#if defined(FEAT_SYN_HL) && defined(FEAT_EVAL)
+// Can cache compiled syntax patterns in 'syncachedir'.
+# define SYN_CACHE 1
+#endif
+
 
 /*
  * +signs		Allow signs to be displayed to the left of text lines.
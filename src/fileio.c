@@ -188,6 +188,7 @@ readfile(
 					// wasn't possible
     char_u	conv_rest[CONV_RESTLEN];
     int		conv_restlen = 0;	// nr of bytes in conv_rest[]
+    int		lazy_tried = FALSE;	// TRUE when checked for 'lazyload'
     pos_T	orig_start;
     buf_T	*old_curbuf;
     char_u	*old_b_ffname;
@@ -2062,6 +2063,54 @@ rewind_retry:
 	    }
 	}
 
+	/*
+	 * When reading a big file into an empty buffer and no conversion is
+	 * needed: only find the line breaks now, the text of the lines is
+	 * read from the file when it is used.  See 'lazyload'.
+	 */
+	if (!lazy_tried)
+	{
+	    lazy_tried = TRUE;
+	    if (p_lzl > 0 && newfile && wasempty && from == 0
+		    && !read_stdin && !read_buffer && !read_fifo && !filtering
+		    && !recoverymode && !(flags & READ_DUMMY)
+		    && lines_to_skip == 0 && lines_to_read == MAXLNUM
+		    && fileformat == EOL_UNIX && fio_flags == 0
+		    && tmpname == NULL
+#ifdef USE_ICONV
+		    && iconv_fd == (iconv_t)-1
+#endif
+#ifdef FEAT_CRYPT
+		    && cryptkey == NULL
+#endif
+#ifdef FEAT_PERSISTENT_UNDO
+		    && !read_undo_file
+#endif
+		    && curbuf->b_orig_size / 1024 >= p_lzl)
+	    {
+		linenr_T    lazy_lines;
+		off_T	    lazy_size;
+		int	    lazy_no_eol;
+
+		// The bytes in "ptr" are read again.
+		if (ml_lazy_read(curbuf, fname, filesize - size, &lazy_lines,
+					&lazy_size, &lazy_no_eol) == OK)
+		{
+		    lnum += lazy_lines;
+		    filesize += lazy_size - size;
+		    if (lazy_no_eol)
+		    {
+			// remember for when writing
+			if (set_options)
+			    curbuf->b_p_eol = FALSE;
+			read_no_eol_lnum = lnum;
+		    }
+		    linerest = 0;
+		    break;
+		}
+	    }
+	}
+
 	/*
 	 * This loop is executed once for every character read.
 	 * Keep it fast!
@@ -2294,6 +2343,9 @@ failed:
 	if (newfile || read_buffer)
 	{
 	    redraw_curbuf_later(NOT_VALID);
+#ifdef FEAT_SEARCH_EXTRA
+	    hlcache_free(curbuf);
+#endif
 #ifdef FEAT_DIFF
 	    // After reading the text into the buffer the diff info needs to
 	    // be updated.
@@ -4345,6 +4397,10 @@ buf_reload(buf_T *buf, int orig_mode)
 	    }
 	}
 	vim_free(ea.cmd);
+#ifdef FEAT_SEARCH_EXTRA
+	// The text was replaced without calling changed_lines().
+	hlcache_free(buf);
+#endif
 
 	if (savebuf != NULL && bufref_valid(&bufref))
 	    wipe_buffer(savebuf, FALSE);
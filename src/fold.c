@@ -3266,6 +3266,7 @@ foldlevelExpr(fline_T *flp)
     int		c;
     linenr_T	lnum = flp->lnum + flp->off;
     int		save_keytyped;
+    regtimeout_T rt;
 
     win = curwin;
     curwin = flp->wp;
@@ -3280,8 +3281,12 @@ foldlevelExpr(fline_T *flp)
 
     // KeyTyped may be reset to 0 when calling a function which invokes
     // do_cmdline().  To make 'foldopen' work correctly restore KeyTyped.
+    // A pattern that takes too long must not make Vim hang, the time limit
+    // of 'regexptimeout' applies to each evaluation.
     save_keytyped = KeyTyped;
+    regexp_timeout_start(0L, &rt);
     n = (int)eval_foldexpr(flp->wp->w_p_fde, &c);
+    (void)regexp_timeout_end(&rt);
     KeyTyped = save_keytyped;
 
     switch (c)
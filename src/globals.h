@@ -1083,6 +1083,10 @@ EXTERN int	need_diff_redraw INIT(= 0); // need to call diff_redraw()
 
 EXTERN int	need_highlight_changed INIT(= TRUE);
 
+// Incremented when the character tables for 'iskeyword', 'isident',
+// 'isfname' or 'isprint' are changed.
+EXTERN int	chartab_tick INIT(= 0);
+
 #define NSCRIPT 15
 EXTERN FILE	*scriptin[NSCRIPT];	    // streams to read script from
 EXTERN int	curscript INIT(= 0);	    // index in scriptin[]
@@ -1572,6 +1576,7 @@ EXTERN char e_loclist[]	INIT(= N_("E776: No location list"));
 #endif
 EXTERN char e_re_damg[]	INIT(= N_("E43: Damaged match string"));
 EXTERN char e_re_corr[]	INIT(= N_("E44: Corrupted regexp program"));
+EXTERN char e_regexp_timeout[]	INIT(= N_("E1000: Pattern matching timed out"));
 EXTERN char e_readonly[]	INIT(= N_("E45: 'readonly' option is set (add ! to override)"));
 #ifdef FEAT_EVAL
 EXTERN char e_undefvar[]	INIT(= N_("E121: Undefined variable: %s"));
@@ -1700,6 +1705,7 @@ EXTERN int  disable_redraw_for_testing INIT(= FALSE);
 EXTERN int  ignore_redraw_flag_for_testing INIT(= FALSE);
 EXTERN int  nfa_fail_for_testing INIT(= FALSE);
 EXTERN int  no_query_mouse_for_testing INIT(= FALSE);
+EXTERN int  incsearch_time_for_testing INIT(= 0);
 
 EXTERN int  in_free_unref_items INIT(= FALSE);
 #endif
@@ -4035,6 +4035,255 @@ next_search_hl_pos(
     return 0;
 }
 
+/*
+ * Cache of 'hlsearch' and match results.  Redrawing searches every displayed
+ * line again, also when only the cursor moved or the text scrolled.  The
+ * result of vim_regexec_multi() for a line and start column is remembered
+ * per buffer and pattern, until the line is changed.
+ */
+
+// Maximum number of patterns cached for a buffer.
+#define HLCACHE_MAX_PATTERNS	8
+
+// Maximum number of entries for one pattern, all are dropped when reached.
+#define HLCACHE_MAX_ENTRIES	20000
+
+#define HLCACHE_HASH(lnum)	((unsigned)(lnum) & (HLCACHE_HASH_SIZE - 1))
+
+/*
+ * Remove all the entries of "hc".
+ */
+    static void
+hlcache_clear(hlcache_T *hc)
+{
+    hlcache_entry_T *e;
+    hlcache_entry_T *next;
+    int		    i;
+
+    for (i = 0; i < HLCACHE_HASH_SIZE; ++i)
+    {
+	for (e = hc->hc_hash[i]; e != NULL; e = next)
+	{
+	    next = e->hce_next;
+	    vim_free(e);
+	}
+	hc->hc_hash[i] = NULL;
+    }
+    hc->hc_count = 0;
+}
+
+    static void
+hlcache_free_one(hlcache_T *hc)
+{
+    hlcache_clear(hc);
+    vim_regfree(hc->hc_prog);
+    vim_free(hc);
+}
+
+/*
+ * Free all the cached 'hlsearch' and match results of "buf".
+ */
+    void
+hlcache_free(buf_T *buf)
+{
+    hlcache_T	*hc;
+
+    while (buf->b_hlcache != NULL)
+    {
+	hc = buf->b_hlcache;
+	buf->b_hlcache = hc->hc_next;
+	hlcache_free_one(hc);
+    }
+}
+
+/*
+ * Remove the cached results for lines "lnum" to "lnume - 1" of "buf", which
+ * were changed, and adjust the line numbers below them for "xtra" added lines
+ * (negative when lines were deleted).  See changed_lines().
+ */
+    void
+hlcache_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, long xtra)
+{
+    hlcache_T	    *hc;
+    hlcache_entry_T *e;
+    hlcache_entry_T **ep;
+    hlcache_entry_T *moved;
+    int		    i;
+
+    for (hc = buf->b_hlcache; hc != NULL; hc = hc->hc_next)
+    {
+	// A match may continue in a following line.
+	if (re_multiline(hc->hc_prog))
+	{
+	    hlcache_clear(hc);
+	    continue;
+	}
+
+	moved = NULL;
+	for (i = 0; i < HLCACHE_HASH_SIZE; ++i)
+	{
+	    ep = &hc->hc_hash[i];
+	    while (*ep != NULL)
+	    {
+		e = *ep;
+		if (e->hce_lnum < lnum)
+		    ep = &e->hce_next;
+		else if (e->hce_lnum < lnume || xtra != 0)
+		{
+		    *ep = e->hce_next;
+		    if (e->hce_lnum < lnume)
+		    {
+			vim_free(e);
+			--hc->hc_count;
+		    }
+		    else
+		    {
+			// line moved, insert it again below
+			e->hce_lnum += xtra;
+			e->hce_next = moved;
+			moved = e;
+		    }
+		}
+		else
+		    ep = &e->hce_next;
+	    }
+	}
+	while (moved != NULL)
+	{
+	    e = moved;
+	    moved = e->hce_next;
+	    i = HLCACHE_HASH(e->hce_lnum);
+	    e->hce_next = hc->hc_hash[i];
+	    hc->hc_hash[i] = e;
+	}
+    }
+}
+
+/*
+ * Get the cached results for the pattern of "rm" in buffer "buf", creating
+ * it when needed.  Returns NULL when the results cannot be cached.
+ */
+    static hlcache_T *
+hlcache_get(buf_T *buf, regmmatch_T *rm)
+{
+    hlcache_T	*hc;
+    hlcache_T	**hcp;
+    int		count;
+
+    // The text of these buffers is changed without calling changed_lines().
+    if (rm->regprog == NULL || re_volatile(rm->regprog)
+	    || bt_terminal(buf) || bt_quickfix(buf) || bt_popup(buf)
+	    || bt_prompt(buf))
+	return NULL;
+
+    for (hcp = &buf->b_hlcache; *hcp != NULL; hcp = &(*hcp)->hc_next)
+    {
+	hc = *hcp;
+	if (hc->hc_prog == rm->regprog && hc->hc_ic == rm->rmm_ic
+					     && hc->hc_maxcol == rm->rmm_maxcol)
+	{
+	    // Move it to the front of the list.
+	    *hcp = hc->hc_next;
+	    hc->hc_next = buf->b_hlcache;
+	    buf->b_hlcache = hc;
+
+	    // The result depends on 'iskeyword'.
+	    if (hc->hc_chartab_tick != chartab_tick
+		    || memcmp(hc->hc_chartab, buf->b_chartab, (size_t)32) != 0)
+	    {
+		hlcache_clear(hc);
+		hc->hc_chartab_tick = chartab_tick;
+		mch_memmove(hc->hc_chartab, buf->b_chartab, (size_t)32);
+	    }
+	    return hc;
+	}
+    }
+
+    hc = ALLOC_CLEAR_ONE(hlcache_T);
+    if (hc == NULL)
+	return NULL;
+    hc->hc_prog = rm->regprog;
+    ++hc->hc_prog->re_refcount;
+    hc->hc_ic = rm->rmm_ic;
+    hc->hc_maxcol = rm->rmm_maxcol;
+    hc->hc_chartab_tick = chartab_tick;
+    mch_memmove(hc->hc_chartab, buf->b_chartab, (size_t)32);
+    hc->hc_next = buf->b_hlcache;
+    buf->b_hlcache = hc;
+
+    // Drop the least recently used pattern when there are too many.
+    count = 0;
+    for (hcp = &buf->b_hlcache; *hcp != NULL; hcp = &(*hcp)->hc_next)
+	if (++count == HLCACHE_MAX_PATTERNS && (*hcp)->hc_next != NULL)
+	{
+	    hlcache_free_one((*hcp)->hc_next);
+	    (*hcp)->hc_next = NULL;
+	    break;
+	}
+    return hc;
+}
+
+/*
+ * Look up the result of searching line "lnum" from column "col" in "hc".
+ * When found set the match in "rm", return the number of lines matched in
+ * "*nmatched" and return TRUE.
+ */
+    static int
+hlcache_lookup(
+    hlcache_T	*hc,
+    linenr_T	lnum,
+    colnr_T	col,
+    regmmatch_T	*rm,
+    long	*nmatched)
+{
+    hlcache_entry_T *e;
+
+    for (e = hc->hc_hash[HLCACHE_HASH(lnum)]; e != NULL; e = e->hce_next)
+	if (e->hce_lnum == lnum && e->hce_col == col)
+	{
+	    *nmatched = e->hce_nmatched;
+	    if (e->hce_nmatched > 0)
+	    {
+		rm->startpos[0] = e->hce_startpos;
+		rm->endpos[0] = e->hce_endpos;
+	    }
+	    return TRUE;
+	}
+    return FALSE;
+}
+
+/*
+ * Remember the result of searching line "lnum" from column "col" in "hc".
+ */
+    static void
+hlcache_add(
+    hlcache_T	*hc,
+    linenr_T	lnum,
+    colnr_T	col,
+    regmmatch_T	*rm,
+    long	nmatched)
+{
+    hlcache_entry_T *e;
+    int		    i = HLCACHE_HASH(lnum);
+
+    if (hc->hc_count >= HLCACHE_MAX_ENTRIES)
+	hlcache_clear(hc);
+    e = ALLOC_ONE(hlcache_entry_T);
+    if (e == NULL)
+	return;
+    e->hce_lnum = lnum;
+    e->hce_col = col;
+    e->hce_nmatched = nmatched;
+    if (nmatched > 0)
+    {
+	e->hce_startpos = rm->startpos[0];
+	e->hce_endpos = rm->endpos[0];
+    }
+    e->hce_next = hc->hc_hash[i];
+    hc->hc_hash[i] = e;
+    ++hc->hc_count;
+}
+
 /*
  * Search for a next 'hlsearch' or match.
  * Uses shl->buf.
@@ -4130,15 +4379,22 @@ next_search_hl(
 				&& shl == &cur->hl
 				&& cur->match.regprog == cur->hl.rm.regprog);
 	    int timed_out = FALSE;
+	    hlcache_T *hc = hlcache_get(shl->buf, &shl->rm);
 
-	    nmatched = vim_regexec_multi(&shl->rm, win, shl->buf, lnum,
-		    matchcol,
+	    if (hc == NULL
+		    || !hlcache_lookup(hc, lnum, matchcol, &shl->rm, &nmatched))
+	    {
+		nmatched = vim_regexec_multi(&shl->rm, win, shl->buf, lnum,
+			matchcol,
 #ifdef FEAT_RELTIME
-		    &(shl->tm), &timed_out
+			&(shl->tm), &timed_out
 #else
-		    NULL, NULL
+			NULL, NULL
 #endif
-		    );
+			);
+		if (hc != NULL && !called_emsg && !got_int && !timed_out)
+		    hlcache_add(hc, lnum, matchcol, &shl->rm, nmatched);
+	    }
 	    // Copy the regprog, in case it got freed and recompiled.
 	    if (regprog_is_copy)
 		cur->match.regprog = cur->hl.rm.regprog;
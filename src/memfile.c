@@ -68,6 +68,40 @@ extern int dos2;			// this is in os_amiga.c
 #define MEMFILE_PAGE_SIZE 4096		// default page size
 
 static long_u	total_mem_used = 0;	// total memory used for memfiles
+static long	last_mf_id = 0;		// last used mf_id
+static int	clock_fnum = 0;		// buffer where the clock hand is
+
+/*
+ * Flushing a swap file to disk can take a long time, e.g. on NFS.  When
+ * possible this is done by a separate thread, so that the user does not have
+ * to wait for it.  Only the fsync() or sync() call is done by the thread, the
+ * blocks are written before that, thus the thread does not use any of the
+ * memfile structures.  It uses a duplicate of the file descriptor, so that the
+ * swap file can be closed at any time.
+ */
+#if defined(UNIX) && defined(HAVE_PTHREAD) && defined(HAVE_PTHREAD_H)
+# define MF_SYNC_THREAD
+# include <pthread.h>
+
+# define SYNC_QUEUE_LEN 16	// max number of waiting requests
+
+typedef struct
+{
+    int		sr_fd;		// duplicate of the file descriptor
+    long	sr_id;		// mf_id of the memfile
+} syncreq_T;
+
+static pthread_mutex_t	sync_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	sync_cond = PTHREAD_COND_INITIALIZER;
+static int		sync_thread_state = 0;	// 1: running, -1: failed
+static syncreq_T	sync_queue[SYNC_QUEUE_LEN]; // waiting requests
+static int		sync_queue_len = 0;	// nr of items in sync_queue
+static int		sync_failed = FALSE;	// a flush failed
+static int		sync_busy = FALSE;	// the thread is flushing a file
+static int		sync_hold = FALSE;	// test_override('swap_sync_hold')
+
+static int mf_sync_async(memfile_T *mfp);
+#endif
 
 static void mf_ins_hash(memfile_T *, bhdr_T *);
 static void mf_rem_hash(memfile_T *, bhdr_T *);
@@ -75,6 +109,10 @@ static bhdr_T *mf_find_hash(memfile_T *, blocknr_T);
 static void mf_ins_used(memfile_T *, bhdr_T *);
 static void mf_rem_used(memfile_T *, bhdr_T *);
 static bhdr_T *mf_release(memfile_T *, int);
+static int mf_can_release(memfile_T *mfp, bhdr_T *hp);
+static int mf_compress(memfile_T *mfp, bhdr_T *hp);
+static int mf_uncompress(memfile_T *mfp, bhdr_T *hp);
+static bhdr_T *mf_release_cold(memfile_T **mfpp);
 static bhdr_T *mf_alloc_bhdr(memfile_T *, int);
 static void mf_free_bhdr(bhdr_T *);
 static void mf_ins_free(memfile_T *, bhdr_T *);
@@ -155,6 +193,10 @@ mf_open(char_u *fname, int flags)
     mfp->mf_used_first = NULL;		// used list is empty
     mfp->mf_used_last = NULL;
     mfp->mf_dirty = FALSE;
+    mfp->mf_lazy = NULL;
+    mfp->mf_id = ++last_mf_id;
+    mfp->mf_evicted = 0;
+    mfp->mf_zcount = 0;
     mfp->mf_used_count = 0;
     mf_hash_init(&mfp->mf_hash);
     mf_hash_init(&mfp->mf_trans);
@@ -249,6 +291,7 @@ mf_close(memfile_T *mfp, int del_file)
     }
     if (del_file && mfp->mf_fname != NULL)
 	mch_remove(mfp->mf_fname);
+    ml_lazy_free(mfp);
 					    // free entries in used list
     for (hp = mfp->mf_used_first; hp != NULL; hp = nextp)
     {
@@ -389,7 +432,7 @@ mf_new(memfile_T *mfp, int negative, int page_count)
 	    mfp->mf_blocknr_max += page_count;
 	}
     }
-    hp->bh_flags = BH_LOCKED | BH_DIRTY;	// new block is always dirty
+    hp->bh_flags = BH_LOCKED | BH_DIRTY | BH_REF; // new block is always dirty
     mfp->mf_dirty = TRUE;
     hp->bh_page_count = page_count;
     mf_ins_used(mfp, hp);
@@ -424,7 +467,13 @@ mf_get(memfile_T *mfp, blocknr_T nr, int page_count)
     hp = mf_find_hash(mfp, nr);
     if (hp == NULL)	// not in the hash list
     {
-	if (nr < 0 || nr >= mfp->mf_infile_count)   // can't be in the file
+	if (nr < 0)
+	{
+	    // can only be read from the file that is loaded lazily
+	    if (mfp->mf_lazy == NULL)
+		return NULL;
+	}
+	else if (nr >= mfp->mf_infile_count)	    // can't be in the file
 	    return NULL;
 
 	// could check here if the block is in the free list
@@ -441,7 +490,7 @@ mf_get(memfile_T *mfp, blocknr_T nr, int page_count)
 	hp->bh_bnum = nr;
 	hp->bh_flags = 0;
 	hp->bh_page_count = page_count;
-	if (mf_read(mfp, hp) == FAIL)	    // cannot read the block!
+	if ((nr < 0 ? ml_lazy_block(mfp, hp) : mf_read(mfp, hp)) == FAIL)
 	{
 	    mf_free_bhdr(hp);
 	    return NULL;
@@ -449,11 +498,13 @@ mf_get(memfile_T *mfp, blocknr_T nr, int page_count)
     }
     else
     {
+	if ((hp->bh_flags & BH_COMPRESSED) && mf_uncompress(mfp, hp) == FAIL)
+	    return NULL;
 	mf_rem_used(mfp, hp);	// remove from list, insert in front below
 	mf_rem_hash(mfp, hp);
     }
 
-    hp->bh_flags |= BH_LOCKED;
+    hp->bh_flags |= BH_LOCKED | BH_REF;
     mf_ins_used(mfp, hp);	// put in front of used list
     mf_ins_hash(mfp, hp);	// put in front of hash list
 
@@ -531,6 +582,8 @@ fdtofh(int filedescriptor)
  *  MFS_FLUSH	Make sure buffers are flushed to disk, so they will survive a
  *		system crash.
  *  MFS_ZERO	Only write block 0.
+ *  MFS_ASYNC	With MFS_FLUSH: flush the file in the background when
+ *		possible, don't wait for it.
  *
  * Return FAIL for failure, OK otherwise
  */
@@ -591,7 +644,11 @@ mf_sync(memfile_T *mfp, int flags)
     if (hp == NULL || status == FAIL)
 	mfp->mf_dirty = FALSE;
 
-    if ((flags & MFS_FLUSH) && *p_sws != NUL)
+    if ((flags & MFS_FLUSH) && *p_sws != NUL
+#ifdef MF_SYNC_THREAD
+	    && !((flags & MFS_ASYNC) && mf_sync_async(mfp) == OK)
+#endif
+	    )
     {
 #if defined(UNIX)
 # ifdef HAVE_FSYNC
@@ -675,6 +732,145 @@ mf_sync(memfile_T *mfp, int flags)
     return status;
 }
 
+#ifdef MF_SYNC_THREAD
+/*
+ * The thread that flushes swap files to disk.  Waits for requests in
+ * sync_queue and handles them in order.
+ */
+    static void *
+mf_sync_thread(void *arg UNUSED)
+{
+    syncreq_T	req;
+    int		failed;
+
+    pthread_mutex_lock(&sync_mutex);
+    for (;;)
+    {
+	while (sync_queue_len == 0 || sync_hold)
+	    pthread_cond_wait(&sync_cond, &sync_mutex);
+	req = sync_queue[0];
+	--sync_queue_len;
+	mch_memmove(sync_queue, sync_queue + 1,
+				  (size_t)sync_queue_len * sizeof(syncreq_T));
+	sync_busy = TRUE;
+	pthread_mutex_unlock(&sync_mutex);
+
+	failed = vim_fsync(req.sr_fd) != 0;
+	close(req.sr_fd);
+
+	pthread_mutex_lock(&sync_mutex);
+	sync_busy = FALSE;
+	if (failed)
+	    sync_failed = TRUE;
+    }
+    return NULL;
+}
+
+/*
+ * Let the sync thread flush memfile "mfp" to disk, starting the thread when
+ * needed.  The blocks must have been written already.
+ * When a previous flush in the background failed, this returns FAIL once, so
+ * that the caller flushes the file itself and can see whether it works.
+ * Return FAIL when the caller has to flush the file.
+ */
+    static int
+mf_sync_async(memfile_T *mfp)
+{
+    int		fd;
+    int		i;
+    int		retval = FAIL;
+
+    if (STRCMP(p_sws, "fsync") != 0 || (fd = dup(mfp->mf_fd)) < 0)
+	return FAIL;
+
+    pthread_mutex_lock(&sync_mutex);
+    if (sync_thread_state == 0)
+    {
+	pthread_t   thread;
+	sigset_t    all_sigs, old_sigs;
+
+	// The thread must not handle signals, block them all while it is
+	// created, it inherits the signal mask.
+	sigfillset(&all_sigs);
+	pthread_sigmask(SIG_SETMASK, &all_sigs, &old_sigs);
+	if (pthread_create(&thread, NULL, mf_sync_thread, NULL) == 0)
+	{
+	    pthread_detach(thread);
+	    sync_thread_state = 1;
+	}
+	else
+	    sync_thread_state = -1;
+	pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+    }
+
+    if (sync_failed)
+	sync_failed = FALSE;
+    else if (sync_thread_state > 0)
+    {
+	// A waiting request for the same file will also flush what was
+	// written now.
+	for (i = 0; i < sync_queue_len; ++i)
+	    if (sync_queue[i].sr_id == mfp->mf_id)
+		break;
+	if (i < sync_queue_len)
+	    retval = OK;
+	else if (sync_queue_len < SYNC_QUEUE_LEN)
+	{
+	    sync_queue[sync_queue_len].sr_fd = fd;
+	    sync_queue[sync_queue_len].sr_id = mfp->mf_id;
+	    ++sync_queue_len;
+	    fd = -1;		// closed by the thread
+	    pthread_cond_signal(&sync_cond);
+	    retval = OK;
+	}
+    }
+    pthread_mutex_unlock(&sync_mutex);
+
+    if (fd >= 0)
+	close(fd);
+    return retval;
+}
+#endif
+
+#if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * For test_override('swap_sync_hold'): when "hold" is TRUE files are not
+ * flushed in the background until this is called with FALSE.
+ */
+    void
+mf_sync_hold(int hold UNUSED)
+{
+# ifdef MF_SYNC_THREAD
+    pthread_mutex_lock(&sync_mutex);
+    sync_hold = hold;
+    pthread_cond_signal(&sync_cond);
+    pthread_mutex_unlock(&sync_mutex);
+# endif
+}
+
+/*
+ * For test_getvalue('swap_sync_pending'): return the number of files waiting
+ * to be flushed in the background, including the one being flushed.
+ * Returns -1 when files are not flushed in the background.
+ */
+    int
+mf_sync_pending(void)
+{
+# ifdef MF_SYNC_THREAD
+    int		n;
+
+    if (STRCMP(p_sws, "fsync") != 0)
+	return -1;
+    pthread_mutex_lock(&sync_mutex);
+    n = sync_queue_len + (sync_busy ? 1 : 0);
+    pthread_mutex_unlock(&sync_mutex);
+    return n;
+# else
+    return -1;
+# endif
+}
+#endif
+
 /*
  * For all blocks in memory file *mfp that have a positive block number set
  * the dirty flag.  These are blocks that need to be written to a newly
@@ -733,6 +929,8 @@ mf_ins_used(memfile_T *mfp, bhdr_T *hp)
 	hp->bh_next->bh_prev = hp;
     mfp->mf_used_count += hp->bh_page_count;
     total_mem_used += hp->bh_page_count * mfp->mf_page_size;
+    if (hp->bh_flags & BH_COMPRESSED)
+	mfp->mf_zcount += hp->bh_page_count;
 }
 
 /*
@@ -751,16 +949,21 @@ mf_rem_used(memfile_T *mfp, bhdr_T *hp)
 	hp->bh_prev->bh_next = hp->bh_next;
     mfp->mf_used_count -= hp->bh_page_count;
     total_mem_used -= hp->bh_page_count * mfp->mf_page_size;
+    if (hp->bh_flags & BH_COMPRESSED)
+	mfp->mf_zcount -= hp->bh_page_count;
 }
 
 /*
  * Release the least recently used block from the used list if the number
  * of used memory blocks gets to big.
+ * When the total memory used is over 'maxmemtot' a block that was not used
+ * recently is released, this may be a block of another memfile.
  *
  * Return the block header to the caller, including the memory block, so
  * it can be re-used. Make sure the page_count is right.
  *
- * Returns NULL if no block is released.
+ * Returns NULL if no block is released or a block of another memfile was
+ * released.
  */
     static bhdr_T *
 mf_release(memfile_T *mfp, int page_count)
@@ -768,9 +971,11 @@ mf_release(memfile_T *mfp, int page_count)
     bhdr_T	*hp;
     int		need_release;
     buf_T	*buf;
+    memfile_T	*cold_mfp;
 
-    // don't release while in mf_close_file()
-    if (mf_dont_release)
+    // don't release while in mf_close_file(), except blocks that can be read
+    // from a lazily loaded file
+    if (mf_dont_release && mfp->mf_lazy == NULL)
 	return NULL;
 
     /*
@@ -784,7 +989,7 @@ mf_release(memfile_T *mfp, int page_count)
      * Try to create a swap file if the amount of memory used is getting too
      * high.
      */
-    if (mfp->mf_fd < 0 && need_release && p_uc)
+    if (mfp->mf_fd < 0 && need_release && p_uc && !mf_dont_release)
     {
 	// find for which buffer this memfile is
 	FOR_ALL_BUFFERS(buf)
@@ -802,31 +1007,58 @@ mf_release(memfile_T *mfp, int page_count)
      *	  and
      *	total memory used is not up to 'maxmemtot'
      */
-    if (mfp->mf_fd < 0 || !need_release)
+    if (!need_release)
 	return NULL;
 
-    for (hp = mfp->mf_used_last; hp != NULL; hp = hp->bh_prev)
-	if (!(hp->bh_flags & BH_LOCKED))
-	    break;
-    if (hp == NULL)	// not a single one that can be released
-	return NULL;
+    hp = NULL;
+    if ((total_mem_used >> 10) >= (long_u)p_mmt)
+    {
+	// Over the total: release a cold block of any buffer, also hidden
+	// ones.
+	hp = mf_release_cold(&cold_mfp);
+	if (hp != NULL && cold_mfp != mfp)
+	{
+	    mf_free_bhdr(hp);
+	    return NULL;
+	}
+    }
 
-    /*
-     * If the block is dirty, write it.
-     * If the write fails we don't free it.
-     */
-    if ((hp->bh_flags & BH_DIRTY) && mf_write(mfp, hp) == FAIL)
+    if (hp == NULL && mfp->mf_fd < 0 && mfp->mf_lazy == NULL)
+    {
+	// Without a swap file blocks can't be released, compress a block
+	// that was not used recently instead.
+	if (p_mcp)
+	    (void)mf_compress_cold(mfp, FALSE);
 	return NULL;
+    }
+
+    if (hp == NULL)
+    {
+	for (hp = mfp->mf_used_last; hp != NULL; hp = hp->bh_prev)
+	    if (mf_can_release(mfp, hp))
+		break;
+	if (hp == NULL)	// not a single one that can be released
+	    return NULL;
+
+	/*
+	 * If the block is dirty, write it.
+	 * If the write fails we don't free it.
+	 */
+	if ((hp->bh_flags & BH_DIRTY) && mf_write(mfp, hp) == FAIL)
+	    return NULL;
 
-    mf_rem_used(mfp, hp);
-    mf_rem_hash(mfp, hp);
+	mf_rem_used(mfp, hp);
+	mf_rem_hash(mfp, hp);
+	mfp->mf_evicted += hp->bh_page_count;
+    }
 
     /*
      * If a bhdr_T is returned, make sure that the page_count of bh_data is
-     * right
+     * right, compressed data can't be used
      */
-    if (hp->bh_page_count != page_count)
+    if (hp->bh_page_count != page_count || (hp->bh_flags & BH_COMPRESSED))
     {
+	hp->bh_flags &= ~BH_COMPRESSED;
 	vim_free(hp->bh_data);
 	if ((hp->bh_data = alloc(mfp->mf_page_size * page_count)) == NULL)
 	{
@@ -838,6 +1070,79 @@ mf_release(memfile_T *mfp, int page_count)
     return hp;
 }
 
+/*
+ * Return TRUE if block "hp" of memfile "mfp" can be released from memory.
+ */
+    static int
+mf_can_release(memfile_T *mfp, bhdr_T *hp)
+{
+    if (hp->bh_flags & BH_LOCKED)
+	return FALSE;
+    if (mfp->mf_fd >= 0 && !mf_dont_release)
+	return TRUE;
+
+    // Without a swap file only a block that was read from a lazily loaded
+    // file and wasn't changed can be released, it can be read again.
+    return mfp->mf_lazy != NULL && hp->bh_bnum < 0
+					      && !(hp->bh_flags & BH_DIRTY);
+}
+
+/*
+ * Find a block that was not used recently in any memfile and release it.
+ * This works like a clock: the hand goes over the buffers, in each memfile
+ * the blocks are checked from the least recently used one.  A block that was
+ * used since the hand passed it gets another chance, the hand continues to
+ * the next one.  A dirty block is written to the swap file first.
+ * The hand stays at the buffer where a block was released.
+ *
+ * Returns the block, removed from the lists of its memfile, which is stored
+ * in "*mfpp".  Returns NULL when there is no block that can be released.
+ */
+    static bhdr_T *
+mf_release_cold(memfile_T **mfpp)
+{
+    buf_T	*buf;
+    buf_T	*start_buf;
+    memfile_T	*mfp;
+    bhdr_T	*hp;
+    int		passed_start = 0;
+
+    FOR_ALL_BUFFERS(start_buf)
+	if (start_buf->b_fnum >= clock_fnum)
+	    break;
+    if (start_buf == NULL)
+	start_buf = firstbuf;
+
+    // Go around twice, the first time all blocks may be referenced.
+    for (buf = start_buf; buf != NULL && passed_start < 3;
+		      buf = buf->b_next != NULL ? buf->b_next : firstbuf)
+    {
+	if (buf == start_buf)
+	    ++passed_start;
+	mfp = buf->b_ml.ml_mfp;
+	if (mfp == NULL || (mfp->mf_fd < 0 && mfp->mf_lazy == NULL))
+	    continue;
+
+	for (hp = mfp->mf_used_last; hp != NULL; hp = hp->bh_prev)
+	{
+	    if (!mf_can_release(mfp, hp))
+		continue;
+	    if (hp->bh_flags & BH_REF)
+		hp->bh_flags &= ~BH_REF;
+	    else if (!(hp->bh_flags & BH_DIRTY) || mf_write(mfp, hp) == OK)
+	    {
+		mf_rem_used(mfp, hp);
+		mf_rem_hash(mfp, hp);
+		mfp->mf_evicted += hp->bh_page_count;
+		clock_fnum = buf->b_fnum;
+		*mfpp = mfp;
+		return hp;
+	    }
+	}
+    }
+    return NULL;
+}
+
 /*
  * release as many blocks as possible
  * Used in case of out of memory
@@ -861,17 +1166,20 @@ mf_release_all(void)
 	    if (mfp->mf_fd < 0 && buf->b_may_swap)
 		ml_open_file(buf);
 
-	    // only if there is a swapfile
-	    if (mfp->mf_fd >= 0)
+	    // only if there is a swapfile or the file is loaded lazily
+	    if (mfp->mf_fd >= 0 || mfp->mf_lazy != NULL)
 	    {
 		for (hp = mfp->mf_used_last; hp != NULL; )
 		{
 		    if (!(hp->bh_flags & BH_LOCKED)
+			    && (mfp->mf_fd >= 0 || hp->bh_bnum < 0)
 			    && (!(hp->bh_flags & BH_DIRTY)
-				|| mf_write(mfp, hp) != FAIL))
+				|| (mfp->mf_fd >= 0
+				    && mf_write(mfp, hp) != FAIL)))
 		    {
 			mf_rem_used(mfp, hp);
 			mf_rem_hash(mfp, hp);
+			mfp->mf_evicted += hp->bh_page_count;
 			mf_free_bhdr(hp);
 			hp = mfp->mf_used_last;	// re-start, list was changed
 			retval = TRUE;
@@ -1090,9 +1398,13 @@ mf_write_block(
     off_T	offset UNUSED,
     unsigned	size)
 {
-    char_u	*data = hp->bh_data;
+    char_u	*data;
     int		result = OK;
 
+    if ((hp->bh_flags & BH_COMPRESSED) && mf_uncompress(mfp, hp) == FAIL)
+	return FAIL;
+    data = hp->bh_data;
+
 #ifdef FEAT_CRYPT
     // Encrypt if 'key' is set and this is a data block.
     if (*mfp->mf_buffer->b_p_key != NUL)
@@ -1215,6 +1527,273 @@ mf_set_ffname(memfile_T *mfp)
     mfp->mf_ffname = FullName_save(mfp->mf_fname, FALSE);
 }
 
+/*
+ * Compression of blocks that were not used for a while.
+ *
+ * When a memfile has no swap file its blocks can't be released.  To use less
+ * memory blocks that were not used recently are compressed.  mf_get()
+ * uncompresses them again.  This uses a simple LZ77 method, which is fast
+ * and works well for text:
+ * A sequence starts with a token byte, the high four bits are the number of
+ * literal bytes, the low four bits the length of the match minus
+ * LZ_MIN_MATCH.  When a length is 15 it is followed by bytes that are added
+ * to it, until a byte is not 255.  The literal bytes come next and then the
+ * offset of the match, two bytes, least significant byte first.  The last
+ * sequence only has literal bytes.
+ */
+#define LZ_HASH_BITS	12
+#define LZ_MIN_MATCH	4
+#define LZ_MAX_OFFSET	0xffff
+
+/*
+ * Add a length of "len" to "dst" at "*opp", the part that didn't fit in the
+ * four bits of the token.
+ */
+    static void
+mf_lz_put_len(char_u *dst, long *opp, long len)
+{
+    for ( ; len >= 255; len -= 255)
+	dst[(*opp)++] = 255;
+    dst[(*opp)++] = (char_u)len;
+}
+
+/*
+ * Add a sequence to "dst" at "*opp": "litlen" bytes from "lit" and a match
+ * of "matchlen" bytes "offset" back.  "matchlen" is zero for the last
+ * sequence.
+ * Returns FAIL if it doesn't fit in "dst_len" bytes.
+ */
+    static int
+mf_lz_put_seq(
+    char_u	*dst,
+    long	*opp,
+    long	dst_len,
+    char_u	*lit,
+    long	litlen,
+    long	offset,
+    long	matchlen)
+{
+    int		token;
+
+    // the worst case is used, a length byte is added for every 255
+    if (*opp + 1 + litlen / 255 + 1 + litlen + 2 + matchlen / 255 + 1
+								    > dst_len)
+	return FAIL;
+
+    token = (litlen < 15 ? litlen : 15) << 4;
+    if (matchlen > 0)
+	token |= matchlen - LZ_MIN_MATCH < 15 ? matchlen - LZ_MIN_MATCH : 15;
+    dst[(*opp)++] = token;
+    if (litlen >= 15)
+	mf_lz_put_len(dst, opp, litlen - 15);
+    mch_memmove(dst + *opp, lit, (size_t)litlen);
+    *opp += litlen;
+    if (matchlen > 0)
+    {
+	dst[(*opp)++] = offset & 0xff;
+	dst[(*opp)++] = offset >> 8;
+	if (matchlen - LZ_MIN_MATCH >= 15)
+	    mf_lz_put_len(dst, opp, matchlen - LZ_MIN_MATCH - 15);
+    }
+    return OK;
+}
+
+/*
+ * Compress "len" bytes from "src" into "dst".
+ * Returns the compressed size, -1 if it's not less than "dst_len".
+ */
+    static long
+mf_lz_compress(char_u *src, long len, char_u *dst, long dst_len)
+{
+    static long	table[1 << LZ_HASH_BITS];
+    long	ip = 0;		// current position in "src"
+    long	anchor = 0;	// start of literal bytes
+    long	op = 0;		// current position in "dst"
+    long	ref;
+    long	matchlen;
+    UINT32_T	h;
+    int		i;
+
+    for (i = 0; i < (1 << LZ_HASH_BITS); ++i)
+	table[i] = -1;
+
+    while (ip + LZ_MIN_MATCH <= len)
+    {
+	h = ((UINT32_T)src[ip] | ((UINT32_T)src[ip + 1] << 8)
+		| ((UINT32_T)src[ip + 2] << 16) | ((UINT32_T)src[ip + 3] << 24))
+						 * (UINT32_T)2654435761UL;
+	h >>= 32 - LZ_HASH_BITS;
+	ref = table[h];
+	table[h] = ip;
+	if (ref < 0 || ip - ref > LZ_MAX_OFFSET
+		|| memcmp(src + ref, src + ip, LZ_MIN_MATCH) != 0)
+	{
+	    ++ip;
+	    continue;
+	}
+
+	matchlen = LZ_MIN_MATCH;
+	while (ip + matchlen < len && src[ref + matchlen] == src[ip + matchlen])
+	    ++matchlen;
+	if (mf_lz_put_seq(dst, &op, dst_len, src + anchor, ip - anchor,
+					       ip - ref, matchlen) == FAIL)
+	    return -1;
+	ip += matchlen;
+	anchor = ip;
+    }
+    if (anchor < len && mf_lz_put_seq(dst, &op, dst_len, src + anchor,
+						 len - anchor, 0, 0) == FAIL)
+	return -1;
+    return op;
+}
+
+/*
+ * Uncompress "src" into "dst", which is "len" bytes.
+ * Returns FAIL when the data is invalid.
+ */
+    static int
+mf_lz_uncompress(char_u *src, char_u *dst, long len)
+{
+    long	op = 0;
+    long	n;
+    long	offset;
+    int		token;
+    int		c;
+
+    while (op < len)
+    {
+	token = *src++;
+	n = token >> 4;
+	if (n == 15)
+	    do
+	    {
+		c = *src++;
+		n += c;
+	    } while (c == 255);
+	if (op + n > len)
+	    return FAIL;
+	mch_memmove(dst + op, src, (size_t)n);
+	src += n;
+	op += n;
+	if (op == len)
+	    break;
+
+	offset = src[0] | (src[1] << 8);
+	src += 2;
+	n = (token & 15) + LZ_MIN_MATCH;
+	if ((token & 15) == 15)
+	    do
+	    {
+		c = *src++;
+		n += c;
+	    } while (c == 255);
+	if (offset == 0 || offset > op || op + n > len)
+	    return FAIL;
+	// the match may overlap with the bytes being produced
+	for ( ; n > 0; --n, ++op)
+	    dst[op] = dst[op - offset];
+    }
+    return OK;
+}
+
+/*
+ * Compress the data of block "hp".  Nothing happens when it doesn't get
+ * smaller by at least a quarter.
+ * Return OK when compressed.
+ */
+    static int
+mf_compress(memfile_T *mfp, bhdr_T *hp)
+{
+    long	size = (long)mfp->mf_page_size * hp->bh_page_count;
+    char_u	*p;
+    long	len;
+
+    p = alloc(size);
+    if (p == NULL)
+	return FAIL;
+    len = mf_lz_compress(hp->bh_data, size, p, size - size / 4);
+    if (len < 0)
+    {
+	vim_free(p);
+	return FAIL;
+    }
+    vim_free(hp->bh_data);
+    hp->bh_data = vim_realloc(p, len);
+    if (hp->bh_data == NULL)
+	hp->bh_data = p;
+    hp->bh_flags |= BH_COMPRESSED;
+    mfp->mf_zcount += hp->bh_page_count;
+    return OK;
+}
+
+/*
+ * Uncompress the data of block "hp".
+ */
+    static int
+mf_uncompress(memfile_T *mfp, bhdr_T *hp)
+{
+    long	size = (long)mfp->mf_page_size * hp->bh_page_count;
+    char_u	*p;
+
+    p = alloc(size);
+    if (p == NULL)
+	return FAIL;
+    if (mf_lz_uncompress(hp->bh_data, p, size) == FAIL)
+    {
+	vim_free(p);
+	iemsg(_("E1001: Cannot uncompress memline block"));
+	return FAIL;
+    }
+    vim_free(hp->bh_data);
+    hp->bh_data = p;
+    hp->bh_flags &= ~BH_COMPRESSED;
+    mfp->mf_zcount -= hp->bh_page_count;
+    return OK;
+}
+
+/*
+ * Compress blocks of memfile "mfp" that were not used recently.  This works
+ * like a clock: the blocks are taken from the end of the used list and put
+ * in front.  A block that was used since the previous time gets another
+ * chance, otherwise it is compressed.
+ * When "all" is TRUE go over all the blocks, stop when a character is typed.
+ * Otherwise stop after compressing one block or checking a few.
+ * Returns the number of blocks compressed.
+ */
+    int
+mf_compress_cold(memfile_T *mfp, int all)
+{
+    bhdr_T	*hp;
+    bhdr_T	*first = NULL;
+    int		count = 0;
+    int		checked = 0;
+
+    while ((hp = mfp->mf_used_last) != NULL && hp != first)
+    {
+	if (first == NULL)
+	    first = hp;
+
+	// move it to the front, the end of the list is checked next time
+	mf_rem_used(mfp, hp);
+	mf_ins_used(mfp, hp);
+
+	if (hp->bh_flags & BH_REF)
+	    hp->bh_flags &= ~BH_REF;
+	else if (!(hp->bh_flags & (BH_LOCKED | BH_COMPRESSED))
+		&& !mf_can_release(mfp, hp) && mf_compress(mfp, hp) == OK)
+	{
+	    ++count;
+	    if (!all)
+		break;
+	}
+
+	++checked;
+	if (all ? (checked % 50 == 0 && ui_char_avail()) : checked >= 50)
+	    break;
+    }
+    return count;
+}
+
 /*
  * Make the name of the file used for the memfile a full path.
  * Used before doing a :cd
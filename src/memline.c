@@ -244,6 +244,7 @@ static void add_b0_fenc(ZERO_BL *b0p, buf_T *buf);
 static time_t swapfile_info(char_u *);
 static int recov_file_names(char_u **, char_u *, int prepend_dot);
 static int ml_delete_int(buf_T *, linenr_T, int);
+static int ml_delete_many_int(buf_T *, linenr_T, long, int);
 static char_u *findswapname(buf_T *, char_u **, char_u *);
 static void ml_flush_line(buf_T *);
 static bhdr_T *ml_new_data(memfile_T *, int, int);
@@ -251,6 +252,10 @@ static bhdr_T *ml_new_ptr(memfile_T *);
 static bhdr_T *ml_find_line(buf_T *, linenr_T, int);
 static int ml_add_stack(buf_T *);
 static void ml_lineadd(buf_T *, int);
+static void ml_cache_add(buf_T *buf, bhdr_T *hp, linenr_T low, linenr_T high);
+static bhdr_T *ml_cache_find(buf_T *buf, linenr_T lnum, bhdr_T *hp, linenr_T *lowp, linenr_T *highp);
+static void ml_cache_clear(buf_T *buf);
+static void ml_locked_lineadd(buf_T *buf, long count);
 static int b0_magic_wrong(ZERO_BL *);
 #ifdef CHECK_INODE
 static int fnamecmp_ino(char_u *, char_u *, long);
@@ -262,6 +267,7 @@ static cryptstate_T *ml_crypt_prepare(memfile_T *mfp, off_T offset, int reading)
 #endif
 #ifdef FEAT_BYTEOFF
 static void ml_updatechunk(buf_T *buf, long line, long len, int updtype);
+static void ml_updatechunk_many(buf_T *buf, linenr_T line, long count, long len);
 #endif
 
 /*
@@ -285,9 +291,14 @@ ml_open(buf_T *buf)
     buf->b_ml.ml_stack = NULL;	// no stack yet
     buf->b_ml.ml_stack_top = 0;	// nothing in the stack
     buf->b_ml.ml_locked = NULL;	// no cached block
+    buf->b_ml.ml_cache_count = 0;
+    buf->b_ml.ml_cache_hits = 0;
+    buf->b_ml.ml_cache_misses = 0;
     buf->b_ml.ml_line_lnum = 0;	// no cached line
 #ifdef FEAT_BYTEOFF
     buf->b_ml.ml_chunksize = NULL;
+    buf->b_ml.ml_chunktree = NULL;
+    buf->b_ml.ml_chunktree_len = 0;
 #endif
 
     if (cmdmod.noswapfile)
@@ -842,13 +853,19 @@ ml_close(buf_T *buf, int del_file)
     if (buf->b_ml.ml_mfp == NULL)		// not open
 	return;
     mf_close(buf->b_ml.ml_mfp, del_file);	// close the .swp file
+    buf->b_ml.ml_cache_count = 0;		// blocks were freed
     if (buf->b_ml.ml_line_lnum != 0 && (buf->b_ml.ml_flags & ML_LINE_DIRTY))
 	vim_free(buf->b_ml.ml_line_ptr);
     vim_free(buf->b_ml.ml_stack);
 #ifdef FEAT_BYTEOFF
     VIM_CLEAR(buf->b_ml.ml_chunksize);
+    VIM_CLEAR(buf->b_ml.ml_chunktree);
+    buf->b_ml.ml_chunktree_len = 0;
 #endif
     buf->b_ml.ml_mfp = NULL;
+#ifdef FEAT_SEARCH_EXTRA
+    hlcache_free(buf);
+#endif
 
     // Reset the "recovered" flag, give the ATTENTION prompt the next time
     // this buffer is loaded.
@@ -1200,6 +1217,9 @@ ml_recover(int checkext)
     buf->b_ml.ml_stack_top = 0;		// nothing in the stack
     buf->b_ml.ml_line_lnum = 0;		// no cached line
     buf->b_ml.ml_locked = NULL;		// no locked block
+    buf->b_ml.ml_cache_count = 0;
+    buf->b_ml.ml_cache_hits = 0;
+    buf->b_ml.ml_cache_misses = 0;
     buf->b_ml.ml_flags = 0;
 #ifdef FEAT_CRYPT
     buf->b_p_key = empty_option;
@@ -1701,6 +1721,9 @@ ml_recover(int checkext)
     }
 #endif
     redraw_curbuf_later(NOT_VALID);
+#ifdef FEAT_SEARCH_EXTRA
+    hlcache_free(curbuf);
+#endif
 
 theend:
     vim_free(fname_used);
@@ -2427,7 +2450,8 @@ end:
  *
  * If 'check_file' is TRUE, check if original file exists and was not changed.
  * If 'check_char' is TRUE, stop syncing when character becomes available, but
- * always sync at least one block.
+ * always sync at least one block.  Also don't wait for the file to be flushed
+ * to disk then.
  */
     void
 ml_sync_all(int check_file, int check_char)
@@ -2437,8 +2461,22 @@ ml_sync_all(int check_file, int check_char)
 
     FOR_ALL_BUFFERS(buf)
     {
-	if (buf->b_ml.ml_mfp == NULL || buf->b_ml.ml_mfp->mf_fname == NULL)
-	    continue;			    // no file
+	if (buf->b_ml.ml_mfp == NULL)
+	    continue;
+	if (buf->b_ml.ml_mfp->mf_fname == NULL)
+	{
+	    // No swap file: after waiting for 'updatetime' compress blocks
+	    // that were not used recently.
+	    if (check_file && check_char && p_mcp)
+	    {
+		ml_flush_line(buf);
+		(void)ml_find_line(buf, (linenr_T)0, ML_FLUSH);
+		(void)mf_compress_cold(buf->b_ml.ml_mfp, TRUE);
+		if (ui_char_avail())
+		    break;
+	    }
+	    continue;
+	}
 
 	ml_flush_line(buf);		    // flush buffered line
 					    // flush locked block
@@ -2461,7 +2499,8 @@ ml_sync_all(int check_file, int check_char)
 	}
 	if (buf->b_ml.ml_mfp->mf_dirty)
 	{
-	    (void)mf_sync(buf->b_ml.ml_mfp, (check_char ? MFS_STOP : 0)
+	    (void)mf_sync(buf->b_ml.ml_mfp,
+				       (check_char ? MFS_STOP | MFS_ASYNC : 0)
 					| (bufIsChanged(buf) ? MFS_FLUSH : 0));
 	    if (check_char && ui_char_avail())	// character available now
 		break;
@@ -2501,6 +2540,14 @@ ml_preserve(buf_T *buf, int message)
 
     ml_flush_line(buf);				    // flush buffered line
     (void)ml_find_line(buf, (linenr_T)0, ML_FLUSH); // flush locked block
+
+    // Lines that were not read from a lazily loaded file yet must be put in
+    // the swap file as well.
+    if (ml_lazy_load_all(buf) == FAIL)
+    {
+	status = FAIL;
+	goto theend;
+    }
     status = mf_sync(mfp, MFS_ALL | MFS_FLUSH);
 
     // stack is invalid after mf_sync(.., MFS_ALL)
@@ -2597,6 +2644,51 @@ ml_get_cursor(void)
 							curwin->w_cursor.col);
 }
 
+/*
+ * Return the length of line "lnum" in the current buffer, excluding the NUL.
+ */
+    colnr_T
+ml_get_len(linenr_T lnum)
+{
+    return ml_get_buf_len(curbuf, lnum);
+}
+
+/*
+ * Return the length of the cursor line, excluding the NUL.
+ */
+    colnr_T
+ml_get_curline_len(void)
+{
+    return ml_get_buf_len(curbuf, curwin->w_cursor.lnum);
+}
+
+/*
+ * Return the length of the text from the cursor position to the end of the
+ * line, excluding the NUL.
+ */
+    colnr_T
+ml_get_cursor_len(void)
+{
+    colnr_T len = ml_get_curline_len();
+
+    return len > curwin->w_cursor.col ? len - curwin->w_cursor.col : 0;
+}
+
+/*
+ * Return the length of line "lnum" in buffer "buf", excluding the NUL.
+ * The length is taken from the data block index when possible, so that the
+ * line does not need to be scanned for the NUL.
+ */
+    colnr_T
+ml_get_buf_len(buf_T *buf, linenr_T lnum)
+{
+    char_u	*line = ml_get_buf(buf, lnum, FALSE);
+
+    if (buf->b_ml.ml_line_textlen <= 0)
+	buf->b_ml.ml_line_textlen = (colnr_T)STRLEN(line) + 1;
+    return buf->b_ml.ml_line_textlen - 1;
+}
+
 /*
  * Return a pointer to a line in a specific buffer
  *
@@ -2626,6 +2718,7 @@ ml_get_buf(
 errorret:
 	STRCPY(IObuff, "???");
 	buf->b_ml.ml_line_len = 4;
+	buf->b_ml.ml_line_textlen = 0;
 	return IObuff;
     }
     if (lnum <= 0)			// pretend line 0 is line 1
@@ -2634,6 +2727,7 @@ errorret:
     if (buf->b_ml.ml_mfp == NULL)	// there are no lines
     {
 	buf->b_ml.ml_line_len = 1;
+	buf->b_ml.ml_line_textlen = 0;
 	return (char_u *)"";
     }
 
@@ -2686,11 +2780,22 @@ errorret:
 
 	buf->b_ml.ml_line_ptr = (char_u *)dp + start;
 	buf->b_ml.ml_line_len = len;
+#ifdef FEAT_PROP_POPUP
+	// Text properties are stored after the NUL, then the text length is
+	// only known after a STRLEN().
+	buf->b_ml.ml_line_textlen = buf->b_has_textprop ? 0 : len;
+#else
+	buf->b_ml.ml_line_textlen = len;
+#endif
 	buf->b_ml.ml_line_lnum = lnum;
 	buf->b_ml.ml_flags &= ~ML_LINE_DIRTY;
     }
     if (will_change)
+    {
 	buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
+	// The caller may change the length of the text.
+	buf->b_ml.ml_line_textlen = 0;
+    }
 
     return buf->b_ml.ml_line_ptr;
 }
@@ -2849,8 +2954,7 @@ ml_append_int(
 	 * expected, the line count has to be adjusted in the pointer blocks
 	 * by using ml_locked_lineadd.
 	 */
-	--(buf->b_ml.ml_locked_lineadd);
-	--(buf->b_ml.ml_locked_high);
+	ml_locked_lineadd(buf, -1L);
 	if ((hp = ml_find_line(buf, lnum + 1, ML_INSERT)) == NULL)
 	    goto theend;
 
@@ -2982,8 +3086,7 @@ ml_append_int(
 	if ((hp_new = ml_new_data(mfp, newfile, page_count)) == NULL)
 	{
 			// correct line counts in pointer blocks
-	    --(buf->b_ml.ml_locked_lineadd);
-	    --(buf->b_ml.ml_locked_high);
+	    ml_locked_lineadd(buf, -1L);
 	    goto theend;
 	}
 	if (db_idx < 0)		// left block is new
@@ -3286,6 +3389,174 @@ theend:
     return ret;
 }
 
+/*
+ * Append lines from "lines" after line "lnum" in the data block that contains
+ * "lnum", as many as fit in the free space of the block, at most "count".
+ * This moves the text of the following lines only once.
+ * Returns the number of lines appended, zero when not even one fits and -1
+ * for failure.
+ */
+    static long
+ml_append_in_block(
+    buf_T	*buf,
+    linenr_T	lnum,		// append after this line (can be 0)
+    char_u	**lines,	// text of the new lines
+    long	count,		// number of lines in "lines"
+    int		newfile)	// flag, see ml_append()
+{
+    bhdr_T	*hp;
+    DATA_BL	*dp;
+    int		db_idx;		// index for lnum in data block
+    int		line_count;	// number of indexes in current block
+    long	n;
+    int		total = 0;	// size of the text of the new lines
+    int		len;
+    int		offset;
+    int		i;
+
+    if ((hp = ml_find_line(buf, lnum == 0 ? (linenr_T)1 : lnum,
+							  ML_INSERT)) == NULL)
+	return -1;
+
+    if (lnum == 0)		// got line one instead, correct db_idx
+	db_idx = -1;		// careful, it is negative!
+    else
+	db_idx = lnum - buf->b_ml.ml_locked_low;
+		// get line count before the insertion
+    line_count = buf->b_ml.ml_locked_high - buf->b_ml.ml_locked_low;
+    dp = (DATA_BL *)(hp->bh_data);
+
+    for (n = 0; n < count; ++n)
+    {
+	len = (int)STRLEN(lines[n]) + 1;
+	if (total + len + (long)((n + 1) * INDEX_SIZE) > (long)dp->db_free)
+	    break;
+	total += len;
+    }
+    if (n == 0)
+    {
+	// Nothing inserted, correct the line counts ml_find_line() adjusted.
+	ml_locked_lineadd(buf, -1L);
+	return 0;
+    }
+
+    buf->b_ml.ml_flags &= ~ML_EMPTY;
+    buf->b_ml.ml_line_count += n;
+    // ml_find_line() already counted one line
+    ml_locked_lineadd(buf, n - 1);
+
+    dp->db_txt_start -= total;
+    dp->db_free -= total + n * INDEX_SIZE;
+    dp->db_line_count += n;
+
+    // Offset is the start of the previous line, the text of the new lines
+    // goes just before it.  Move the text and indexes of the lines that
+    // follow to make room.
+    if (db_idx < 0)
+	offset = dp->db_txt_end;
+    else
+	offset = ((dp->db_index[db_idx]) & DB_INDEX_MASK);
+    if (line_count > db_idx + 1)
+    {
+	mch_memmove((char *)dp + dp->db_txt_start,
+				      (char *)dp + dp->db_txt_start + total,
+			     (size_t)(offset - (dp->db_txt_start + total)));
+	for (i = line_count - 1; i > db_idx; --i)
+	    dp->db_index[i + n] = dp->db_index[i] - total;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+	len = (int)STRLEN(lines[i]) + 1;
+	offset -= len;
+	dp->db_index[db_idx + 1 + i] = offset;
+	mch_memmove((char *)dp + offset, lines[i], (size_t)len);
+    }
+
+    buf->b_ml.ml_flags |= ML_LOCKED_DIRTY;
+    if (!newfile)
+	buf->b_ml.ml_flags |= ML_LOCKED_POS;
+
+#ifdef FEAT_BYTEOFF
+    // This may unlock the block, do it when all lines are in it.
+    ml_updatechunk_many(buf, lnum + 1, n, (long)total);
+#endif
+    return n;
+}
+
+/*
+ * Append "count" lines from "lines" after line "lnum" of buffer "buf".
+ * Like calling ml_append_buf() for each line, but whole data blocks are
+ * filled at once and listeners are notified only once.
+ * Check: The caller of this function should probably also call
+ * appended_lines().
+ *
+ * return FAIL for failure, OK otherwise
+ */
+    int
+ml_append_many(
+    buf_T	*buf,
+    linenr_T	lnum,		// append after this line (can be 0)
+    char_u	**lines,	// text of the new lines
+    long	count,		// number of lines in "lines"
+    int		newfile)	// flag, see ml_append()
+{
+    long	done = 0;
+    long	n;
+    int		one_by_one = FALSE;
+
+    if (buf->b_ml.ml_mfp == NULL || lnum > buf->b_ml.ml_line_count)
+	return FAIL;
+
+    if (buf->b_ml.ml_line_lnum != 0)
+	ml_flush_line(buf);
+
+#ifdef FEAT_EVAL
+    // When inserting above recorded changes: flush the changes before changing
+    // the text.  Then flush the cached line, it may become invalid.
+    may_invoke_listeners(buf, lnum + 1, lnum + 1, (int)count);
+    if (buf->b_ml.ml_line_lnum != 0)
+	ml_flush_line(buf);
+#endif
+
+#ifdef FEAT_PROP_POPUP
+    // Text properties may continue in each new line.
+    if (curbuf->b_has_textprop)
+	one_by_one = TRUE;
+#endif
+#ifdef FEAT_NETBEANS_INTG
+    if (netbeans_active())
+	one_by_one = TRUE;
+#endif
+
+    if (lowest_marked && lowest_marked > lnum)
+	lowest_marked = lnum + 1;
+
+    while (done < count)
+    {
+	n = one_by_one ? 0 : ml_append_in_block(buf, lnum + done, lines + done,
+							 count - done, newfile);
+	if (n < 0)
+	    return FAIL;
+	if (n == 0)
+	{
+	    // Not enough room in the block: ml_append_int() splits it, the
+	    // following lines then go into the new block.
+	    if (ml_append_int(buf, lnum + done, lines[done], (colnr_T)0,
+						      newfile, FALSE) == FAIL)
+		return FAIL;
+	    n = 1;
+	}
+	done += n;
+    }
+
+#ifdef FEAT_JOB_CHANNEL
+    if (buf->b_write_to_channel)
+	channel_write_new_lines(buf);
+#endif
+    return OK;
+}
+
 /*
  * Flush any pending change and call ml_append_int()
  */
@@ -3469,6 +3740,7 @@ ml_replace_len(
 
     curbuf->b_ml.ml_line_ptr = line;
     curbuf->b_ml.ml_line_len = len;
+    curbuf->b_ml.ml_line_textlen = 0;
     curbuf->b_ml.ml_line_lnum = lnum;
     curbuf->b_ml.ml_flags = (curbuf->b_ml.ml_flags | ML_LINE_DIRTY) & ~ML_EMPTY;
 
@@ -3573,6 +3845,70 @@ adjust_text_props_for_delete(
 }
 #endif
 
+/*
+ * Free the locked data block of "buf", all its lines have been deleted.
+ * Then the entry pointing to this data block is removed from the pointer
+ * block.  If this pointer block also becomes empty, we go up another block,
+ * and so on, up to the root if necessary.
+ * The line counts in the pointer blocks must have been adjusted already by
+ * ml_find_line() and "ml_locked_lineadd".
+ * Return FAIL for failure, OK otherwise.
+ */
+    static int
+ml_free_locked_block(buf_T *buf)
+{
+    memfile_T	*mfp = buf->b_ml.ml_mfp;
+    bhdr_T	*hp;
+    PTR_BL	*pp;
+    infoptr_T	*ip;
+    int		count;
+    int		idx;
+    int		stack_idx;
+
+    mf_free(mfp, buf->b_ml.ml_locked);	// free the data block
+    buf->b_ml.ml_locked = NULL;
+
+    for (stack_idx = buf->b_ml.ml_stack_top - 1; stack_idx >= 0; --stack_idx)
+    {
+	buf->b_ml.ml_stack_top = 0;	    // stack is invalid when failing
+	ip = &(buf->b_ml.ml_stack[stack_idx]);
+	idx = ip->ip_index;
+	if ((hp = mf_get(mfp, ip->ip_bnum, 1)) == NULL)
+	    return FAIL;
+	pp = (PTR_BL *)(hp->bh_data);   // must be pointer block
+	if (pp->pb_id != PTR_ID)
+	{
+	    iemsg(_("E317: pointer block id wrong 4"));
+	    mf_put(mfp, hp, FALSE, FALSE);
+	    return FAIL;
+	}
+	count = --(pp->pb_count);
+	if (count == 0)	    // the pointer block becomes empty!
+	    mf_free(mfp, hp);
+	else
+	{
+	    if (count != idx)	// move entries after the deleted one
+		mch_memmove(&pp->pb_pointer[idx], &pp->pb_pointer[idx + 1],
+				      (size_t)(count - idx) * sizeof(PTR_EN));
+	    mf_put(mfp, hp, TRUE, FALSE);
+
+	    buf->b_ml.ml_stack_top = stack_idx;	// truncate stack
+	    // fix line count for rest of blocks in the stack
+	    if (buf->b_ml.ml_locked_lineadd != 0)
+	    {
+		ml_lineadd(buf, buf->b_ml.ml_locked_lineadd);
+		buf->b_ml.ml_stack[buf->b_ml.ml_stack_top].ip_high +=
+						  buf->b_ml.ml_locked_lineadd;
+	    }
+	    ++(buf->b_ml.ml_stack_top);
+
+	    break;
+	}
+    }
+    CHECK(stack_idx < 0, _("deleted block 1?"));
+    return OK;
+}
+
 /*
  * Delete line "lnum" in the current buffer.
  * When "message" is TRUE may give a "No lines in buffer" message.
@@ -3604,11 +3940,8 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int message)
     bhdr_T	*hp;
     memfile_T	*mfp;
     DATA_BL	*dp;
-    PTR_BL	*pp;
-    infoptr_T	*ip;
     int		count;	    // number of entries in block
     int		idx;
-    int		stack_idx;
     int		text_start;
     int		line_start;
     long	line_size;
@@ -3697,48 +4030,8 @@ ml_delete_int(buf_T *buf, linenr_T lnum, int message)
  */
     if (count == 1)
     {
-	mf_free(mfp, hp);	// free the data block
-	buf->b_ml.ml_locked = NULL;
-
-	for (stack_idx = buf->b_ml.ml_stack_top - 1; stack_idx >= 0;
-								  --stack_idx)
-	{
-	    buf->b_ml.ml_stack_top = 0;	    // stack is invalid when failing
-	    ip = &(buf->b_ml.ml_stack[stack_idx]);
-	    idx = ip->ip_index;
-	    if ((hp = mf_get(mfp, ip->ip_bnum, 1)) == NULL)
-		goto theend;
-	    pp = (PTR_BL *)(hp->bh_data);   // must be pointer block
-	    if (pp->pb_id != PTR_ID)
-	    {
-		iemsg(_("E317: pointer block id wrong 4"));
-		mf_put(mfp, hp, FALSE, FALSE);
-		goto theend;
-	    }
-	    count = --(pp->pb_count);
-	    if (count == 0)	    // the pointer block becomes empty!
-		mf_free(mfp, hp);
-	    else
-	    {
-		if (count != idx)	// move entries after the deleted one
-		    mch_memmove(&pp->pb_pointer[idx], &pp->pb_pointer[idx + 1],
-				      (size_t)(count - idx) * sizeof(PTR_EN));
-		mf_put(mfp, hp, TRUE, FALSE);
-
-		buf->b_ml.ml_stack_top = stack_idx;	// truncate stack
-		// fix line count for rest of blocks in the stack
-		if (buf->b_ml.ml_locked_lineadd != 0)
-		{
-		    ml_lineadd(buf, buf->b_ml.ml_locked_lineadd);
-		    buf->b_ml.ml_stack[buf->b_ml.ml_stack_top].ip_high +=
-						  buf->b_ml.ml_locked_lineadd;
-		}
-		++(buf->b_ml.ml_stack_top);
-
-		break;
-	    }
-	}
-	CHECK(stack_idx < 0, _("deleted block 1?"));
+	if (ml_free_locked_block(buf) == FAIL)
+	    goto theend;
     }
     else
     {
@@ -3787,61 +4080,190 @@ theend:
 }
 
 /*
- * set the DB_MARKED flag for line 'lnum'
+ * Delete "count" lines starting at line "lnum" in the current buffer.
+ * Works like calling ml_delete() "count" times, but data blocks that only
+ * contain deleted lines are freed as a whole and the text in the other
+ * blocks is moved only once.
+ * When "message" is TRUE may give a "No lines in buffer" message.
+ *
+ * return FAIL for failure, OK otherwise
  */
-    void
-ml_setmarked(linenr_T lnum)
+    int
+ml_delete_many(linenr_T lnum, long count, int message)
 {
-    bhdr_T    *hp;
-    DATA_BL *dp;
-				    // invalid line number
-    if (lnum < 1 || lnum > curbuf->b_ml.ml_line_count
-					       || curbuf->b_ml.ml_mfp == NULL)
-	return;			    // give error message?
-
-    if (lowest_marked == 0 || lowest_marked > lnum)
-	lowest_marked = lnum;
+    ml_flush_line(curbuf);
+    if (lnum < 1 || count < 1 || lnum + count - 1 > curbuf->b_ml.ml_line_count)
+	return FAIL;
 
-    /*
-     * find the data block containing the line
-     * This also fills the stack with the blocks from the root to the data block
-     * This also releases any locked block.
-     */
-    if ((hp = ml_find_line(curbuf, lnum, ML_FIND)) == NULL)
-	return;		    // give error message?
+#ifdef FEAT_EVAL
+    // When deleting above recorded changes: flush the changes before changing
+    // the text.
+    may_invoke_listeners(curbuf, lnum, lnum + count, -count);
+#endif
 
-    dp = (DATA_BL *)(hp->bh_data);
-    dp->db_index[lnum - curbuf->b_ml.ml_locked_low] |= DB_MARKED;
-    curbuf->b_ml.ml_flags |= ML_LOCKED_DIRTY;
+    return ml_delete_many_int(curbuf, lnum, count, message);
 }
 
-/*
- * find the first line with its DB_MARKED flag set
- */
-    linenr_T
-ml_firstmarked(void)
+    static int
+ml_delete_many_int(buf_T *buf, linenr_T lnum, long count, int message)
 {
     bhdr_T	*hp;
     DATA_BL	*dp;
-    linenr_T	lnum;
+    int		block_count;	// number of entries in block
+    int		idx;
+    int		n;
     int		i;
+    int		text_start;
+    int		line_start;
+    int		line_end;
+    long	size;
 
-    if (curbuf->b_ml.ml_mfp == NULL)
-	return (linenr_T) 0;
-
-    /*
-     * The search starts with lowest_marked line. This is the last line where
-     * a mark was found, adjusted by inserting/deleting lines.
-     */
-    for (lnum = lowest_marked; lnum <= curbuf->b_ml.ml_line_count; )
+    while (count > 0)
     {
-	/*
-	 * Find the data block containing the line.
-	 * This also fills the stack with the blocks from the root to the data
-	 * block This also releases any locked block.
-	 */
-	if ((hp = ml_find_line(curbuf, lnum, ML_FIND)) == NULL)
-	    return (linenr_T)0;		    // give error message?
+	// Deleting the last line in the buffer is special, text properties
+	// and netbeans need to know about every line: delete one line.
+	if (buf->b_ml.ml_line_count == 1
+#ifdef FEAT_PROP_POPUP
+		|| buf->b_has_textprop
+#endif
+#ifdef FEAT_NETBEANS_INTG
+		|| netbeans_active()
+#endif
+		)
+	{
+	    if (ml_delete_int(buf, lnum, message) == FAIL)
+		return FAIL;
+	    --count;
+	    continue;
+	}
+
+	// Find the data block and adjust the line counts for one line.
+	if ((hp = ml_find_line(buf, lnum, ML_DELETE)) == NULL)
+	    return FAIL;
+	dp = (DATA_BL *)(hp->bh_data);
+	block_count = (long)(buf->b_ml.ml_locked_high)
+					- (long)(buf->b_ml.ml_locked_low) + 2;
+	idx = lnum - buf->b_ml.ml_locked_low;
+	n = block_count - idx;
+	if (n > count)
+	    n = count;
+	// When deleting all lines keep the last one, see above.
+	if (n >= buf->b_ml.ml_line_count)
+	    n = buf->b_ml.ml_line_count - 1;
+
+	// The line counts for the other lines are adjusted when the block is
+	// released, like ml_find_line() does for a locked block.
+	ml_locked_lineadd(buf, -(n - 1));
+
+	if (lowest_marked > lnum)
+	    lowest_marked = lowest_marked - n > lnum ? lowest_marked - n : lnum;
+
+	// The deleted lines are in one piece of text, the first line at the
+	// end.
+	line_start = ((dp->db_index[idx + n - 1]) & DB_INDEX_MASK);
+	if (idx == 0)
+	    line_end = dp->db_txt_end;
+	else
+	    line_end = ((dp->db_index[idx - 1]) & DB_INDEX_MASK);
+	size = line_end - line_start;
+
+	for (i = 0; i < n; ++i)
+	{
+	    --buf->b_ml.ml_line_count;
+#ifdef FEAT_BYTEOFF
+	    ml_updatechunk(buf, lnum, (long)(line_end
+			 - ((dp->db_index[idx + i]) & DB_INDEX_MASK)),
+							     ML_CHNK_DELLINE);
+	    line_end = ((dp->db_index[idx + i]) & DB_INDEX_MASK);
+#endif
+	}
+
+	if (n == block_count)
+	{
+	    if (ml_free_locked_block(buf) == FAIL)
+		return FAIL;
+	}
+	else
+	{
+	    // delete the text by moving the next lines forwards
+	    text_start = dp->db_txt_start;
+	    mch_memmove((char *)dp + text_start + size,
+		      (char *)dp + text_start, (size_t)(line_start - text_start));
+
+	    // delete the indexes by moving the next indexes backwards, adjust
+	    // them for the text movement
+	    for (i = idx; i < block_count - n; ++i)
+		dp->db_index[i] = dp->db_index[i + n] + size;
+
+	    dp->db_free += size + n * INDEX_SIZE;
+	    dp->db_txt_start += size;
+	    dp->db_line_count -= n;
+
+	    // mark the block dirty and make sure it is in the file (for
+	    // recovery)
+	    buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
+	}
+	count -= n;
+    }
+    return OK;
+}
+
+/*
+ * set the DB_MARKED flag for line 'lnum'
+ */
+    void
+ml_setmarked(linenr_T lnum)
+{
+    bhdr_T    *hp;
+    DATA_BL *dp;
+				    // invalid line number
+    if (lnum < 1 || lnum > curbuf->b_ml.ml_line_count
+					       || curbuf->b_ml.ml_mfp == NULL)
+	return;			    // give error message?
+
+    if (lowest_marked == 0 || lowest_marked > lnum)
+	lowest_marked = lnum;
+
+    /*
+     * find the data block containing the line
+     * This also fills the stack with the blocks from the root to the data block
+     * This also releases any locked block.
+     */
+    if ((hp = ml_find_line(curbuf, lnum, ML_FIND)) == NULL)
+	return;		    // give error message?
+
+    dp = (DATA_BL *)(hp->bh_data);
+    dp->db_index[lnum - curbuf->b_ml.ml_locked_low] |= DB_MARKED;
+    curbuf->b_ml.ml_flags |= ML_LOCKED_DIRTY;
+}
+
+/*
+ * find the first line with its DB_MARKED flag set
+ */
+    linenr_T
+ml_firstmarked(void)
+{
+    bhdr_T	*hp;
+    DATA_BL	*dp;
+    linenr_T	lnum;
+    int		i;
+
+    if (curbuf->b_ml.ml_mfp == NULL)
+	return (linenr_T) 0;
+
+    /*
+     * The search starts with lowest_marked line. This is the last line where
+     * a mark was found, adjusted by inserting/deleting lines.
+     */
+    for (lnum = lowest_marked; lnum <= curbuf->b_ml.ml_line_count; )
+    {
+	/*
+	 * Find the data block containing the line.
+	 * This also fills the stack with the blocks from the root to the data
+	 * block This also releases any locked block.
+	 */
+	if ((hp = ml_find_line(curbuf, lnum, ML_FIND)) == NULL)
+	    return (linenr_T)0;		    // give error message?
 
 	dp = (DATA_BL *)(hp->bh_data);
 
@@ -4093,23 +4515,22 @@ ml_find_line(buf_T *buf, linenr_T lnum, int action)
 	if (ML_SIMPLE(action)
 		&& buf->b_ml.ml_locked_low <= lnum
 		&& buf->b_ml.ml_locked_high >= lnum
-		&& !mf_dont_release)
+		&& !mf_dont_release
+		&& (action == ML_FIND
+			 || !(buf->b_ml.ml_flags & ML_LOCKED_NOSTACK)))
 	{
 	    // remember to update pointer blocks and stack later
 	    if (action == ML_INSERT)
-	    {
-		++(buf->b_ml.ml_locked_lineadd);
-		++(buf->b_ml.ml_locked_high);
-	    }
+		ml_locked_lineadd(buf, 1L);
 	    else if (action == ML_DELETE)
-	    {
-		--(buf->b_ml.ml_locked_lineadd);
-		--(buf->b_ml.ml_locked_high);
-	    }
+		ml_locked_lineadd(buf, -1L);
+	    else
+		++buf->b_ml.ml_cache_hits;
 	    return (buf->b_ml.ml_locked);
 	}
 
-	mf_put(mfp, buf->b_ml.ml_locked, buf->b_ml.ml_flags & ML_LOCKED_DIRTY,
+	hp = buf->b_ml.ml_locked;
+	mf_put(mfp, hp, buf->b_ml.ml_flags & ML_LOCKED_DIRTY,
 					    buf->b_ml.ml_flags & ML_LOCKED_POS);
 	buf->b_ml.ml_locked = NULL;
 
@@ -4119,11 +4540,41 @@ ml_find_line(buf_T *buf, linenr_T lnum, int action)
 	 */
 	if (buf->b_ml.ml_locked_lineadd != 0)
 	    ml_lineadd(buf, buf->b_ml.ml_locked_lineadd);
+
+	// Keep the block around, we may come back to it soon.
+	if (action == ML_FIND && !mf_dont_release)
+	    ml_cache_add(buf, hp, buf->b_ml.ml_locked_low,
+						     buf->b_ml.ml_locked_high);
     }
 
+    /*
+     * When lines are inserted or deleted the line numbers of the cached
+     * blocks become invalid.  ML_FLUSH also releases them, so that the pointer
+     * blocks are updated when they are visited again.
+     */
+    if (action != ML_FIND)
+	ml_cache_clear(buf);
+
     if (action == ML_FLUSH)	    // nothing else to do
 	return NULL;
 
+    if (action == ML_FIND && !mf_dont_release
+	    && (hp = ml_cache_find(buf, lnum, NULL, &low, &high)) != NULL)
+    {
+	// The stack is kept, it may still be useful for finding other lines,
+	// but it can't be used to update the pointer blocks of this block.
+	++buf->b_ml.ml_cache_hits;
+	buf->b_ml.ml_locked = hp;
+	buf->b_ml.ml_locked_low = low;
+	buf->b_ml.ml_locked_high = high;
+	buf->b_ml.ml_locked_lineadd = 0;
+	buf->b_ml.ml_flags &= ~(ML_LOCKED_DIRTY | ML_LOCKED_POS);
+	buf->b_ml.ml_flags |= ML_LOCKED_NOSTACK;
+	return hp;
+    }
+    if (action == ML_FIND)
+	++buf->b_ml.ml_cache_misses;
+
     bnum = 1;			    // start at the root of the tree
     page_count = 1;
     low = 1;
@@ -4168,11 +4619,15 @@ ml_find_line(buf_T *buf, linenr_T lnum, int action)
 	dp = (DATA_BL *)(hp->bh_data);
 	if (dp->db_id == DATA_ID)	// data block
 	{
+	    // Should not be in the cache, but if it is it must not be
+	    // released twice.
+	    (void)ml_cache_find(buf, 0, hp, NULL, NULL);
 	    buf->b_ml.ml_locked = hp;
 	    buf->b_ml.ml_locked_low = low;
 	    buf->b_ml.ml_locked_high = high;
 	    buf->b_ml.ml_locked_lineadd = 0;
-	    buf->b_ml.ml_flags &= ~(ML_LOCKED_DIRTY | ML_LOCKED_POS);
+	    buf->b_ml.ml_flags &= ~(ML_LOCKED_DIRTY | ML_LOCKED_POS
+							 | ML_LOCKED_NOSTACK);
 	    return hp;
 	}
 
@@ -4260,6 +4715,102 @@ error_noblock:
     return NULL;
 }
 
+/*
+ * Add data block "hp" with lines "low" to "high" to the front of the cache of
+ * recently used blocks.  The block has just been released, it is locked again
+ * so that it stays in memory.  When the cache is full the least recently used
+ * block is released.
+ */
+    static void
+ml_cache_add(buf_T *buf, bhdr_T *hp, linenr_T low, linenr_T high)
+{
+    memline_T	*ml = &buf->b_ml;
+    memfile_T	*mfp = ml->ml_mfp;
+
+    if (mf_get(mfp, hp->bh_bnum, hp->bh_page_count) != hp)
+	return;
+    if (ml->ml_cache_count == ML_CACHE_SIZE)
+	mf_put(mfp, ml->ml_cache[--ml->ml_cache_count].mc_hp, FALSE, FALSE);
+    mch_memmove(ml->ml_cache + 1, ml->ml_cache,
+				   (size_t)ml->ml_cache_count * sizeof(mlcache_T));
+    ml->ml_cache[0].mc_hp = hp;
+    ml->ml_cache[0].mc_low = low;
+    ml->ml_cache[0].mc_high = high;
+    ++ml->ml_cache_count;
+}
+
+/*
+ * Find the cached data block that contains line "lnum", or when "hp" is not
+ * NULL the entry for block "hp".  The entry is removed from the cache and the
+ * block is returned, it is still locked.  The line numbers of the block are
+ * stored in "*lowp" and "*highp" when not NULL.
+ * Returns NULL when not found.
+ */
+    static bhdr_T *
+ml_cache_find(
+    buf_T	*buf,
+    linenr_T	lnum,
+    bhdr_T	*hp,
+    linenr_T	*lowp,
+    linenr_T	*highp)
+{
+    memline_T	*ml = &buf->b_ml;
+    mlcache_T	*mc;
+    int		i;
+
+    for (i = 0; i < ml->ml_cache_count; ++i)
+    {
+	mc = &ml->ml_cache[i];
+	if (hp != NULL ? mc->mc_hp == hp
+			       : (mc->mc_low <= lnum && mc->mc_high >= lnum))
+	{
+	    hp = mc->mc_hp;
+	    if (lowp != NULL)
+		*lowp = mc->mc_low;
+	    if (highp != NULL)
+		*highp = mc->mc_high;
+	    --ml->ml_cache_count;
+	    mch_memmove(mc, mc + 1,
+			     (size_t)(ml->ml_cache_count - i) * sizeof(mlcache_T));
+	    return hp;
+	}
+    }
+    return NULL;
+}
+
+/*
+ * Release all the blocks in the cache of recently used data blocks.
+ */
+    static void
+ml_cache_clear(buf_T *buf)
+{
+    while (buf->b_ml.ml_cache_count > 0)
+	mf_put(buf->b_ml.ml_mfp,
+		  buf->b_ml.ml_cache[--buf->b_ml.ml_cache_count].mc_hp,
+								FALSE, FALSE);
+}
+
+/*
+ * Add "count" to the number of lines in the locked block, for lines inserted
+ * (positive) or deleted (negative) in it.  The pointer blocks are updated when
+ * the block is released.  The cached data blocks after it are moved now.
+ * Every change of "ml_locked_high" for lines in the block must be done here.
+ */
+    static void
+ml_locked_lineadd(buf_T *buf, long count)
+{
+    int		i;
+
+    for (i = 0; i < buf->b_ml.ml_cache_count; ++i)
+	if (buf->b_ml.ml_cache[i].mc_low > buf->b_ml.ml_locked_high)
+	{
+	    buf->b_ml.ml_cache[i].mc_low += count;
+	    buf->b_ml.ml_cache[i].mc_high += count;
+	}
+    buf->b_ml.ml_locked_lineadd += count;
+    buf->b_ml.ml_locked_high += count;
+}
+
 /*
  * add an entry to the info pointer stack
  *
@@ -5416,175 +5967,356 @@ ml_crypt_prepare(memfile_T *mfp, off_T offset, int reading)
 #define MLCS_MAXL 800	// max no of lines in chunk
 #define MLCS_MINL 400   // should be half of MLCS_MAXL
 
+// Buffer for which the last chunk that ml_updatechunk() used is remembered.
+static buf_T	*ml_upd_lastbuf = NULL;
+
 /*
- * Keep information for finding byte offset of a line, updtype may be one of:
- * ML_CHNK_ADDLINE: Add len to parent chunk, possibly splitting it
- *	   Careful: ML_CHNK_ADDLINE may cause ml_find_line() to be called.
- * ML_CHNK_DELLINE: Subtract len from parent chunk, possibly deleting it
- * ML_CHNK_UPDLINE: Add len to parent chunk, as a signed entity.
+ * The sizes of the chunks are also kept in a Fenwick tree, so that the chunk
+ * for a line number or byte offset is found in O(log n) time.  Changing the
+ * size of a chunk updates the tree, adding or removing a chunk invalidates it,
+ * it is then rebuilt when needed.
  */
-    static void
-ml_updatechunk(
-    buf_T	*buf,
-    linenr_T	line,
-    long	len,
-    int		updtype)
-{
-    static buf_T	*ml_upd_lastbuf = NULL;
-    static linenr_T	ml_upd_lastline;
-    static linenr_T	ml_upd_lastcurline;
-    static int		ml_upd_lastcurix;
 
-    linenr_T		curline = ml_upd_lastcurline;
-    int			curix = ml_upd_lastcurix;
-    long		size;
-    chunksize_T		*curchnk;
-    int			rest;
-    bhdr_T		*hp;
-    DATA_BL		*dp;
+/*
+ * Build the Fenwick tree for the chunks of "buf".
+ * Returns FAIL when out of memory.
+ */
+    static int
+ml_chunktree_build(buf_T *buf)
+{
+    memline_T	*ml = &buf->b_ml;
+    chunksize_T	*tree;
+    int		n = ml->ml_usedchunks;
+    int		i, j;
 
-    if (buf->b_ml.ml_usedchunks == -1 || len == 0)
-	return;
-    if (buf->b_ml.ml_chunksize == NULL)
+    tree = vim_realloc(ml->ml_chunktree, sizeof(chunksize_T) * (n + 1));
+    if (tree == NULL)
+	return FAIL;
+    ml->ml_chunktree = tree;
+    mch_memmove(tree + 1, ml->ml_chunksize, sizeof(chunksize_T) * n);
+    for (i = 1; i <= n; ++i)
     {
-	buf->b_ml.ml_chunksize = ALLOC_MULT(chunksize_T, 100);
-	if (buf->b_ml.ml_chunksize == NULL)
+	j = i + (i & -i);
+	if (j <= n)
 	{
-	    buf->b_ml.ml_usedchunks = -1;
-	    return;
+	    tree[j].mlcs_numlines += tree[i].mlcs_numlines;
+	    tree[j].mlcs_totalsize += tree[i].mlcs_totalsize;
 	}
-	buf->b_ml.ml_numchunks = 100;
-	buf->b_ml.ml_usedchunks = 1;
-	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
-	buf->b_ml.ml_chunksize[0].mlcs_totalsize = 1;
     }
+    ml->ml_chunktree_len = n;
+    return OK;
+}
 
-    if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1)
+/*
+ * Add "lines" and "size" to chunk "idx" in the Fenwick tree.
+ */
+    static void
+ml_chunktree_add(buf_T *buf, int idx, int lines, long size)
+{
+    memline_T	*ml = &buf->b_ml;
+    int		i;
+
+    if (ml->ml_chunktree_len != ml->ml_usedchunks)
     {
-	/*
-	 * First line in empty buffer from ml_flush_line() -- reset
-	 */
-	buf->b_ml.ml_usedchunks = 1;
-	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
-	buf->b_ml.ml_chunksize[0].mlcs_totalsize = (long)buf->b_ml.ml_line_len;
+	ml->ml_chunktree_len = 0;
 	return;
     }
+    for (i = idx + 1; i <= ml->ml_chunktree_len; i += i & -i)
+    {
+	ml->ml_chunktree[i].mlcs_numlines += lines;
+	ml->ml_chunktree[i].mlcs_totalsize += size;
+    }
+}
 
-    /*
-     * Find chunk that our line belongs to, curline will be at start of the
-     * chunk.
-     */
-    if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
-	    || updtype != ML_CHNK_ADDLINE)
+/*
+ * Find the chunk for line "lnum" or byte offset "offset" in "buf", see
+ * ml_find_line_or_offset().  When "ffdos" is TRUE each line counts one more
+ * byte for the offset.
+ * Returns the index of the chunk, the first line in it in "*curlinep" and
+ * the number of bytes before it in "*sizep".  Returns -1 when out of memory.
+ */
+    static int
+ml_chunktree_find(
+    buf_T	*buf,
+    linenr_T	lnum,
+    long	offset,
+    int		ffdos,
+    linenr_T	*curlinep,
+    long	*sizep)
+{
+    memline_T	*ml = &buf->b_ml;
+    chunksize_T	*tree;
+    int		n;
+    int		step;
+    int		pos = 0;
+    int		pos_off = 0;
+    int		i;
+    long	lines = 0;
+    long	size = 0;
+    long	t;
+
+    if (ml->ml_chunktree_len != ml->ml_usedchunks
+					    && ml_chunktree_build(buf) == FAIL)
+	return -1;
+    tree = ml->ml_chunktree;
+    n = ml->ml_chunktree_len;
+    for (step = 1; step * 2 <= n; step *= 2)
+	;
+
+    // Skip all the chunks that end before "lnum".
+    if (lnum != 0)
     {
-	for (curline = 1, curix = 0;
-	     curix < buf->b_ml.ml_usedchunks - 1
-	     && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	     curix++)
-	    curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
+	t = lnum - 1;
+	for (i = step; i > 0; i /= 2)
+	    if (pos + i <= n && tree[pos + i].mlcs_numlines <= t)
+	    {
+		pos += i;
+		t -= tree[pos].mlcs_numlines;
+	    }
     }
-    else if (curix < buf->b_ml.ml_usedchunks - 1
-	      && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
+    // Skip all the chunks that end before "offset".
+    if (offset != 0)
     {
-	// Adjust cached curix & curline
-	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	curix++;
+	t = offset - 1;
+	for (i = step; i > 0; i /= 2)
+	    if (pos_off + i <= n && tree[pos_off + i].mlcs_totalsize
+			   + ffdos * tree[pos_off + i].mlcs_numlines <= t)
+	    {
+		pos_off += i;
+		t -= tree[pos_off].mlcs_totalsize
+					 + ffdos * tree[pos_off].mlcs_numlines;
+	    }
+	if (pos_off > pos)
+	    pos = pos_off;
     }
-    curchnk = buf->b_ml.ml_chunksize + curix;
+    // The last chunk is always used.
+    if (pos > n - 1)
+	pos = n - 1;
 
-    if (updtype == ML_CHNK_DELLINE)
-	len = -len;
-    curchnk->mlcs_totalsize += len;
-    if (updtype == ML_CHNK_ADDLINE)
+    for (i = pos; i > 0; i -= i & -i)
     {
-	curchnk->mlcs_numlines++;
+	lines += tree[i].mlcs_numlines;
+	size += tree[i].mlcs_totalsize;
+    }
+    *curlinep = lines + 1;
+    *sizep = size;
+    return pos;
+}
 
-	// May resize here so we don't have to do it in both cases below
-	if (buf->b_ml.ml_usedchunks + 1 >= buf->b_ml.ml_numchunks)
-	{
-	    chunksize_T *t_chunksize = buf->b_ml.ml_chunksize;
+/*
+ * Allocate the chunks for "buf", with one chunk for the empty buffer.
+ * Returns FAIL when out of memory, byte offsets are then not available.
+ */
+    static int
+ml_chunk_alloc(buf_T *buf)
+{
+    buf->b_ml.ml_chunksize = ALLOC_MULT(chunksize_T, 100);
+    if (buf->b_ml.ml_chunksize == NULL)
+    {
+	buf->b_ml.ml_usedchunks = -1;
+	return FAIL;
+    }
+    buf->b_ml.ml_numchunks = 100;
+    buf->b_ml.ml_usedchunks = 1;
+    buf->b_ml.ml_chunktree_len = 0;
+    buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
+    buf->b_ml.ml_chunksize[0].mlcs_totalsize = 1;
+    return OK;
+}
 
-	    buf->b_ml.ml_numchunks = buf->b_ml.ml_numchunks * 3 / 2;
-	    buf->b_ml.ml_chunksize = (chunksize_T *)
-		vim_realloc(buf->b_ml.ml_chunksize,
-			    sizeof(chunksize_T) * buf->b_ml.ml_numchunks);
-	    if (buf->b_ml.ml_chunksize == NULL)
-	    {
-		// Hmmmm, Give up on offset for this buffer
-		vim_free(t_chunksize);
-		buf->b_ml.ml_usedchunks = -1;
-		return;
-	    }
-	}
+/*
+ * Make sure there is room for one more chunk in "buf".
+ * Returns FAIL when out of memory, byte offsets are then not available.
+ */
+    static int
+ml_chunk_grow(buf_T *buf)
+{
+    if (buf->b_ml.ml_usedchunks + 1 >= buf->b_ml.ml_numchunks)
+    {
+	chunksize_T *t_chunksize = buf->b_ml.ml_chunksize;
 
-	if (buf->b_ml.ml_chunksize[curix].mlcs_numlines >= MLCS_MAXL)
+	buf->b_ml.ml_numchunks = buf->b_ml.ml_numchunks * 3 / 2;
+	buf->b_ml.ml_chunksize = (chunksize_T *)
+	    vim_realloc(buf->b_ml.ml_chunksize,
+			sizeof(chunksize_T) * buf->b_ml.ml_numchunks);
+	if (buf->b_ml.ml_chunksize == NULL)
 	{
-	    int	    count;	    // number of entries in block
-	    int	    idx;
-	    int	    end_idx;
-	    int	    text_end;
-	    int	    linecnt;
-
-	    mch_memmove(buf->b_ml.ml_chunksize + curix + 1,
-			buf->b_ml.ml_chunksize + curix,
-			(buf->b_ml.ml_usedchunks - curix) *
-			sizeof(chunksize_T));
-	    // Compute length of first half of lines in the split chunk
-	    size = 0;
-	    linecnt = 0;
-	    while (curline < buf->b_ml.ml_line_count
-			&& linecnt < MLCS_MINL)
-	    {
-		if ((hp = ml_find_line(buf, curline, ML_FIND)) == NULL)
-		{
-		    buf->b_ml.ml_usedchunks = -1;
-		    return;
-		}
-		dp = (DATA_BL *)(hp->bh_data);
-		count = (long)(buf->b_ml.ml_locked_high) -
-			(long)(buf->b_ml.ml_locked_low) + 1;
-		idx = curline - buf->b_ml.ml_locked_low;
-		curline = buf->b_ml.ml_locked_high + 1;
-
-		// compute index of last line to use in this MEMLINE
-		rest = count - idx;
-		if (linecnt + rest > MLCS_MINL)
-		{
-		    end_idx = idx + MLCS_MINL - linecnt - 1;
-		    linecnt = MLCS_MINL;
-		}
-		else
-		{
-		    end_idx = count - 1;
-		    linecnt += rest;
-		}
+	    // Hmmmm, Give up on offset for this buffer
+	    vim_free(t_chunksize);
+	    buf->b_ml.ml_usedchunks = -1;
+	    return FAIL;
+	}
+    }
+    return OK;
+}
+
+/*
+ * Split chunk "curix" of "buf", which starts at line "curline", into one with
+ * the first MLCS_MINL lines and one with the rest.  There must be room for
+ * the extra chunk, see ml_chunk_grow().
+ * Returns FAIL when a line cannot be found, byte offsets are then not
+ * available.
+ */
+    static int
+ml_chunk_split(buf_T *buf, int curix, linenr_T curline)
+{
+    long	size;
+    int		rest;
+    bhdr_T	*hp;
+    DATA_BL	*dp;
+    int		count;	    // number of entries in block
+    int		idx;
+    int		end_idx;
+    int		text_end;
+    int		linecnt;
+
+    mch_memmove(buf->b_ml.ml_chunksize + curix + 1,
+		buf->b_ml.ml_chunksize + curix,
+		(buf->b_ml.ml_usedchunks - curix) *
+		sizeof(chunksize_T));
+    // Compute length of first half of lines in the split chunk
+    size = 0;
+    linecnt = 0;
+    while (curline < buf->b_ml.ml_line_count
+		&& linecnt < MLCS_MINL)
+    {
+	if ((hp = ml_find_line(buf, curline, ML_FIND)) == NULL)
+	{
+	    buf->b_ml.ml_usedchunks = -1;
+	    return FAIL;
+	}
+	dp = (DATA_BL *)(hp->bh_data);
+	count = (long)(buf->b_ml.ml_locked_high) -
+		(long)(buf->b_ml.ml_locked_low) + 1;
+	idx = curline - buf->b_ml.ml_locked_low;
+	curline = buf->b_ml.ml_locked_high + 1;
+
+	// compute index of last line to use in this MEMLINE
+	rest = count - idx;
+	if (linecnt + rest > MLCS_MINL)
+	{
+	    end_idx = idx + MLCS_MINL - linecnt - 1;
+	    linecnt = MLCS_MINL;
+	}
+	else
+	{
+	    end_idx = count - 1;
+	    linecnt += rest;
+	}
 #ifdef FEAT_PROP_POPUP
-		if (buf->b_has_textprop)
-		{
-		    int i;
+	if (buf->b_has_textprop)
+	{
+	    int i;
 
-		    // We cannot use the text pointers to get the text length,
-		    // the text prop info would also be counted.  Go over the
-		    // lines.
-		    for (i = end_idx; i < idx; ++i)
-			size += (int)STRLEN((char_u *)dp + (dp->db_index[i] & DB_INDEX_MASK)) + 1;
-		}
-		else
+	    // We cannot use the text pointers to get the text length,
+	    // the text prop info would also be counted.  Go over the
+	    // lines.
+	    for (i = end_idx; i < idx; ++i)
+		size += (int)STRLEN((char_u *)dp + (dp->db_index[i] & DB_INDEX_MASK)) + 1;
+	}
+	else
 #endif
-		{
-		    if (idx == 0)// first line in block, text at the end
-			text_end = dp->db_txt_end;
-		    else
-			text_end = ((dp->db_index[idx - 1]) & DB_INDEX_MASK);
-		    size += text_end - ((dp->db_index[end_idx]) & DB_INDEX_MASK);
-		}
-	    }
-	    buf->b_ml.ml_chunksize[curix].mlcs_numlines = linecnt;
-	    buf->b_ml.ml_chunksize[curix + 1].mlcs_numlines -= linecnt;
-	    buf->b_ml.ml_chunksize[curix].mlcs_totalsize = size;
-	    buf->b_ml.ml_chunksize[curix + 1].mlcs_totalsize -= size;
-	    buf->b_ml.ml_usedchunks++;
-	    ml_upd_lastbuf = NULL;   // Force recalc of curix & curline
+	{
+	    if (idx == 0)// first line in block, text at the end
+		text_end = dp->db_txt_end;
+	    else
+		text_end = ((dp->db_index[idx - 1]) & DB_INDEX_MASK);
+	    size += text_end - ((dp->db_index[end_idx]) & DB_INDEX_MASK);
+	}
+    }
+    buf->b_ml.ml_chunksize[curix].mlcs_numlines = linecnt;
+    buf->b_ml.ml_chunksize[curix + 1].mlcs_numlines -= linecnt;
+    buf->b_ml.ml_chunksize[curix].mlcs_totalsize = size;
+    buf->b_ml.ml_chunksize[curix + 1].mlcs_totalsize -= size;
+    buf->b_ml.ml_usedchunks++;
+    buf->b_ml.ml_chunktree_len = 0;
+    ml_upd_lastbuf = NULL;   // Force recalc of curix & curline
+    return OK;
+}
+
+/*
+ * Keep information for finding byte offset of a line, updtype may be one of:
+ * ML_CHNK_ADDLINE: Add len to parent chunk, possibly splitting it
+ *	   Careful: ML_CHNK_ADDLINE may cause ml_find_line() to be called.
+ * ML_CHNK_DELLINE: Subtract len from parent chunk, possibly deleting it
+ * ML_CHNK_UPDLINE: Add len to parent chunk, as a signed entity.
+ */
+    static void
+ml_updatechunk(
+    buf_T	*buf,
+    linenr_T	line,
+    long	len,
+    int		updtype)
+{
+    static linenr_T	ml_upd_lastline;
+    static linenr_T	ml_upd_lastcurline;
+    static int		ml_upd_lastcurix;
+
+    linenr_T		curline = ml_upd_lastcurline;
+    int			curix = ml_upd_lastcurix;
+    long		size;
+    chunksize_T		*curchnk;
+    int			rest;
+    bhdr_T		*hp;
+    DATA_BL		*dp;
+
+    if (buf->b_ml.ml_usedchunks == -1 || len == 0)
+	return;
+    if (buf->b_ml.ml_chunksize == NULL && ml_chunk_alloc(buf) == FAIL)
+	return;
+
+    if (updtype == ML_CHNK_UPDLINE && buf->b_ml.ml_line_count == 1)
+    {
+	/*
+	 * First line in empty buffer from ml_flush_line() -- reset
+	 */
+	buf->b_ml.ml_usedchunks = 1;
+	buf->b_ml.ml_chunktree_len = 0;
+	buf->b_ml.ml_chunksize[0].mlcs_numlines = 1;
+	buf->b_ml.ml_chunksize[0].mlcs_totalsize = (long)buf->b_ml.ml_line_len;
+	return;
+    }
+
+    /*
+     * Find chunk that our line belongs to, curline will be at start of the
+     * chunk.
+     */
+    if (buf != ml_upd_lastbuf || line != ml_upd_lastline + 1
+	    || updtype != ML_CHNK_ADDLINE)
+    {
+	curix = ml_chunktree_find(buf, line, 0L, FALSE, &curline, &size);
+	if (curix < 0)
+	{
+	    buf->b_ml.ml_usedchunks = -1;
+	    return;
+	}
+    }
+    else if (curix < buf->b_ml.ml_usedchunks - 1
+	      && line >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
+    {
+	// Adjust cached curix & curline
+	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
+	curix++;
+    }
+    curchnk = buf->b_ml.ml_chunksize + curix;
+
+    if (updtype == ML_CHNK_DELLINE)
+	len = -len;
+    curchnk->mlcs_totalsize += len;
+    ml_chunktree_add(buf, curix,
+	    updtype == ML_CHNK_ADDLINE ? 1 : updtype == ML_CHNK_DELLINE ? -1 : 0,
+									 len);
+    if (updtype == ML_CHNK_ADDLINE)
+    {
+	curchnk->mlcs_numlines++;
+
+	// May resize here so we don't have to do it in both cases below
+	if (ml_chunk_grow(buf) == FAIL)
+	    return;
+
+	if (buf->b_ml.ml_chunksize[curix].mlcs_numlines >= MLCS_MAXL)
+	{
+	    ml_chunk_split(buf, curix, curline);
 	    return;
 	}
 	else if (buf->b_ml.ml_chunksize[curix].mlcs_numlines >= MLCS_MINL
@@ -5597,6 +6329,7 @@ ml_updatechunk(
 	     */
 	    curchnk = buf->b_ml.ml_chunksize + curix + 1;
 	    buf->b_ml.ml_usedchunks++;
+	    buf->b_ml.ml_chunktree_len = 0;
 	    if (line == buf->b_ml.ml_line_count)
 	    {
 		curchnk->mlcs_numlines = 0;
@@ -5642,6 +6375,7 @@ ml_updatechunk(
 	else if (curix == 0 && curchnk->mlcs_numlines <= 0)
 	{
 	    buf->b_ml.ml_usedchunks--;
+	    buf->b_ml.ml_chunktree_len = 0;
 	    mch_memmove(buf->b_ml.ml_chunksize, buf->b_ml.ml_chunksize + 1,
 			buf->b_ml.ml_usedchunks * sizeof(chunksize_T));
 	    return;
@@ -5657,6 +6391,7 @@ ml_updatechunk(
 	curchnk[-1].mlcs_numlines += curchnk->mlcs_numlines;
 	curchnk[-1].mlcs_totalsize += curchnk->mlcs_totalsize;
 	buf->b_ml.ml_usedchunks--;
+	buf->b_ml.ml_chunktree_len = 0;
 	if (curix < buf->b_ml.ml_usedchunks)
 	{
 	    mch_memmove(buf->b_ml.ml_chunksize + curix,
@@ -5672,6 +6407,54 @@ ml_updatechunk(
     ml_upd_lastcurix = curix;
 }
 
+/*
+ * Add "count" lines starting at "line" with a total length of "len" to the
+ * chunks of "buf", when all of them are already in the buffer.
+ */
+    static void
+ml_updatechunk_many(
+    buf_T	*buf,
+    linenr_T	line,
+    long	count,
+    long	len)
+{
+    linenr_T	curline;
+    long	size;
+    int		curix;
+
+    if (count == 1)
+    {
+	ml_updatechunk(buf, line, len, ML_CHNK_ADDLINE);
+	return;
+    }
+    if (buf->b_ml.ml_usedchunks == -1 || count == 0)
+	return;
+    if (buf->b_ml.ml_chunksize == NULL && ml_chunk_alloc(buf) == FAIL)
+	return;
+
+    curix = ml_chunktree_find(buf, line, 0L, FALSE, &curline, &size);
+    if (curix < 0)
+    {
+	buf->b_ml.ml_usedchunks = -1;
+	return;
+    }
+    ml_upd_lastbuf = NULL;   // Force recalc of curix & curline
+    buf->b_ml.ml_chunksize[curix].mlcs_numlines += count;
+    buf->b_ml.ml_chunksize[curix].mlcs_totalsize += len;
+    ml_chunktree_add(buf, curix, (int)count, len);
+
+    // The lines are all in the buffer now, split the chunk as often as
+    // needed.
+    while (buf->b_ml.ml_chunksize[curix].mlcs_numlines >= MLCS_MAXL)
+    {
+	if (ml_chunk_grow(buf) == FAIL
+				|| ml_chunk_split(buf, curix, curline) == FAIL)
+	    return;
+	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
+	++curix;
+    }
+}
+
 /*
  * Find offset for line or line with offset.
  * Find line with offset if "lnum" is 0; return remaining offset in offp
@@ -5682,7 +6465,6 @@ ml_updatechunk(
 ml_find_line_or_offset(buf_T *buf, linenr_T lnum, long *offp)
 {
     linenr_T	curline;
-    int		curix;
     long	size;
     bhdr_T	*hp;
     DATA_BL	*dp;
@@ -5710,24 +6492,13 @@ ml_find_line_or_offset(buf_T *buf, linenr_T lnum, long *offp)
     if (lnum == 0 && offset <= 0)
 	return 1;   // Not a "find offset" and offset 0 _must_ be in line 1
     /*
-     * Find the last chunk before the one containing our line. Last chunk is
-     * special because it will never qualify
+     * Find the chunk containing our line. Last chunk is special because it
+     * will never qualify
      */
-    curline = 1;
-    curix = size = 0;
-    while (curix < buf->b_ml.ml_usedchunks - 1
-	    && ((lnum != 0
-	     && lnum >= curline + buf->b_ml.ml_chunksize[curix].mlcs_numlines)
-		|| (offset != 0
-	       && offset > size + buf->b_ml.ml_chunksize[curix].mlcs_totalsize
-		      + ffdos * buf->b_ml.ml_chunksize[curix].mlcs_numlines)))
-    {
-	curline += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	size += buf->b_ml.ml_chunksize[curix].mlcs_totalsize;
-	if (offset && ffdos)
-	    size += buf->b_ml.ml_chunksize[curix].mlcs_numlines;
-	curix++;
-    }
+    if (ml_chunktree_find(buf, lnum, offset, ffdos, &curline, &size) < 0)
+	return -1;
+    if (offset && ffdos)
+	size += curline - 1;
 
     while ((lnum != 0 && curline < lnum) || (offset != 0 && size < offset))
     {
@@ -5849,3 +6620,494 @@ goto_byte(long cnt)
 	mb_adjust_cursor();
 }
 #endif
+
+/*
+ * Loading a file lazily: readfile() only scans the file for line breaks and
+ * ml_lazy_read() builds the tree of pointer blocks with data blocks that have
+ * negative block numbers, like when reading the file with ml_append().  The
+ * data blocks are not created, mf_get() calls ml_lazy_block() to read the
+ * lines from the original file when a block is needed.  A block that wasn't
+ * changed can be released at any time, it is read again when needed.  When a
+ * block is changed it gets a positive number and is a normal block.
+ * This uses read() instead of mmap(), a file that is truncated by another
+ * program then results in missing lines instead of a crash.
+ */
+
+// Number of pages for a data block of a file that is loaded lazily.  A line
+// that does not fit gets a block of its own.
+#define ML_LAZY_PAGES	4
+
+// Maximum number of Kbyte of blocks in memory for a lazily loaded file.
+#define ML_LAZY_MAXMEM	16384
+
+// Number of bytes read at a time when scanning the file.
+#define ML_LAZY_READSIZE 0x100000L
+
+// State used by ml_lazy_read() while scanning the file.
+typedef struct
+{
+    garray_T	    ls_blocks;	    // mf_lazyblock_T entries
+    mf_lazyblock_T  ls_cur;	    // block being filled
+    long	    ls_used;	    // bytes used in ls_cur
+    long	    ls_max_used;    // max bytes in a block of ML_LAZY_PAGES
+    unsigned	    ls_page_size;
+#ifdef FEAT_BYTEOFF
+    garray_T	    ls_chunks;	    // chunksize_T entries
+    chunksize_T	    ls_chunk;	    // chunk being filled
+#endif
+} lazyscan_T;
+
+/*
+ * Finish the block being filled in "ls".
+ */
+    static int
+ml_lazy_end_block(lazyscan_T *ls)
+{
+    if (ga_grow(&ls->ls_blocks, 1) == FAIL)
+	return FAIL;
+    ls->ls_cur.lb_page_count = (int)((HEADER_SIZE + ls->ls_used
+			     + ls->ls_page_size - 1) / ls->ls_page_size);
+    ((mf_lazyblock_T *)ls->ls_blocks.ga_data)[ls->ls_blocks.ga_len++]
+								 = ls->ls_cur;
+    ls->ls_cur.lb_size = 0;
+    ls->ls_cur.lb_line_count = 0;
+    ls->ls_used = 0;
+    return OK;
+}
+
+/*
+ * Add a line that starts at "lineoff" in the file, with "len" bytes of text
+ * and "nl_len" bytes for the line break, to "ls".
+ */
+    static int
+ml_lazy_add_line(lazyscan_T *ls, off_T lineoff, long len, int nl_len)
+{
+    long	need = len + 1 + INDEX_SIZE;
+
+    if (ls->ls_cur.lb_line_count > 0
+				 && ls->ls_used + need > ls->ls_max_used
+				 && ml_lazy_end_block(ls) == FAIL)
+	return FAIL;
+    if (ls->ls_cur.lb_line_count == 0)
+	ls->ls_cur.lb_offset = lineoff;
+    ++ls->ls_cur.lb_line_count;
+    ls->ls_cur.lb_size += len + nl_len;
+    ls->ls_used += need;
+
+#ifdef FEAT_BYTEOFF
+    ++ls->ls_chunk.mlcs_numlines;
+    ls->ls_chunk.mlcs_totalsize += len + 1;
+    if (ls->ls_chunk.mlcs_numlines >= MLCS_MINL)
+    {
+	if (ga_grow(&ls->ls_chunks, 1) == FAIL)
+	    return FAIL;
+	((chunksize_T *)ls->ls_chunks.ga_data)[ls->ls_chunks.ga_len++]
+								= ls->ls_chunk;
+	ls->ls_chunk.mlcs_numlines = 0;
+	ls->ls_chunk.mlcs_totalsize = 0;
+    }
+#endif
+    return OK;
+}
+
+/*
+ * Called by readfile() when reading file "fname" into the empty buffer "buf".
+ * Scan the file from byte "offset" for line breaks and set up the memline in
+ * such a way that the text of the lines is only read when it is needed.  See
+ * 'lazyload'.  The file must use Unix line breaks and must not need
+ * conversion.  When 'encoding' is "utf-8" the text must be valid UTF-8.
+ * The empty line of the buffer is kept as the last line.
+ * On success "*lines" is set to the number of lines read, "*size" to the
+ * number of bytes and "*no_eol" to TRUE when the last line has no line break.
+ * Returns FAIL when the file cannot be loaded lazily, the buffer is then
+ * unchanged.
+ */
+    int
+ml_lazy_read(
+    buf_T	*buf,
+    char_u	*fname,
+    off_T	offset,
+    linenr_T	*lines,
+    off_T	*size,
+    int		*no_eol)
+{
+    memfile_T	    *mfp = buf->b_ml.ml_mfp;
+    mf_lazy_T	    *lz = NULL;
+    mf_lazyblock_T  *lb;
+    lazyscan_T	    ls;
+    PTR_EN	    *pe = NULL;
+    PTR_EN	    last;
+    PTR_BL	    *pp;
+    bhdr_T	    *hp;
+    char_u	    *buffer = NULL;
+    char_u	    *p;
+    char_u	    *end;
+    int		    fd;
+    int		    validate = enc_utf8 && !buf->b_p_bin;
+    off_T	    pos = offset;	// file offset of "buffer"
+    off_T	    lineoff = offset;	// file offset of current line
+    long	    linelen = 0;	// length of current line
+    linenr_T	    lnum = 0;
+    long	    carry = 0;
+    long	    n;
+    long	    count;
+    long	    pb_count_max;
+    long	    i, k;
+    int		    l;
+    blocknr_T	    first;
+    int		    retval = FAIL;
+
+    if (mfp == NULL || mfp->mf_lazy != NULL || buf->b_ml.ml_line_count != 1)
+	return FAIL;
+
+    fd = mch_open((char *)fname, O_RDONLY | O_EXTRA, 0);
+    if (fd < 0)
+	return FAIL;
+#ifdef HAVE_FD_CLOEXEC
+    {
+	int fdflags = fcntl(fd, F_GETFD);
+	if (fdflags >= 0 && (fdflags & FD_CLOEXEC) == 0)
+	    (void)fcntl(fd, F_SETFD, fdflags | FD_CLOEXEC);
+    }
+#endif
+
+    vim_memset(&ls, 0, sizeof(ls));
+    ga_init2(&ls.ls_blocks, sizeof(mf_lazyblock_T), 1000);
+    ls.ls_page_size = mfp->mf_page_size;
+    ls.ls_max_used = ML_LAZY_PAGES * mfp->mf_page_size - HEADER_SIZE;
+#ifdef FEAT_BYTEOFF
+    ga_init2(&ls.ls_chunks, sizeof(chunksize_T), 1000);
+#endif
+    *no_eol = FALSE;
+
+    buffer = alloc(ML_LAZY_READSIZE + MB_MAXBYTES);
+    if (buffer == NULL || vim_lseek(fd, offset, SEEK_SET) != offset)
+	goto theend;
+
+    /*
+     * Find the line breaks, check the text is valid.
+     */
+    for (;;)
+    {
+	n = read_eintr(fd, buffer + carry, ML_LAZY_READSIZE);
+	if (n < 0)
+	    goto theend;
+	if (n == 0)
+	{
+	    // an incomplete character at the end is not valid
+	    if (carry > 0)
+		goto theend;
+	    break;
+	}
+	end = buffer + carry + n;
+	for (p = buffer; p < end; ++p)
+	{
+	    if (*p == NL)
+	    {
+		if (ml_lazy_add_line(&ls, lineoff, linelen, 1) == FAIL)
+		    goto theend;
+		++lnum;
+		linelen = 0;
+		lineoff = pos + (p - buffer) + 1;
+		continue;
+	    }
+	    if (*p >= 0x80 && validate)
+	    {
+		l = utf_ptr2len_len(p, (int)(end - p));
+		if (l > end - p)
+		    break;	// incomplete character, read more
+		if (l == 1)
+		    goto theend;    // illegal byte
+		p += l - 1;
+		linelen += l - 1;
+	    }
+	    // very long lines are split by readfile()
+	    if (++linelen >= MAXCOL / 2)
+		goto theend;
+	}
+	carry = (long)(end - p);
+	pos += p - buffer;
+	if (carry > 0)
+	    mch_memmove(buffer, p, (size_t)carry);
+
+	ui_breakcheck();
+	if (got_int)
+	    goto theend;
+    }
+
+    if (linelen > 0)
+    {
+	// last line without a line break
+	if (ml_lazy_add_line(&ls, lineoff, linelen, 0) == FAIL)
+	    goto theend;
+	++lnum;
+	*no_eol = TRUE;
+    }
+    if (ls.ls_cur.lb_line_count > 0 && ml_lazy_end_block(&ls) == FAIL)
+	goto theend;
+    if (lnum == 0)
+	goto theend;
+
+#ifdef FEAT_BYTEOFF
+    // The empty line of the buffer is in the last chunk.
+    ++ls.ls_chunk.mlcs_numlines;
+    ++ls.ls_chunk.mlcs_totalsize;
+    if (ga_grow(&ls.ls_chunks, 1) == FAIL)
+	goto theend;
+    ((chunksize_T *)ls.ls_chunks.ga_data)[ls.ls_chunks.ga_len++]
+								 = ls.ls_chunk;
+#endif
+
+    /*
+     * The root block has one entry, for the data block with the empty line.
+     * Put the entries for the lazily loaded blocks in front of it.
+     */
+    ml_flush_line(buf);
+    (void)ml_find_line(buf, (linenr_T)0, ML_FLUSH);
+    if ((hp = mf_get(mfp, (blocknr_T)1, 1)) == NULL)
+	goto theend;
+    pp = (PTR_BL *)(hp->bh_data);
+    last = pp->pb_pointer[0];
+    pb_count_max = pp->pb_count_max;
+    n = (pp->pb_id == PTR_ID && pp->pb_count == 1
+					       && last.pe_line_count == 1);
+    mf_put(mfp, hp, FALSE, FALSE);
+    if (!n)
+	goto theend;
+
+    count = ls.ls_blocks.ga_len + 1;
+    pe = ALLOC_MULT(PTR_EN, count);
+    lz = ALLOC_ONE(mf_lazy_T);
+    if (pe == NULL || lz == NULL)
+	goto theend;
+    first = mfp->mf_blocknr_min;
+    lb = (mf_lazyblock_T *)ls.ls_blocks.ga_data;
+    last.pe_old_lnum = 1;
+    for (i = 0; i < ls.ls_blocks.ga_len; ++i)
+    {
+	pe[i].pe_bnum = first - i;
+	pe[i].pe_line_count = lb[i].lb_line_count;
+	pe[i].pe_old_lnum = last.pe_old_lnum;
+	pe[i].pe_page_count = lb[i].lb_page_count;
+	last.pe_old_lnum += lb[i].lb_line_count;
+    }
+    pe[i] = last;
+
+    /*
+     * Build the tree from the bottom up, until the entries fit in the root.
+     */
+    while (count > pb_count_max)
+    {
+	long	newcount = 0;
+
+	for (i = 0; i < count; i += pb_count_max)
+	{
+	    PTR_EN	en;
+
+	    if ((hp = ml_new_ptr(mfp)) == NULL)
+		goto theend;
+	    pp = (PTR_BL *)(hp->bh_data);
+	    pp->pb_count = (short_u)(count - i < pb_count_max
+						 ? count - i : pb_count_max);
+	    mch_memmove(pp->pb_pointer, pe + i,
+					   pp->pb_count * sizeof(PTR_EN));
+	    en.pe_bnum = hp->bh_bnum;
+	    en.pe_line_count = 0;
+	    for (k = 0; k < pp->pb_count; ++k)
+		en.pe_line_count += pp->pb_pointer[k].pe_line_count;
+	    en.pe_old_lnum = pp->pb_pointer[0].pe_old_lnum;
+	    en.pe_page_count = 1;
+	    pe[newcount++] = en;
+	    mf_put(mfp, hp, TRUE, FALSE);
+	}
+	count = newcount;
+    }
+
+    if ((hp = mf_get(mfp, (blocknr_T)1, 1)) == NULL)
+	goto theend;
+    pp = (PTR_BL *)(hp->bh_data);
+    mch_memmove(pp->pb_pointer, pe, count * sizeof(PTR_EN));
+    pp->pb_count = (short_u)count;
+    mf_put(mfp, hp, TRUE, FALSE);
+
+    // The blocks get numbers as if created with ml_new_data().
+    lz->lz_fd = fd;
+    lz->lz_first = first;
+    lz->lz_count = ls.ls_blocks.ga_len;
+    lz->lz_blocks = lb;
+    lz->lz_error = FALSE;
+    ls.ls_blocks.ga_data = NULL;
+    mfp->mf_lazy = lz;
+    mfp->mf_blocknr_min -= lz->lz_count;
+    mfp->mf_neg_count += lz->lz_count;
+
+    // Keep only a limited number of blocks in memory.
+    n = (ML_LAZY_MAXMEM * 1024L) / mfp->mf_page_size;
+    if (mfp->mf_used_count_max > (unsigned)n)
+	mfp->mf_used_count_max = n;
+
+    buf->b_ml.ml_line_count = lnum + 1;
+    buf->b_ml.ml_flags &= ~ML_EMPTY;
+    buf->b_ml.ml_stack_top = 0;
+#ifdef FEAT_BYTEOFF
+    vim_free(buf->b_ml.ml_chunksize);
+    buf->b_ml.ml_chunksize = (chunksize_T *)ls.ls_chunks.ga_data;
+    buf->b_ml.ml_numchunks = ls.ls_chunks.ga_maxlen;
+    buf->b_ml.ml_usedchunks = ls.ls_chunks.ga_len;
+    buf->b_ml.ml_chunktree_len = 0;
+    ls.ls_chunks.ga_data = NULL;
+    ml_upd_lastbuf = NULL;
+#endif
+
+    *lines = lnum;
+    *size = pos - offset;
+    lz = NULL;
+    retval = OK;
+
+theend:
+    if (retval == FAIL)
+	close(fd);
+    vim_free(lz);
+    vim_free(pe);
+    vim_free(buffer);
+    ga_clear(&ls.ls_blocks);
+#ifdef FEAT_BYTEOFF
+    ga_clear(&ls.ls_chunks);
+#endif
+    return retval;
+}
+
+/*
+ * Called by mf_get() for a block "hp" with a negative number that is not in
+ * memory.  Read the lines of the block from the lazily loaded file.
+ * Returns FAIL if "hp" is not a block of the lazily loaded file.
+ */
+    int
+ml_lazy_block(memfile_T *mfp, bhdr_T *hp)
+{
+    mf_lazy_T	    *lz = mfp->mf_lazy;
+    mf_lazyblock_T  *lb;
+    DATA_BL	    *dp = (DATA_BL *)(hp->bh_data);
+    char_u	    *text;
+    char_u	    *s;
+    char_u	    *e;
+    char_u	    *d;
+    long	    idx;
+    long	    n = 0;
+    long	    len;
+    long	    room;
+    unsigned	    off;
+    linenr_T	    i;
+
+    if (lz == NULL)
+	return FAIL;
+    idx = lz->lz_first - hp->bh_bnum;
+    if (idx < 0 || idx >= lz->lz_count)
+	return FAIL;
+    lb = &lz->lz_blocks[idx];
+    if (hp->bh_page_count != lb->lb_page_count)
+	return FAIL;
+
+    if ((text = alloc(lb->lb_size + 1)) == NULL)
+	return FAIL;
+    if (vim_lseek(lz->lz_fd, lb->lb_offset, SEEK_SET) == lb->lb_offset)
+	n = read_eintr(lz->lz_fd, text, (size_t)lb->lb_size);
+    if (n < lb->lb_size)
+    {
+	// The file was truncated or can't be read, lines will be missing.
+	if (!lz->lz_error)
+	    emsg(_("E998: Cannot read lines from lazily loaded file"));
+	lz->lz_error = TRUE;
+	if (n < 0)
+	    n = 0;
+    }
+
+    // Store the lines like ml_append_int() does: the first line at the end.
+    dp->db_id = DATA_ID;
+    dp->db_txt_end = hp->bh_page_count * mfp->mf_page_size;
+    dp->db_line_count = lb->lb_line_count;
+    off = dp->db_txt_end;
+    s = text;
+    e = text + n;
+    for (i = 0; i < lb->lb_line_count; ++i)
+    {
+	if (s < e)
+	{
+	    d = (char_u *)memchr(s, NL, (size_t)(e - s));
+	    len = (long)((d == NULL ? e : d) - s);
+	}
+	else
+	    len = 0;
+
+	// When the file was changed a line may not fit, truncate it.
+	room = (long)off - (long)(HEADER_SIZE + lb->lb_line_count * INDEX_SIZE)
+					       - (lb->lb_line_count - i - 1);
+	if (len + 1 > room)
+	    len = room - 1;
+
+	off -= len + 1;
+	d = (char_u *)dp + off;
+	for (idx = 0; idx < len; ++idx)
+	    // NULs are replaced by newlines!
+	    d[idx] = s[idx] == NUL ? NL : s[idx];
+	d[len] = NUL;
+	dp->db_index[i] = off;
+	s += len + 1;
+    }
+    dp->db_txt_start = off;
+    dp->db_free = off - (HEADER_SIZE + lb->lb_line_count * INDEX_SIZE);
+    vim_memset((char_u *)dp + off - dp->db_free, 0, dp->db_free);
+
+    vim_free(text);
+    return OK;
+}
+
+/*
+ * Read all the lines of lazily loaded buffer "buf" into the memfile, so that
+ * the original file is no longer used.  Needed before the file is
+ * overwritten and to have all lines in the swap file.
+ * Returns FAIL when interrupted.
+ */
+    int
+ml_lazy_load_all(buf_T *buf)
+{
+    memfile_T	*mfp = buf->b_ml.ml_mfp;
+    bhdr_T	*hp;
+    linenr_T	lnum;
+
+    if (mfp == NULL || mfp->mf_lazy == NULL)
+	return OK;
+
+    ml_flush_line(buf);
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count;
+					  lnum = buf->b_ml.ml_locked_high + 1)
+    {
+	if ((hp = ml_find_line(buf, lnum, ML_FIND)) == NULL)
+	    return FAIL;
+	// Make the block a normal one, it gets a positive number when
+	// released.
+	if (hp->bh_bnum < 0)
+	    buf->b_ml.ml_flags |= (ML_LOCKED_DIRTY | ML_LOCKED_POS);
+
+	ui_breakcheck();
+	if (got_int)
+	    return FAIL;
+    }
+    (void)ml_find_line(buf, (linenr_T)0, ML_FLUSH);
+
+    ml_lazy_free(mfp);
+    return OK;
+}
+
+/*
+ * Stop using the lazily loaded file for "mfp".
+ */
+    void
+ml_lazy_free(memfile_T *mfp)
+{
+    if (mfp->mf_lazy == NULL)
+	return;
+    close(mfp->mf_lazy->lz_fd);
+    vim_free(mfp->mf_lazy->lz_blocks);
+    VIM_CLEAR(mfp->mf_lazy);
+}
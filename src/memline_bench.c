@@ -0,0 +1,211 @@
+/* vi:set ts=8 sts=4 sw=4 noet:
+ *
+ * VIM - Vi IMproved	by Bram Moolenaar
+ *
+ * Do ":help uganda"  in Vim to read copying and usage conditions.
+ * Do ":help credits" in Vim to see a list of people who contributed.
+ * See README.txt for an overview of the Vim source code.
+ */
+
+/*
+ * memline_bench.c: Benchmarks for memline.c and memfile.c
+ *
+ * Runs the same workloads on buffers of a given number of lines and reports
+ * the time per operation and the peak resident set size.  Run with
+ * "make bench_memline", optionally with BENCH_MEMLINE_LINES set to the list
+ * of buffer sizes to use.
+ */
+
+// Must include main.c because it contains much more than just main()
+#define NO_VIM_MAIN
+#include "main.c"
+
+#ifdef HAVE_SYS_RESOURCE_H
+# include <sys/resource.h>
+#endif
+
+#if defined(FEAT_RELTIME) && defined(FEAT_FLOAT)
+
+// Number of operations for the workloads that do not touch every line.
+#define BENCH_OPS	200000L
+
+static long_u	    bench_seed;
+static proftime_T   bench_tm;
+
+/*
+ * Return a line number between 1 and "max".  A simple linear congruential
+ * generator is used, so that every run does the same work.
+ */
+    static linenr_T
+bench_rand_lnum(linenr_T max)
+{
+    bench_seed = bench_seed * 1103515245UL + 12345UL;
+    return (linenr_T)((bench_seed >> 8) % (long_u)max) + 1;
+}
+
+/*
+ * Return the text for line "n" in a static buffer.  The lines have a length
+ * between 10 and 50 bytes.
+ */
+    static char_u *
+bench_line(long n)
+{
+    static char_u   buf[100];
+
+    vim_snprintf((char *)buf, sizeof(buf), "line %ld: %.*s", n, (int)(n % 41),
+				  "the quick brown fox jumps over the lazy dog");
+    return buf;
+}
+
+    static void
+bench_start(void)
+{
+    profile_start(&bench_tm);
+}
+
+/*
+ * Report the time since bench_start() for "count" operations of "name".
+ */
+    static void
+bench_report(char *name, long count)
+{
+    float_T secs;
+
+    profile_end(&bench_tm);
+    secs = profile_float(&bench_tm);
+    printf("  %-20s %10ld ops %10.1f ns/op %9.3f s\n", name, count,
+					      secs * 1e9 / count, (double)secs);
+}
+
+/*
+ * Report the peak resident set size of the process so far.
+ */
+    static void
+bench_report_rss(void)
+{
+#ifdef HAVE_SYS_RESOURCE_H
+    struct rusage   ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+# ifdef MACOS_X
+	printf("  peak RSS: %ld Kbyte\n", (long)ru.ru_maxrss / 1024);
+# else
+	printf("  peak RSS: %ld Kbyte\n", (long)ru.ru_maxrss);
+# endif
+#endif
+}
+
+/*
+ * Run all workloads on a new buffer of "lines" lines.
+ */
+    static void
+bench_memline(linenr_T lines)
+{
+    buf_T	*buf;
+    linenr_T	lnum;
+    long	i;
+    long	n;
+    long_u	total = 0;
+    char_u	*batch[1000];
+
+    printf("%ld lines:\n", (long)lines);
+    buf = buflist_new(NULL, NULL, (linenr_T)1, BLN_LISTED);
+    if (buf == NULL || ml_open(buf) == FAIL)
+    {
+	printf("  cannot create a buffer\n");
+	return;
+    }
+    // ml_delete() works on the current buffer.
+    curbuf = buf;
+    bench_seed = 1;
+
+    // Appending at the end, one line at a time.
+    bench_start();
+    for (lnum = 0; lnum < lines; ++lnum)
+	ml_append_buf(buf, lnum, bench_line(lnum), (colnr_T)0, FALSE);
+    bench_report("append", (long)lines);
+
+    // Reading every line in order.
+    bench_start();
+    for (lnum = 1; lnum <= lines; ++lnum)
+	total += STRLEN(ml_get_buf(buf, lnum, FALSE));
+    bench_report("sequential ml_get", (long)lines);
+
+    // Reading random lines.
+    bench_start();
+    for (i = 0; i < BENCH_OPS; ++i)
+	total += ml_get_buf_len(buf, bench_rand_lnum(lines));
+    bench_report("random ml_get", BENCH_OPS);
+
+    // Inserting lines at random positions, this splits data blocks and
+    // pointer blocks.
+    bench_start();
+    for (i = 0; i < BENCH_OPS; ++i)
+	ml_append_buf(buf, bench_rand_lnum(buf->b_ml.ml_line_count),
+					       bench_line(i), (colnr_T)0, FALSE);
+    bench_report("random insert", BENCH_OPS);
+    printf("  %-20s %10ld\n", "blocks",
+				   (long)buf->b_ml.ml_mfp->mf_blocknr_max);
+
+    // Deleting lines in the middle of the buffer.
+    bench_start();
+    for (i = 0; i < BENCH_OPS; ++i)
+	ml_delete(buf->b_ml.ml_line_count / 2, FALSE);
+    bench_report("middle delete", BENCH_OPS);
+
+#ifdef FEAT_BYTEOFF
+    // Line to byte offset lookups.
+    bench_start();
+    for (i = 0; i < BENCH_OPS; ++i)
+	total += ml_find_line_or_offset(buf,
+			  bench_rand_lnum(buf->b_ml.ml_line_count), NULL);
+    bench_report("byte offset", BENCH_OPS);
+#endif
+
+    // Appending in batches, as done for a list with setline().
+    bench_start();
+    for (n = 0; n < lines; n += 1000)
+    {
+	for (i = 0; i < 1000; ++i)
+	    batch[i] = vim_strsave(bench_line(n + i));
+	ml_append_many(buf, buf->b_ml.ml_line_count, batch, 1000L, FALSE);
+	for (i = 0; i < 1000; ++i)
+	    vim_free(batch[i]);
+    }
+    bench_report("batch append", n);
+
+    bench_report_rss();
+    if (total == 0)
+	printf("  no text read\n");
+
+    ml_close(buf, TRUE);
+    curbuf = firstbuf;
+}
+
+    int
+main(int argc, char **argv)
+{
+    int		i;
+
+    vim_memset(&params, 0, sizeof(params));
+    params.argc = 1;
+    params.argv = argv;
+    common_init(&params);
+
+    if (argc < 2)
+	bench_memline((linenr_T)1000000L);
+    for (i = 1; i < argc; ++i)
+	bench_memline((linenr_T)atol(argv[i]));
+    return 0;
+}
+
+#else
+
+    int
+main(void)
+{
+    printf("memline_bench needs the +reltime and +float features\n");
+    return 0;
+}
+
+#endif
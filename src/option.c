@@ -3590,11 +3590,30 @@ set_num_option(
 	errmsg = e_invarg;
 	p_hi = 10000;
     }
-    if (p_re < 0 || p_re > 2)
+    if (p_re < 0 || p_re > 3)
     {
 	errmsg = e_invarg;
 	p_re = 0;
     }
+#ifdef FEAT_RELTIME
+    if (p_rxt < 0)
+    {
+	errmsg = e_positive;
+	p_rxt = 0;
+    }
+#endif
+#ifdef SYN_TIME_LIMIT
+    if (p_sdf < 0)
+    {
+	errmsg = e_positive;
+	p_sdf = 0;
+    }
+#endif
+    if (p_lzl < 0)
+    {
+	errmsg = e_positive;
+	p_lzl = 0;
+    }
     if (p_report < 0)
     {
 	errmsg = e_positive;
@@ -687,6 +687,7 @@ EXTERN long	p_ls;		// 'laststatus'
 EXTERN long	p_stal;		// 'showtabline'
 EXTERN char_u	*p_lcs;		// 'listchars'
 
+EXTERN long	p_lzl;		// 'lazyload'
 EXTERN int	p_lz;		// 'lazyredraw'
 EXTERN int	p_lpl;		// 'loadplugins'
 #if defined(DYNAMIC_LUA)
@@ -718,6 +719,7 @@ EXTERN long	p_mmd;		// 'maxmapdepth'
 EXTERN long	p_mm;		// 'maxmem'
 EXTERN long	p_mmp;		// 'maxmempattern'
 EXTERN long	p_mmt;		// 'maxmemtot'
+EXTERN int	p_mcp;		// 'memcompress'
 #ifdef FEAT_MENU
 EXTERN long	p_mis;		// 'menuitems'
 #endif
@@ -788,6 +790,9 @@ EXTERN long	p_rdt;		// 'redrawtime'
 #endif
 EXTERN int	p_remap;	// 'remap'
 EXTERN long	p_re;		// 'regexpengine'
+#ifdef FEAT_RELTIME
+EXTERN long	p_rxt;		// 'regexptimeout'
+#endif
 #ifdef FEAT_RENDER_OPTIONS
 EXTERN char_u	*p_rop;		// 'renderoptions'
 #endif
@@ -889,6 +894,12 @@ EXTERN int	p_sb;		// 'splitbelow'
 EXTERN char_u	*p_sua;		// 'suffixesadd'
 #endif
 EXTERN int	p_swf;		// 'swapfile'
+#ifdef SYN_CACHE
+EXTERN char_u	*p_scd;		// 'syncachedir'
+#endif
+#ifdef SYN_TIME_LIMIT
+EXTERN long	p_sdf;		// 'syndefer'
+#endif
 #ifdef FEAT_SYN_HL
 EXTERN long	p_smc;		// 'synmaxcol'
 #endif
@@ -44,6 +44,8 @@ char_u *get_highlight_name(expand_T *xp, int idx);
 char_u *get_highlight_name_ext(expand_T *xp, int idx, int skip_cleared);
 void free_highlight_fonts(void);
 void clear_matches(win_T *wp);
+void hlcache_free(buf_T *buf);
+void hlcache_changed(buf_T *buf, linenr_T lnum, linenr_T lnume, long xtra);
 void init_search_hl(win_T *wp, match_T *search_hl);
 void prepare_search_hl(win_T *wp, match_T *search_hl, linenr_T lnum);
 int prepare_search_hl_line(win_T *wp, linenr_T lnum, colnr_T mincol, char_u **line, match_T *search_hl, int *search_attr);
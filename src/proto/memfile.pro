@@ -9,8 +9,11 @@ bhdr_T *mf_get(memfile_T *mfp, blocknr_T nr, int page_count);
 void mf_put(memfile_T *mfp, bhdr_T *hp, int dirty, int infile);
 void mf_free(memfile_T *mfp, bhdr_T *hp);
 int mf_sync(memfile_T *mfp, int flags);
+void mf_sync_hold(int hold);
+int mf_sync_pending(void);
 void mf_set_dirty(memfile_T *mfp);
 int mf_release_all(void);
+int mf_compress_cold(memfile_T *mfp, int all);
 blocknr_T mf_trans_del(memfile_T *mfp, blocknr_T old_nr);
 void mf_set_ffname(memfile_T *mfp);
 void mf_fullname(memfile_T *mfp);
@@ -1,17 +1,31 @@
 /* regexp.c */
 int re_multiline(regprog_T *prog);
+int re_volatile(regprog_T *prog);
+void regexp_timeout_start(long msec, regtimeout_T *rt);
+int regexp_timeout_end(regtimeout_T *rt);
+int regexp_timed_out(void);
 char_u *skip_regexp(char_u *startp, int dirc, int magic, char_u **newp);
 reg_extmatch_T *ref_extmatch(reg_extmatch_T *em);
 void unref_extmatch(reg_extmatch_T *em);
+char_u *vim_regprog_literal(regprog_T *prog, int ic, int *icp);
+int vim_regprog_first_bytes(regprog_T *prog, int ic, char_u *bytes);
+int vim_regfind_literal(char_u *s, size_t len, char_u *lit, int ic);
 char_u *regtilde(char_u *source, int magic);
 int vim_regsub(regmatch_T *rmp, char_u *source, typval_T *expr, char_u *dest, int copy, int magic, int backslash);
 int vim_regsub_multi(regmmatch_T *rmp, linenr_T lnum, char_u *source, char_u *dest, int copy, int magic, int backslash);
 char_u *reg_submatch(int no);
 list_T *reg_submatch_list(int no);
 int vim_regcomp_had_eol(void);
-regprog_T *vim_regcomp(char_u *expr_arg, int re_flags);
+regprog_T *vim_regcomp(char_u *expr, int re_flags);
 void vim_regfree(regprog_T *prog);
+int vim_regprog_save_id(void);
+int vim_regprog_save(regprog_T *prog, char_u *expr, int re_flags, garray_T *gap);
+int vim_regprog_saved_len(char_u *p, int len);
+regprog_T *vim_regprog_load(char_u *p, int len, char_u *expr, int re_flags);
 void free_regexp_stuff(void);
+void f_regexpcacheinfo(typval_T *argvars, typval_T *rettv);
+void ex_regtime(exarg_T *eap);
+void f_regtimeinfo(typval_T *argvars, typval_T *rettv);
 int regprog_in_use(regprog_T *prog);
 int vim_regexec_prog(regprog_T **prog, int ignore_case, char_u *line, colnr_T col);
 int vim_regexec(regmatch_T *rmp, char_u *line, colnr_T col);
@@ -1,6 +1,11 @@
 /* syntax.c */
 void syn_set_timeout(proftime_T *tm);
+void syn_set_defer(proftime_T *tm);
+int syn_defer_line(win_T *wp, linenr_T lnum);
+int syn_is_deferring(void);
+int syn_redraw_deferred(void);
 void syntax_start(win_T *wp, linenr_T lnum);
+int syn_idle_parse(void);
 void syn_stack_free_all(synblock_T *block);
 void syn_stack_apply_changes(buf_T *buf);
 void syntax_end_parsing(linenr_T lnum);
@@ -8,6 +13,7 @@ int syntax_check_changed(linenr_T lnum);
 int get_syntax_attr(colnr_T col, int *can_spell, int keep_state);
 void syntax_clear(synblock_T *block);
 void reset_synblock(win_T *wp);
+void syn_cache_done(scid_T sid);
 void ex_syntax(exarg_T *eap);
 void ex_ownsyntax(exarg_T *eap);
 int syntax_present(win_T *win);
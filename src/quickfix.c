@@ -5643,6 +5643,75 @@ vgr_display_fname(char_u *fname)
     out_flush();
 }
 
+// Size of the blocks used to read a file in vgr_file_may_match().
+#define VGR_READ_SIZE	65536
+
+/*
+ * Return FALSE when file "fname" cannot contain a match for the vimgrep
+ * pattern, because the literal text every match contains is not in the file.
+ * This avoids loading the file into a buffer.  Returns TRUE when there may be
+ * a match or the raw bytes of the file cannot be checked.
+ */
+    static int
+vgr_file_may_match(char_u *fname, char_u *literal, int literal_ic)
+{
+    int		fd;
+    char_u	*buf;
+    int		overlap = (int)STRLEN(literal) - 1;
+    int		keep = 0;
+    long	len;
+    int		first = TRUE;
+    int		found = MAYBE;
+
+    // Autocommands may read the file in another way, e.g. to uncompress it.
+    if (has_autocmd(EVENT_BUFREADCMD, fname, NULL)
+	    || has_autocmd(EVENT_BUFREADPRE, fname, NULL))
+	return TRUE;
+#ifdef FEAT_EVAL
+    if (*p_ccv != NUL)
+	return TRUE;
+#endif
+
+    fd = mch_open((char *)fname, O_RDONLY | O_EXTRA, 0);
+    if (fd < 0)
+	return TRUE;	// loading gives the error message
+    buf = alloc(VGR_READ_SIZE + overlap);
+    if (buf == NULL)
+    {
+	close(fd);
+	return TRUE;
+    }
+
+    for (;;)
+    {
+	len = read_eintr(fd, buf + keep, VGR_READ_SIZE);
+	if (len <= 0)
+	{
+	    // Read error: let loading the file deal with it.
+	    found = len < 0 ? MAYBE : FAIL;
+	    break;
+	}
+	// An encrypted file needs to be decrypted first.
+	if (first && len + keep >= 9 && STRNCMP(buf, "VimCrypt~", 9) == 0)
+	    break;
+	first = FALSE;
+	len += keep;
+	found = vim_regfind_literal(buf, (size_t)len, literal, literal_ic);
+	if (found != FAIL)
+	    break;
+	// The text may be split over two blocks.
+	keep = len < overlap ? (int)len : overlap;
+	mch_memmove(buf, buf + len - keep, (size_t)keep);
+	line_breakcheck();
+	if (got_int)
+	    break;
+    }
+
+    vim_free(buf);
+    close(fd);
+    return found != FAIL;
+}
+
 /*
  * Load a dummy buffer to search for a pattern using vimgrep.
  */
@@ -5822,6 +5891,8 @@ typedef struct
     char_u	**fnames;	// list of files to search
     int		fcount;		// number of files
     regmmatch_T	regmatch;	// compiled search pattern
+    char_u	*literal;	// text every match contains or NULL
+    int		literal_ic;	// ignore case for "literal"
     char_u	*qf_title;	// quickfix list title
 } vgr_args_T;
 
@@ -5858,6 +5929,8 @@ vgr_process_args(
     vgr_init_regmatch(&args->regmatch, args->spat);
     if (args->regmatch.regprog == NULL)
 	return FAIL;
+    args->literal = vim_regprog_literal(args->regmatch.regprog,
+				   args->regmatch.rmm_ic, &args->literal_ic);
 
     p = skipwhite(p);
     if (*p == NUL)
@@ -5929,6 +6002,11 @@ vgr_process_files(
 	buf = buflist_findname_exp(cmd_args->fnames[fi]);
 	if (buf == NULL || buf->b_ml.ml_mfp == NULL)
 	{
+	    // Only load a file into a buffer when it may contain a match.
+	    if (cmd_args->literal != NULL && !vgr_file_may_match(fname,
+				cmd_args->literal, cmd_args->literal_ic))
+		continue;
+
 	    // Remember that a buffer with this name already exists.
 	    duplicate_name = (buf != NULL);
 	    using_dummy = TRUE;
@@ -6139,6 +6217,7 @@ ex_vimgrep(exarg_T *eap)
 
 theend:
     vim_free(args.qf_title);
+    vim_free(args.literal);
     vim_free(target_dir);
     vim_regfree(args.regmatch.regprog);
 }
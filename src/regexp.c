@@ -11,6 +11,12 @@
 
 #include "vim.h"
 
+// Use SSE2 instructions for searching for literal text, when available.
+#if defined(__SSE2__) && defined(__GNUC__)
+# include <emmintrin.h>
+# define REG_USE_SSE2
+#endif
+
 #ifdef DEBUG
 // show/save debugging data when BT engine is used
 # define BT_REGEXP_DUMP
@@ -287,6 +293,8 @@ init_class_tab(void)
 #define RF_HASNL    4	// can match a NL
 #define RF_ICOMBINE 8	// ignore combining characters
 #define RF_LOOKBH   16	// uses "\@<=" or "\@<!"
+#define RF_VOLATILE 32	// uses the cursor, Visual area, a mark, a line
+			// number, a virtual column or "\%^" or "\%$"
 
 /*
  * Global work variables for vim_regcomp().
@@ -379,8 +387,12 @@ static int	coll_get_char(void);
 static int	prog_magic_wrong(void);
 static int	cstrncmp(char_u *s1, char_u *s2, int *n);
 static char_u	*cstrchr(char_u *, int);
+static char_u	*reg_memchr2(char_u *s, size_t len, int c1, int c2);
+static int	reg_find_literal(char_u *s, char_u *lit, int litlen);
+static regprog_T *vim_regcomp_nocache(char_u *expr_arg, int re_flags);
 static int	re_mult_next(char *what);
 static int	reg_iswordc(int);
+static int	nfa_first_bytes(nfa_regprog_T *prog, char_u *bytes);
 
 static regengine_T bt_regengine;
 static regengine_T nfa_regengine;
@@ -394,6 +406,16 @@ re_multiline(regprog_T *prog)
     return (prog->regflags & RF_HASNL);
 }
 
+/*
+ * Return TRUE if the result of matching compiled regular expression "prog"
+ * depends on more than the text of the lines, such as the cursor position.
+ */
+    int
+re_volatile(regprog_T *prog)
+{
+    return (prog->regflags & RF_VOLATILE);
+}
+
 /*
  * Check for an equivalence class name "[=a=]".  "pp" points to the '['.
  * Returns a character representing the class. Zero means that no item was
@@ -1128,11 +1150,137 @@ typedef struct {
 #ifdef FEAT_SYN_HL
     int nfa_has_zsubexpr;   // NFA regexp has \z( ), set zsubexpr.
 #endif
+
+#ifdef FEAT_RELTIME
+    // Time limit for matching and the flag to set when it passed, see
+    // reg_set_time_limit().
+    proftime_T		*reg_tm;
+    int			*reg_timed_out;
+    int			reg_tm_count;
+#endif
 } regexec_T;
 
 static regexec_T	rex;
 static int		rex_in_use = FALSE;
 
+#ifdef FEAT_RELTIME
+// Time limit for matching when the caller does not pass one, set with
+// regexp_timeout_start().
+static proftime_T	reg_timeout_tm;
+static int		reg_timeout_active = FALSE;
+static int		reg_timeout_timed_out = FALSE;
+
+// Look at the clock only once in this many matching steps, it is slow.
+# define REG_TM_STEPS	100
+
+/*
+ * Set the time limit for the following match: "tm" when not NULL, otherwise
+ * the one of regexp_timeout_start(), if any.
+ */
+    static void
+reg_set_time_limit(proftime_T *tm, int *timed_out)
+{
+    if (tm == NULL && reg_timeout_active)
+    {
+	tm = &reg_timeout_tm;
+	timed_out = &reg_timeout_timed_out;
+    }
+    rex.reg_tm = tm;
+    rex.reg_timed_out = timed_out;
+    rex.reg_tm_count = 0;
+}
+#endif
+
+/*
+ * Called for every step of matching.  Checks for CTRL-C and, once in
+ * REG_TM_STEPS calls, whether the time limit passed.
+ * Returns TRUE when matching must be aborted.
+ */
+    static int
+reg_check_abort(void)
+{
+    fast_breakcheck();
+    if (got_int)
+	return TRUE;
+#ifdef FEAT_RELTIME
+    if (rex.reg_tm != NULL && ++rex.reg_tm_count >= REG_TM_STEPS)
+    {
+	rex.reg_tm_count = 0;
+	if (profile_passed_limit(rex.reg_tm))
+	{
+	    if (rex.reg_timed_out != NULL)
+		*rex.reg_timed_out = TRUE;
+	    return TRUE;
+	}
+    }
+#endif
+    return FALSE;
+}
+
+/*
+ * Limit the time spent on matching patterns for which the caller does not
+ * pass a time limit, until regexp_timeout_end() is called with the same "rt".
+ * The limit is "msec" milliseconds, when zero 'regexptimeout' is used.  When
+ * that is zero too, or "msec" is negative, there is no limit, except one set
+ * by an outer regexp_timeout_start().  An outer limit that passes earlier is
+ * kept.
+ */
+    void
+regexp_timeout_start(long msec, regtimeout_T *rt)
+{
+#ifdef FEAT_RELTIME
+    proftime_T	tm;
+
+    rt->rt_tm = reg_timeout_tm;
+    rt->rt_active = reg_timeout_active;
+    rt->rt_timed_out = reg_timeout_timed_out;
+    reg_timeout_timed_out = FALSE;
+
+    if (msec == 0)
+	msec = p_rxt;
+    if (msec > 0)
+    {
+	profile_setlimit(msec, &tm);
+	if (!reg_timeout_active || profile_cmp(&reg_timeout_tm, &tm) < 0)
+	    reg_timeout_tm = tm;
+	reg_timeout_active = TRUE;
+    }
+#endif
+}
+
+/*
+ * Restore the time limit from before regexp_timeout_start().
+ * Returns TRUE when matching was aborted because the time limit passed.
+ */
+    int
+regexp_timeout_end(regtimeout_T *rt UNUSED)
+{
+#ifdef FEAT_RELTIME
+    int	    timed_out = reg_timeout_timed_out;
+
+    reg_timeout_tm = rt->rt_tm;
+    reg_timeout_active = rt->rt_active;
+    reg_timeout_timed_out = rt->rt_timed_out;
+    return timed_out;
+#else
+    return FALSE;
+#endif
+}
+
+/*
+ * Return TRUE when matching was aborted because the time limit of
+ * regexp_timeout_start() passed.  Used to stop going over lines early.
+ */
+    int
+regexp_timed_out(void)
+{
+#ifdef FEAT_RELTIME
+    return reg_timeout_timed_out;
+#else
+    return FALSE;
+#endif
+}
+
 /*
  * Return TRUE if character 'c' is included in 'iskeyword' option for
  * "reg_buf" buffer.
@@ -1647,6 +1795,263 @@ cstrchr(char_u *s, int c)
     return NULL;
 }
 
+/*
+ * Find the first byte in "s[len]" that is "c1" or "c2".  Returns NULL when
+ * there is none.  Looks at 16 bytes at a time when SSE2 can be used.
+ */
+    static char_u *
+reg_memchr2(char_u *s, size_t len, int c1, int c2)
+{
+    char_u	*end = s + len;
+
+    if (c1 == c2)
+	return memchr(s, c1, len);
+#ifdef REG_USE_SSE2
+    {
+	__m128i	v1 = _mm_set1_epi8((char)c1);
+	__m128i	v2 = _mm_set1_epi8((char)c2);
+	__m128i	x;
+	int	mask;
+
+	for ( ; end - s >= 16; s += 16)
+	{
+	    x = _mm_loadu_si128((__m128i *)s);
+	    mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(x, v1),
+						      _mm_cmpeq_epi8(x, v2)));
+	    if (mask != 0)
+		return s + __builtin_ctz(mask);
+	}
+    }
+#endif
+    for ( ; s < end; ++s)
+	if (*s == c1 || *s == c2)
+	    return s;
+    return NULL;
+}
+
+/*
+ * Return TRUE if "s[len]" contains a byte with the high bit set.
+ */
+    static int
+reg_has_highbyte(char_u *s, size_t len)
+{
+    char_u	*end = s + len;
+
+#ifdef REG_USE_SSE2
+    for ( ; end - s >= 16; s += 16)
+	if (_mm_movemask_epi8(_mm_loadu_si128((__m128i *)s)) != 0)
+	    return TRUE;
+#endif
+    for ( ; s < end; ++s)
+	if (*s >= 0x80)
+	    return TRUE;
+    return FALSE;
+}
+
+/*
+ * Find the bytes "lit[litlen]" in "s[len]".  When "ic" is TRUE ignore case
+ * of ASCII letters.  Returns a pointer to the first match or NULL.
+ */
+    static char_u *
+reg_find_bytes(char_u *s, size_t len, char_u *lit, int litlen, int ic)
+{
+    char_u	*end = s + len;
+    char_u	*p = s;
+    int		c1 = lit[0];
+    int		c2 = c1;
+    int		i;
+
+    if (ic)
+	c2 = ASCII_ISUPPER(c1) ? TOLOWER_ASC(c1) : TOUPPER_ASC(c1);
+    while (end - p >= litlen)
+    {
+	// Find the first byte, then compare the rest.
+	p = reg_memchr2(p, (size_t)(end - p) - litlen + 1, c1, c2);
+	if (p == NULL)
+	    break;
+	if (!ic)
+	{
+	    if (memcmp(p + 1, lit + 1, litlen - 1) == 0)
+		return p;
+	}
+	else
+	{
+	    for (i = 1; i < litlen; ++i)
+		if (TOLOWER_ASC(p[i]) != TOLOWER_ASC(lit[i]))
+		    break;
+	    if (i == litlen)
+		return p;
+	}
+	++p;
+    }
+    return NULL;
+}
+
+/*
+ * Check if the literal text "lit[litlen]" appears in "s", ignoring case when
+ * rex.reg_ic is set.  The bytes are compared, thus this only works for a
+ * single-byte encoding and UTF-8.
+ * Returns OK when found, FAIL when it does not appear and MAYBE when this
+ * cannot be checked byte-wise.
+ */
+    static int
+reg_find_literal(char_u *s, char_u *lit, int litlen)
+{
+    int		ic = FALSE;
+    size_t	len;
+    int		i;
+
+    if ((has_mbyte && !enc_utf8) || (enc_utf8 && rex.reg_icombine))
+	return MAYBE;
+    if (rex.reg_ic)
+	for (i = 0; i < litlen; ++i)
+	{
+	    if (lit[i] >= 0x80)
+		return MAYBE;
+	    if (ASCII_ISALPHA(lit[i]))
+		ic = TRUE;
+	}
+
+    len = STRLEN(s);
+    if (reg_find_bytes(s, len, lit, litlen, ic) != NULL)
+	return OK;
+    // A non-ASCII character may match an ASCII letter when ignoring case,
+    // e.g. the Kelvin sign.
+    if (ic && reg_has_highbyte(s, len))
+	return MAYBE;
+    return FAIL;
+}
+
+/*
+ * Get the literal text that every match of "prog" contains, for searching the
+ * raw bytes of a file.  Only returned when it is ASCII without a line break,
+ * so that it does not depend on the encoding of the file.  "*icp" is set when
+ * case is to be ignored, using "ic" unless the pattern overrules it.
+ * Returns NULL when there is no such text, otherwise allocated memory.
+ */
+    char_u *
+vim_regprog_literal(regprog_T *prog, int ic, int *icp)
+{
+    char_u	*lit = NULL;
+    char_u	*p;
+
+    if (prog == NULL || (has_mbyte && !enc_utf8)
+			     || (enc_utf8 && (prog->regflags & RF_ICOMBINE)))
+	return NULL;
+    if (prog->engine == &bt_regengine)
+    {
+	bt_regprog_T *bt = (bt_regprog_T *)prog;
+
+	if (bt->regmust != NULL)
+	    lit = vim_strnsave(bt->regmust, bt->regmlen);
+    }
+    else
+    {
+	nfa_regprog_T *nfa = (nfa_regprog_T *)prog;
+
+	if (nfa->match_text != NULL)
+	{
+	    // The first character is in "regstart".
+	    if (nfa->regstart > 0 && nfa->regstart < 0x80)
+	    {
+		lit = alloc(STRLEN(nfa->match_text) + 2);
+		if (lit != NULL)
+		{
+		    lit[0] = nfa->regstart;
+		    STRCPY(lit + 1, nfa->match_text);
+		}
+	    }
+	}
+	else if (nfa->must_text != NULL)
+	    lit = vim_strsave(nfa->must_text);
+    }
+    if (lit == NULL)
+	return NULL;
+
+    for (p = lit; *p != NUL; ++p)
+	if (*p >= 0x80 || *p == '\r' || *p == '\n')
+	{
+	    vim_free(lit);
+	    return NULL;
+	}
+    if (*lit == NUL)
+    {
+	vim_free(lit);
+	return NULL;
+    }
+
+    if (prog->regflags & RF_ICASE)
+	*icp = TRUE;
+    else if (prog->regflags & RF_NOICASE)
+	*icp = FALSE;
+    else
+	*icp = ic;
+    return lit;
+}
+
+/*
+ * Set "bytes", a table of 256 bits, to the bytes that a match of "prog"
+ * can start with when matching with "ic".  No match starts at a byte that is
+ * not in the table, thus matching can start at the first byte that is.
+ * Returns FAIL when this is unknown, e.g. when "prog" can match zero
+ * characters or at the end of the line.
+ */
+    int
+vim_regprog_first_bytes(regprog_T *prog, int ic, char_u *bytes)
+{
+    int		save_ic = rex.reg_ic;
+    buf_T	*save_buf = rex.reg_buf;
+    int		r;
+
+    // In a double-byte encoding a trail byte can look like a first byte.
+    if (prog == NULL || prog->engine != &nfa_regengine
+	    || (has_mbyte && !enc_utf8) || (prog->regflags & RF_ICOMBINE))
+	return FAIL;
+
+    // Use the same 'ignorecase' as nfa_regexec_both().
+    if (prog->regflags & RF_ICASE)
+	rex.reg_ic = TRUE;
+    else if (prog->regflags & RF_NOICASE)
+	rex.reg_ic = FALSE;
+    else
+	rex.reg_ic = ic;
+    rex.reg_buf = curbuf;
+    r = nfa_first_bytes((nfa_regprog_T *)prog, bytes);
+    rex.reg_ic = save_ic;
+    rex.reg_buf = save_buf;
+    return r;
+}
+
+/*
+ * Find the literal text "lit" returned by vim_regprog_literal() in the bytes
+ * "s[len]", which may contain NUL bytes.
+ * Returns OK when found, FAIL when it does not appear and MAYBE when the
+ * bytes cannot be checked: they contain a NUL, which may be UTF-16, or a
+ * non-ASCII character that may match a letter when ignoring case.
+ */
+    int
+vim_regfind_literal(char_u *s, size_t len, char_u *lit, int ic)
+{
+    int		litlen = (int)STRLEN(lit);
+    int		i;
+
+    if (memchr(s, NUL, len) != NULL)
+	return MAYBE;
+    if (ic)
+    {
+	for (i = 0; i < litlen; ++i)
+	    if (ASCII_ISALPHA(lit[i]))
+		break;
+	if (i == litlen)
+	    ic = FALSE;
+    }
+    if (reg_find_bytes(s, len, lit, litlen, ic) != NULL)
+	return OK;
+    if (ic && reg_has_highbyte(s, len))
+	return MAYBE;
+    return FAIL;
+}
+
 ////////////////////////////////////////////////////////////////
 //		      regsub stuff			      //
 ////////////////////////////////////////////////////////////////
@@ -2541,18 +2946,176 @@ static int regexp_engine = 0;
 static char_u regname[][30] = {
 		    "AUTOMATIC Regexp Engine",
 		    "BACKTRACKING Regexp Engine",
-		    "NFA Regexp Engine"
+		    "NFA Regexp Engine",
+		    "BIT-PARALLEL Regexp Engine"
 			    };
 #endif
 
+/*
+ * Cache of compiled regexp programs.  The same pattern is often compiled
+ * again, e.g. for every call of substitute() in a loop.  vim_regcomp() returns
+ * the cached program when the pattern, flags and options are the same.  The
+ * cache holds a reference, see vim_regfree().  The least recently used entry
+ * is dropped when the cache is full.
+ */
+#define REGCACHE_SIZE	64
+
+typedef struct
+{
+    char_u	*rc_pattern;	// pattern passed to vim_regcomp()
+    hash_T	rc_hash;	// hash of "rc_pattern"
+    int		rc_flags;	// "re_flags" passed to vim_regcomp()
+    int		rc_options;	// 'regexpengine', 'cpoptions' and encoding
+    int		rc_extmatch;	// value of "reg_do_extmatch"
+    int		rc_had_eol;	// value of "had_eol" after compiling
+    char_u	rc_chartab[32];	// b_chartab of curbuf, "[[:keyword:]]"
+				// is compiled with it
+    int		rc_chartab_tick; // value of "chartab_tick"
+    regprog_T	*rc_prog;	// compiled program, NULL when entry not used
+    long	rc_lastused;	// value of "regcache_tick" when last used
+} regcache_T;
+
+static regcache_T   regcache[REGCACHE_SIZE];
+static long	    regcache_tick = 0;
+static long	    regcache_lookups = 0;
+static long	    regcache_hits = 0;
+static long	    regcache_compiles = 0;
+
+/*
+ * Return the options that compiling a pattern depends on.
+ */
+    static int
+regcache_options(void)
+{
+    get_cpo_flags();
+    return p_re + (reg_cpo_lit << 2) + (reg_cpo_bsl << 3)
+		       + (has_mbyte << 4) + (enc_utf8 << 5) + (enc_dbcs << 6);
+}
+
+/*
+ * Find "expr" with "re_flags" in the cache.  Returns NULL when not found.
+ */
+    static regcache_T *
+regcache_find(char_u *expr, hash_T hash, int re_flags, int options)
+{
+    int		i;
+    regcache_T	*rc;
+
+    for (i = 0; i < REGCACHE_SIZE; ++i)
+    {
+	rc = &regcache[i];
+	if (rc->rc_prog != NULL && rc->rc_hash == hash
+		&& rc->rc_flags == re_flags && rc->rc_options == options
+#ifdef FEAT_SYN_HL
+		&& rc->rc_extmatch == reg_do_extmatch
+#endif
+		&& rc->rc_chartab_tick == chartab_tick
+		&& memcmp(rc->rc_chartab, curbuf->b_chartab, (size_t)32) == 0
+		&& STRCMP(rc->rc_pattern, expr) == 0)
+	    return rc;
+    }
+    return NULL;
+}
+
+/*
+ * Add "prog" compiled from "expr" to the cache, dropping the least recently
+ * used entry when it is full.
+ */
+    static void
+regcache_add(
+    regprog_T	*prog,
+    char_u	*expr,
+    hash_T	hash,
+    int		re_flags,
+    int		options)
+{
+    int		i;
+    regcache_T	*rc = &regcache[0];
+    char_u	*pattern;
+
+    pattern = vim_strsave(expr);
+    if (pattern == NULL)
+	return;
+    for (i = 0; i < REGCACHE_SIZE; ++i)
+    {
+	if (regcache[i].rc_prog == NULL)
+	{
+	    rc = &regcache[i];
+	    break;
+	}
+	if (regcache[i].rc_lastused < rc->rc_lastused)
+	    rc = &regcache[i];
+    }
+    if (rc->rc_prog != NULL)
+    {
+	vim_free(rc->rc_pattern);
+	vim_regfree(rc->rc_prog);
+    }
+
+    rc->rc_pattern = pattern;
+    rc->rc_hash = hash;
+    rc->rc_flags = re_flags;
+    rc->rc_options = options;
+#ifdef FEAT_SYN_HL
+    rc->rc_extmatch = reg_do_extmatch;
+#endif
+    rc->rc_had_eol = had_eol;
+    mch_memmove(rc->rc_chartab, curbuf->b_chartab, (size_t)32);
+    rc->rc_chartab_tick = chartab_tick;
+    rc->rc_prog = prog;
+    rc->rc_lastused = ++regcache_tick;
+    ++prog->re_refcount;
+}
+
 /*
  * Compile a regular expression into internal code.
  * Returns the program in allocated memory.
  * Use vim_regfree() to free the memory.
  * Returns NULL for an error.
+ * The program may be shared with other users through the cache of compiled
+ * programs, it must not be changed.
  */
     regprog_T *
-vim_regcomp(char_u *expr_arg, int re_flags)
+vim_regcomp(char_u *expr, int re_flags)
+{
+    regprog_T	*prog;
+    regcache_T	*rc;
+    hash_T	hash;
+    int		options;
+    int		save_called_emsg;
+
+    hash = hash_hash(expr);
+    options = regcache_options();
+    ++regcache_lookups;
+    rc = regcache_find(expr, hash, re_flags, options);
+    // A program that is being executed cannot be used recursively, compile
+    // it again then.
+    if (rc != NULL && !rc->rc_prog->re_in_use)
+    {
+	++regcache_hits;
+	rc->rc_lastused = ++regcache_tick;
+	had_eol = rc->rc_had_eol;
+	++rc->rc_prog->re_refcount;
+	return rc->rc_prog;
+    }
+
+    save_called_emsg = called_emsg;
+    called_emsg = FALSE;
+    prog = vim_regcomp_nocache(expr, re_flags);
+    // Do not cache a pattern that gave an error message, the message should
+    // be given again.  "~" depends on the previous substitute string.
+    if (prog != NULL && rc == NULL && !called_emsg
+					       && vim_strchr(expr, '~') == NULL)
+	regcache_add(prog, expr, hash, re_flags, options);
+    called_emsg |= save_called_emsg;
+    return prog;
+}
+
+/*
+ * Compile a regular expression, without using the cache.
+ */
+    static regprog_T *
+vim_regcomp_nocache(char_u *expr_arg, int re_flags)
 {
     regprog_T   *prog = NULL;
     char_u	*expr = expr_arg;
@@ -2567,7 +3130,8 @@ vim_regcomp(char_u *expr_arg, int re_flags)
 
 	if (newengine == AUTOMATIC_ENGINE
 	    || newengine == BACKTRACKING_ENGINE
-	    || newengine == NFA_ENGINE)
+	    || newengine == NFA_ENGINE
+	    || newengine == BITPARALLEL_ENGINE)
 	{
 	    regexp_engine = expr[4] - '0';
 	    expr += 5;
@@ -2578,7 +3142,7 @@ vim_regcomp(char_u *expr_arg, int re_flags)
 	}
 	else
 	{
-	    emsg(_("E864: \\%#= can only be followed by 0, 1, or 2. The automatic engine will be used "));
+	    emsg(_("E864: \\%#= can only be followed by 0, 1, 2 or 3. The automatic engine will be used "));
 	    regexp_engine = AUTOMATIC_ENGINE;
 	}
     }
@@ -2634,10 +3198,21 @@ vim_regcomp(char_u *expr_arg, int re_flags)
 
     if (prog != NULL)
     {
+	// Simple patterns can be matched with the bit-parallel matcher.
+	if (prog->engine == &nfa_regengine
+		&& (regexp_engine == AUTOMATIC_ENGINE
+					|| regexp_engine == BITPARALLEL_ENGINE))
+	    nfa_bp_compile((nfa_regprog_T *)prog);
+
 	// Store the info needed to call regcomp() again when the engine turns
 	// out to be very slow when executing it.
 	prog->re_engine = regexp_engine;
 	prog->re_flags  = re_flags;
+	prog->re_refcount = 1;
+#ifdef FEAT_PROFILE
+	prog->re_expr = vim_strsave(expr_arg);
+#endif
+	++regcache_compiles;
     }
 
     return prog;
@@ -2645,18 +3220,566 @@ vim_regcomp(char_u *expr_arg, int re_flags)
 
 /*
  * Free a compiled regexp program, returned by vim_regcomp().
+ * It is only freed when the last reference is gone.
  */
     void
 vim_regfree(regprog_T *prog)
 {
-    if (prog != NULL)
+    if (prog != NULL && --prog->re_refcount <= 0)
+    {
+#ifdef FEAT_PROFILE
+	vim_free(prog->re_expr);
+#endif
 	prog->engine->regfree(prog);
+    }
 }
 
+#if defined(SYN_CACHE) || defined(PROTO)
+/*
+ * Saving and loading compiled programs, for the cache of syntax patterns in
+ * 'syncachedir'.  Only programs of the NFA engine are saved, the states are
+ * stored with an index instead of a pointer.  The data is only valid for the
+ * same Vim executable, the caller must check for that.
+ */
+typedef struct
+{
+    int		rs_len;		// length of the entry, including this header
+    int		rs_flags;	// "re_flags" passed to vim_regcomp()
+    int		rs_options;	// value of regcache_options()
+    int		rs_extmatch;	// value of "reg_do_extmatch"
+    int		rs_had_eol;	// value of "had_eol" after compiling
+    int		rs_patlen;	// length of the pattern
+    int		rs_match_len;	// length of "match_text", -1 for NULL
+    int		rs_must_len;	// length of "must_text", -1 for NULL
+    int		rs_re_engine;
+    int		rs_regflags;
+    int		rs_reganch;
+    int		rs_regstart;
+    int		rs_has_zend;
+    int		rs_has_backref;
+    int		rs_reghasz;
+    int		rs_nsubexp;
+    int		rs_dfa_usable;
+    int		rs_nstate;
+    int		rs_start;	// index of the start state
+} progsave_T;
+
+// One NFA state in a saved program.
+typedef struct
+{
+    int		rss_c;
+    int		rss_out;	// index of the "out" state, -1 for NULL
+    int		rss_out1;	// index of the "out1" state, -1 for NULL
+    int		rss_val;
+} progsave_state_T;
+
+// An entry is a progsave_T followed by the pattern, "match_text", "must_text"
+// and "rs_nstate" progsave_state_T, without padding.
+
+/*
+ * Return the index of state "s" in "prog", -1 for NULL.
+ */
+    static int
+progsave_index(nfa_regprog_T *prog, nfa_state_T *s)
+{
+    if (s == NULL || s < prog->state || s >= prog->state + prog->nstate)
+	return -1;
+    return (int)(s - prog->state);
+}
+
+/*
+ * Append "len" bytes at "p" to "gap", nothing when "len" is negative.  Space
+ * must have been allocated.
+ */
+    static void
+progsave_append(garray_T *gap, void *p, int len)
+{
+    if (len > 0)
+    {
+	mch_memmove((char_u *)gap->ga_data + gap->ga_len, p, (size_t)len);
+	gap->ga_len += len;
+    }
+}
+
+/*
+ * Return a number that identifies the saved programs of this Vim executable:
+ * it depends on the build date and time, the NFA opcodes and the size of the
+ * saved structures.  Programs saved with another number must not be loaded.
+ */
+    int
+vim_regprog_save_id(void)
+{
+    static int	nums[] = {NFA_SPLIT, NFA_LAST_NL, NFA_CLASS_FNAME,
+			  NFA_END_COMPOSING, NFA_ZCLOSE9, NSUBEXP,
+			  (int)sizeof(progsave_T),
+			  (int)sizeof(progsave_state_T)};
+    hash_T	hash = 0;
+    int		i;
+
+# ifdef HAVE_DATE_TIME
+    hash = hash_hash((char_u *)__DATE__ " " __TIME__);
+# endif
+    for (i = 0; i < (int)(sizeof(nums) / sizeof(nums[0])); ++i)
+	hash = hash * 101 + (hash_T)nums[i];
+    return (int)hash;
+}
+
+/*
+ * Return TRUE when "c" can be used for a state of a compiled NFA program:
+ * a character or an opcode that is not only used in the postfix form.
+ */
+    static int
+progsave_valid_c(int c)
+{
+    if (c >= 0)
+	return TRUE;
+    if (c < NFA_SPLIT || c > NFA_CLASS_FNAME)
+	return FALSE;
+    switch (c)
+    {
+	case NFA_END_NEG_COLL:
+	case NFA_RANGE:
+	case NFA_CONCAT:
+	case NFA_OR:
+	case NFA_STAR:
+	case NFA_STAR_NONGREEDY:
+	case NFA_QUEST:
+	case NFA_QUEST_NONGREEDY:
+	case NFA_PREV_ATOM_NO_WIDTH:
+	case NFA_PREV_ATOM_NO_WIDTH_NEG:
+	case NFA_PREV_ATOM_JUST_BEFORE:
+	case NFA_PREV_ATOM_JUST_BEFORE_NEG:
+	case NFA_PREV_ATOM_LIKE_PATTERN:
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Return TRUE when addstate() does not add a state with opcode "c" to the
+ * list but goes on with the states that follow.
+ */
+    static int
+progsave_passthrough(int c)
+{
+    return c == NFA_SPLIT || c == NFA_EMPTY || c == NFA_MOPEN
+	    || c == NFA_ZEND || c == NFA_NCLOSE
+	    || (c >= NFA_MCLOSE && c <= NFA_MCLOSE9)
+	    || (c >= NFA_ZCLOSE && c <= NFA_ZCLOSE9);
+}
+
+/*
+ * Store the states that state "s" leads to without advancing in the text in
+ * "next" and return how many there are.  When "follows" is FALSE this is how
+ * addstate() passes through states, otherwise how match_follows() does.
+ */
+    static int
+progsave_next(nfa_state_T *s, int follows, nfa_state_T **next)
+{
+    if (!follows)
+    {
+	if (!progsave_passthrough(s->c))
+	    return 0;
+	next[0] = s->out;
+	if (s->c != NFA_SPLIT)
+	    return 1;
+	next[1] = s->out1;
+	return 2;
+    }
+
+    switch (s->c)
+    {
+	case NFA_MATCH:
+	case NFA_MCLOSE:
+	case NFA_END_INVISIBLE:
+	case NFA_END_INVISIBLE_NEG:
+	case NFA_END_PATTERN:
+	case NFA_SPLIT:
+	    return 0;
+
+	case NFA_START_INVISIBLE:
+	case NFA_START_INVISIBLE_FIRST:
+	case NFA_START_INVISIBLE_NEG:
+	case NFA_START_INVISIBLE_NEG_FIRST:
+	case NFA_START_INVISIBLE_BEFORE:
+	case NFA_START_INVISIBLE_BEFORE_FIRST:
+	case NFA_START_INVISIBLE_BEFORE_NEG:
+	case NFA_START_INVISIBLE_BEFORE_NEG_FIRST:
+	case NFA_COMPOSING:
+	    next[0] = s->out1->out;
+	    return 1;
+    }
+    // States that advance in the text are included, a loop without a SPLIT
+    // is wrong anyway.
+    next[0] = s->out;
+    return 1;
+}
+
+/*
+ * Return TRUE when the states of "prog" do not form a loop when following
+ * progsave_next().  Removes states that no other one leads to until none is
+ * left.  "count" and "todo" must have room for "prog->nstate" items.
+ */
+    static int
+progsave_acyclic(nfa_regprog_T *prog, int follows, int *count, int *todo)
+{
+    nfa_state_T	*next[2];
+    int		ntodo = 0;
+    int		i, j, k, n;
+
+    vim_memset(count, 0, prog->nstate * sizeof(int));
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	n = progsave_next(&prog->state[i], follows, next);
+	for (j = 0; j < n; ++j)
+	    ++count[next[j] - prog->state];
+    }
+    for (i = 0; i < prog->nstate; ++i)
+	if (count[i] == 0)
+	    todo[ntodo++] = i;
+    for (k = 0; k < ntodo; ++k)
+    {
+	n = progsave_next(&prog->state[todo[k]], follows, next);
+	for (j = 0; j < n; ++j)
+	    if (--count[next[j] - prog->state] == 0)
+		todo[ntodo++] = (int)(next[j] - prog->state);
+    }
+    return ntodo == prog->nstate;
+}
+
+/*
+ * Check the loaded states of "prog", so that matching does not crash or hang
+ * on a damaged cache file: they must be connected like nfa_regcomp() does.
+ * Returns FAIL when they are not.
+ */
+    static int
+progsave_check(nfa_regprog_T *prog)
+{
+    nfa_state_T	*s;
+    nfa_state_T	*p;
+    int		end;
+    int		*count;
+    int		*todo;
+    int		i, n;
+    int		ret = FAIL;
+
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	s = &prog->state[i];
+	if (!progsave_valid_c(s->c) || (s->out == NULL) != (s->c == NFA_MATCH))
+	    return FAIL;
+	if ((s->c >= NFA_MOPEN1 && s->c <= NFA_MOPEN9
+				      && s->c - NFA_MOPEN >= prog->nsubexp)
+		|| (s->c >= NFA_MCLOSE1 && s->c <= NFA_MCLOSE9
+				     && s->c - NFA_MCLOSE >= prog->nsubexp))
+	    return FAIL;
+	if ((s->c >= NFA_ZOPEN && s->c <= NFA_ZCLOSE9
+					     && !(prog->reghasz & REX_SET))
+		|| (s->c >= NFA_ZREF1 && s->c <= NFA_ZREF9
+					     && !(prog->reghasz & REX_USE)))
+	    return FAIL;
+    }
+
+    // Now "out" can be followed, only MATCH ends a chain.
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	s = &prog->state[i];
+	switch (s->c)
+	{
+	    case NFA_SPLIT:
+		if (s->out1 == NULL)
+		    return FAIL;
+		break;
+
+	    case NFA_START_COLL:
+	    case NFA_START_NEG_COLL:
+	    case NFA_COMPOSING:
+		// The items are followed with "out" up to the end state, which
+		// is "out1".
+		end = s->c == NFA_COMPOSING ? NFA_END_COMPOSING : NFA_END_COLL;
+		if (s->out1 == NULL || s->out1->c != end)
+		    return FAIL;
+		n = 0;
+		for (p = s->out; p->c != end; p = p->out)
+		    if (++n > prog->nstate || p->c == NFA_MATCH
+			    || (p->c == NFA_RANGE_MIN
+				&& (p->out->c != NFA_RANGE_MAX || p->val < 0
+				    || p->out->val < p->val
+				    || p->out->val == INT_MAX)))
+			return FAIL;
+		break;
+
+	    case NFA_START_INVISIBLE:
+	    case NFA_START_INVISIBLE_FIRST:
+	    case NFA_START_INVISIBLE_NEG:
+	    case NFA_START_INVISIBLE_NEG_FIRST:
+	    case NFA_START_INVISIBLE_BEFORE:
+	    case NFA_START_INVISIBLE_BEFORE_FIRST:
+	    case NFA_START_INVISIBLE_BEFORE_NEG:
+	    case NFA_START_INVISIBLE_BEFORE_NEG_FIRST:
+		if (s->out1 == NULL || (s->out1->c != NFA_END_INVISIBLE
+				       && s->out1->c != NFA_END_INVISIBLE_NEG))
+		    return FAIL;
+		break;
+
+	    case NFA_START_PATTERN:
+		if (s->out1 == NULL || s->out1->c != NFA_END_PATTERN
+					       || s->out1->out->c != NFA_SKIP)
+		    return FAIL;
+		break;
+	}
+    }
+
+    // addstate() only stops at states it has added before, match_follows()
+    // only at a SPLIT or a state that ends a match.  The states they go
+    // through must not form a loop, it would recurse until the depth limit
+    // or not end at all.
+    count = ALLOC_MULT(int, prog->nstate);
+    todo = ALLOC_MULT(int, prog->nstate);
+    if (count != NULL && todo != NULL
+	    && progsave_acyclic(prog, FALSE, count, todo)
+	    && progsave_acyclic(prog, TRUE, count, todo))
+	ret = OK;
+    vim_free(count);
+    vim_free(todo);
+    return ret;
+}
+
+/*
+ * Take "n" bytes from the "*availp" bytes left of a saved program.
+ * Returns FAIL when "n" is negative or there are not enough.
+ */
+    static int
+progsave_take(size_t *availp, int n)
+{
+    if (n < 0 || (size_t)n > *availp)
+	return FAIL;
+    *availp -= (size_t)n;
+    return OK;
+}
+
+/*
+ * Append "prog", returned by vim_regcomp() for "expr" and "re_flags", to
+ * "gap", so that vim_regprog_load() can read it back.  Must be called right
+ * after vim_regcomp(), the options that compiling depends on are stored with
+ * it.  A pattern with "~" is not saved, it depends on the previous substitute
+ * string.
+ * Returns FAIL when "prog" cannot be saved.
+ */
+    int
+vim_regprog_save(regprog_T *prog, char_u *expr, int re_flags, garray_T *gap)
+{
+    nfa_regprog_T	*nprog = (nfa_regprog_T *)prog;
+    progsave_T		rs;
+    progsave_state_T	rss;
+    nfa_state_T		*s;
+    int			i;
+
+    if (prog == NULL || prog->engine != &nfa_regengine
+					       || vim_strchr(expr, '~') != NULL)
+	return FAIL;
+
+    vim_memset(&rs, 0, sizeof(rs));
+    rs.rs_flags = re_flags;
+    rs.rs_options = regcache_options();
+    rs.rs_extmatch = reg_do_extmatch;
+    rs.rs_had_eol = had_eol;
+    rs.rs_patlen = (int)STRLEN(expr);
+    rs.rs_match_len = nprog->match_text == NULL ? -1
+					     : (int)STRLEN(nprog->match_text);
+    rs.rs_must_len = nprog->must_text == NULL ? -1 : nprog->must_len;
+    rs.rs_re_engine = prog->re_engine;
+    rs.rs_regflags = prog->regflags;
+    rs.rs_reganch = nprog->reganch;
+    rs.rs_regstart = nprog->regstart;
+    rs.rs_has_zend = nprog->has_zend;
+    rs.rs_has_backref = nprog->has_backref;
+    rs.rs_reghasz = nprog->reghasz;
+    rs.rs_nsubexp = nprog->nsubexp;
+    rs.rs_dfa_usable = nprog->dfa_usable;
+    rs.rs_nstate = nprog->nstate;
+    rs.rs_start = progsave_index(nprog, nprog->start);
+    rs.rs_len = (int)sizeof(progsave_T) + rs.rs_patlen
+		+ (rs.rs_match_len > 0 ? rs.rs_match_len : 0)
+		+ (rs.rs_must_len > 0 ? rs.rs_must_len : 0)
+		+ rs.rs_nstate * (int)sizeof(progsave_state_T);
+    if (rs.rs_start < 0 || ga_grow(gap, rs.rs_len) == FAIL)
+	return FAIL;
+
+    progsave_append(gap, &rs, (int)sizeof(progsave_T));
+    progsave_append(gap, expr, rs.rs_patlen);
+    progsave_append(gap, nprog->match_text, rs.rs_match_len);
+    progsave_append(gap, nprog->must_text, rs.rs_must_len);
+    for (i = 0; i < nprog->nstate; ++i)
+    {
+	s = &nprog->state[i];
+	rss.rss_c = s->c;
+	rss.rss_out = progsave_index(nprog, s->out);
+	rss.rss_out1 = progsave_index(nprog, s->out1);
+	rss.rss_val = s->val;
+	progsave_append(gap, &rss, (int)sizeof(progsave_state_T));
+    }
+    return OK;
+}
+
+/*
+ * Return the length of the saved program at "p", which has "len" bytes
+ * available.  Returns zero when it is invalid.
+ */
+    int
+vim_regprog_saved_len(char_u *p, int len)
+{
+    int		entry_len;
+
+    if (len < (int)sizeof(progsave_T))
+	return 0;
+    mch_memmove(&entry_len, p, sizeof(int));
+    if (entry_len < (int)sizeof(progsave_T) || entry_len > len)
+	return 0;
+    return entry_len;
+}
+
+/*
+ * Load a program saved with vim_regprog_save() from "p", which has "len"
+ * bytes.  Returns NULL when it was not saved for "expr" and "re_flags" with
+ * the current options, or it is invalid, or "expr" contains "~".
+ * Otherwise works like vim_regcomp(), also for vim_regcomp_had_eol().
+ */
+    regprog_T *
+vim_regprog_load(char_u *p, int len, char_u *expr, int re_flags)
+{
+    progsave_T		rs;
+    progsave_state_T	rss;
+    nfa_regprog_T	*prog;
+    nfa_state_T		*s;
+    char_u		*text;
+    size_t		avail;
+    int			i;
+
+    if (vim_regprog_saved_len(p, len) != len || vim_strchr(expr, '~') != NULL)
+	return NULL;
+    mch_memmove(&rs, p, sizeof(progsave_T));
+    avail = (size_t)len - sizeof(progsave_T);
+    if (rs.rs_flags != re_flags
+	    || rs.rs_patlen != (int)STRLEN(expr)
+	    || progsave_take(&avail, rs.rs_patlen) == FAIL
+	    || memcmp(p + sizeof(progsave_T), expr, (size_t)rs.rs_patlen) != 0
+	    || rs.rs_options != regcache_options()
+	    || rs.rs_extmatch != reg_do_extmatch)
+	return NULL;
+
+    // Do not trust anything in the file, a damaged program could make
+    // matching crash.  Compute sizes in size_t to avoid overflow.
+    if ((rs.rs_match_len != -1
+		&& progsave_take(&avail, rs.rs_match_len) == FAIL)
+	    || (rs.rs_must_len != -1
+		&& progsave_take(&avail, rs.rs_must_len) == FAIL)
+	    || rs.rs_nstate <= 0
+	    || (size_t)rs.rs_nstate > avail / sizeof(progsave_state_T)
+	    || (size_t)rs.rs_nstate > ((size_t)-1 - sizeof(nfa_regprog_T))
+							 / sizeof(nfa_state_T)
+	    || avail != (size_t)rs.rs_nstate * sizeof(progsave_state_T)
+	    || rs.rs_start < 0 || rs.rs_start >= rs.rs_nstate
+	    || (rs.rs_re_engine != AUTOMATIC_ENGINE
+		&& rs.rs_re_engine != NFA_ENGINE
+		&& rs.rs_re_engine != BITPARALLEL_ENGINE)
+	    || (rs.rs_regflags & ~(RF_ICASE | RF_NOICASE | RF_HASNL
+			       | RF_ICOMBINE | RF_LOOKBH | RF_VOLATILE)) != 0
+	    || rs.rs_regstart < 0
+	    || rs.rs_nsubexp < 1 || rs.rs_nsubexp > NSUBEXP
+	    || (rs.rs_reghasz & ~REX_ALL) != 0
+	    || (rs.rs_reganch & ~1) != 0 || (rs.rs_has_zend & ~1) != 0
+	    || (rs.rs_has_backref & ~1) != 0 || (rs.rs_dfa_usable & ~1) != 0
+	    || (rs.rs_had_eol & ~1) != 0)
+	return NULL;
+
+    prog = alloc(sizeof(nfa_regprog_T)
+				 + sizeof(nfa_state_T) * (rs.rs_nstate - 1));
+    if (prog == NULL)
+	return NULL;
+    vim_memset(prog, 0, sizeof(nfa_regprog_T));
+    text = p + sizeof(progsave_T) + rs.rs_patlen;
+    if (rs.rs_match_len >= 0)
+    {
+	prog->match_text = vim_strnsave(text, rs.rs_match_len);
+	text += rs.rs_match_len;
+    }
+    if (rs.rs_must_len >= 0)
+    {
+	prog->must_text = vim_strnsave(text, rs.rs_must_len);
+	prog->must_len = rs.rs_must_len;
+	text += rs.rs_must_len;
+    }
+    for (i = 0; i < rs.rs_nstate; ++i)
+    {
+	mch_memmove(&rss, text, sizeof(progsave_state_T));
+	text += sizeof(progsave_state_T);
+	if (rss.rss_out < -1 || rss.rss_out >= rs.rs_nstate
+		|| rss.rss_out1 < -1 || rss.rss_out1 >= rs.rs_nstate)
+	    break;
+	s = &prog->state[i];
+	s->c = rss.rss_c;
+	s->out = rss.rss_out < 0 ? NULL : &prog->state[rss.rss_out];
+	s->out1 = rss.rss_out1 < 0 ? NULL : &prog->state[rss.rss_out1];
+	s->id = i + 1;
+	s->lastlist[0] = 0;
+	s->lastlist[1] = 0;
+	s->val = rss.rss_val;
+    }
+    // The pattern without the "\%#=" prefix, like nfa_regcomp() gets it.
+    prog->pattern = vim_strsave(STRNCMP(expr, "\\%#=", 4) == 0
+							? expr + 5 : expr);
+    prog->nstate = rs.rs_nstate;
+    prog->nsubexp = rs.rs_nsubexp;
+    prog->reghasz = rs.rs_reghasz;
+    if (i < rs.rs_nstate || prog->pattern == NULL
+	    || (rs.rs_match_len >= 0 && prog->match_text == NULL)
+	    || (rs.rs_must_len >= 0 && prog->must_text == NULL)
+	    || progsave_check(prog) == FAIL)
+    {
+	nfa_regfree((regprog_T *)prog);
+	return NULL;
+    }
+
+    prog->engine = &nfa_regengine;
+    prog->regflags = rs.rs_regflags;
+    prog->re_engine = rs.rs_re_engine;
+    prog->re_flags = re_flags;
+    prog->re_in_use = FALSE;
+    prog->re_refcount = 1;
+    prog->start = &prog->state[rs.rs_start];
+    prog->reganch = rs.rs_reganch;
+    prog->regstart = rs.rs_regstart;
+    prog->has_zend = rs.rs_has_zend;
+    prog->has_backref = rs.rs_has_backref;
+    prog->dfa_usable = rs.rs_dfa_usable;
+    if (prog->re_engine == AUTOMATIC_ENGINE
+				     || prog->re_engine == BITPARALLEL_ENGINE)
+	nfa_bp_compile(prog);
+# ifdef FEAT_PROFILE
+    prog->re_expr = vim_strsave(expr);
+# endif
+    had_eol = rs.rs_had_eol;
+    return (regprog_T *)prog;
+}
+#endif
+
 #if defined(EXITFREE) || defined(PROTO)
     void
 free_regexp_stuff(void)
 {
+    int	    i;
+
+    for (i = 0; i < REGCACHE_SIZE; ++i)
+	if (regcache[i].rc_prog != NULL)
+	{
+	    vim_free(regcache[i].rc_pattern);
+	    vim_regfree(regcache[i].rc_prog);
+	    regcache[i].rc_prog = NULL;
+	}
+# ifdef FEAT_PROFILE
+    regtime_clear();
+# endif
     ga_clear(&regstack);
     ga_clear(&backpos);
     vim_free(reg_tofree);
@@ -2664,6 +3787,47 @@ free_regexp_stuff(void)
 }
 #endif
 
+#if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * "regexpcacheinfo()" function
+ */
+    void
+f_regexpcacheinfo(typval_T *argvars UNUSED, typval_T *rettv)
+{
+    dict_T	*dict;
+    dict_T	*d;
+    list_T	*list;
+    int		count = 0;
+    int		i;
+
+    if (rettv_dict_alloc(rettv) == FAIL)
+	return;
+    dict = rettv->vval.v_dict;
+    list = list_alloc();
+    if (list == NULL)
+	return;
+    for (i = 0; i < REGCACHE_SIZE; ++i)
+	if (regcache[i].rc_prog != NULL)
+	{
+	    ++count;
+	    d = dict_alloc();
+	    if (d == NULL)
+		break;
+	    list_append_dict(list, d);
+	    dict_add_string(d, "pattern", regcache[i].rc_pattern);
+	    // Do not count the reference of the cache itself.
+	    dict_add_number(d, "refcount",
+				       (long)regcache[i].rc_prog->re_refcount - 1);
+	}
+    dict_add_list(dict, "entries", list);
+    dict_add_number(dict, "size", REGCACHE_SIZE);
+    dict_add_number(dict, "count", count);
+    dict_add_number(dict, "lookups", regcache_lookups);
+    dict_add_number(dict, "hits", regcache_hits);
+    dict_add_number(dict, "compiles", regcache_compiles);
+}
+#endif
+
 #ifdef FEAT_EVAL
     static void
 report_re_switch(char_u *pat)
@@ -2678,6 +3842,269 @@ report_re_switch(char_u *pat)
 }
 #endif
 
+#if defined(FEAT_PROFILE) || defined(PROTO)
+/*
+ * Timing of matching patterns for ":regtime", one entry for each pattern
+ * string.
+ */
+typedef struct
+{
+    long	rt_count;	// number of times the pattern was used
+    long	rt_match;	// number of times it matched
+    long	rt_fallback;	// number of times the NFA engine was too
+				// expensive and the old engine was used
+    proftime_T	rt_total;	// total time spent matching
+    proftime_T	rt_slowest;	// slowest match
+    char	*rt_engine;	// engine used the last time
+    char_u	rt_pattern[1];	// the pattern, actually longer
+} regtime_T;
+
+#define RT_KEY_OFF	offsetof(regtime_T, rt_pattern)
+#define HI2RT(hi)	((regtime_T *)((hi)->hi_key - RT_KEY_OFF))
+
+static int	    regtime_on = FALSE;
+static hashtab_T    regtime_ht;
+static int	    regtime_ht_init = FALSE;
+
+/*
+ * Return the entry for the pattern of "prog", adding it when needed.
+ * Returns NULL when out of memory.
+ */
+    static regtime_T *
+regtime_find(regprog_T *prog)
+{
+    hashitem_T	*hi;
+    hash_T	hash;
+    regtime_T	*rt;
+
+    if (prog->re_expr == NULL)
+	return NULL;
+    if (!regtime_ht_init)
+    {
+	hash_init(&regtime_ht);
+	regtime_ht_init = TRUE;
+    }
+    hash = hash_hash(prog->re_expr);
+    hi = hash_lookup(&regtime_ht, prog->re_expr, hash);
+    if (!HASHITEM_EMPTY(hi))
+	return HI2RT(hi);
+
+    rt = alloc_clear(sizeof(regtime_T) + STRLEN(prog->re_expr));
+    if (rt == NULL)
+	return NULL;
+    STRCPY(rt->rt_pattern, prog->re_expr);
+    if (hash_add_item(&regtime_ht, hi, rt->rt_pattern, hash) == FAIL)
+    {
+	vim_free(rt);
+	return NULL;
+    }
+    return rt;
+}
+
+/*
+ * Add the time passed since "start" to "rt".  "prog" is the program that was
+ * used last, it may be NULL.
+ */
+    static void
+regtime_add(regtime_T *rt, proftime_T *start, regprog_T *prog, int match)
+{
+    profile_end(start);
+    profile_add(&rt->rt_total, start);
+    if (profile_cmp(start, &rt->rt_slowest) < 0)
+	rt->rt_slowest = *start;
+    ++rt->rt_count;
+    if (match)
+	++rt->rt_match;
+    if (prog == NULL)
+	rt->rt_engine = "";
+    else if (prog->engine == &bt_regengine)
+	rt->rt_engine = "backtracking";
+    else if (((nfa_regprog_T *)prog)->bp != NULL)
+	rt->rt_engine = "bitparallel";
+    else
+	rt->rt_engine = "nfa";
+}
+
+    static void
+regtime_clear(void)
+{
+    if (regtime_ht_init)
+    {
+	hash_clear_all(&regtime_ht, RT_KEY_OFF);
+	regtime_ht_init = FALSE;
+    }
+}
+
+    static int
+regtime_compare(const void *v1, const void *v2)
+{
+    regtime_T	*rt1 = *(regtime_T **)v1;
+    regtime_T	*rt2 = *(regtime_T **)v2;
+
+    return profile_cmp(&rt1->rt_total, &rt2->rt_total);
+}
+
+/*
+ * Return an allocated array with the entries, sorted on total time, slowest
+ * first.  "*countp" is set to the number of entries.
+ */
+    static regtime_T **
+regtime_sorted(int *countp)
+{
+    regtime_T	**list;
+    hashitem_T	*hi;
+    int		todo;
+    int		count = 0;
+
+    *countp = 0;
+    if (!regtime_ht_init || regtime_ht.ht_used == 0)
+	return NULL;
+    list = ALLOC_MULT(regtime_T *, regtime_ht.ht_used);
+    if (list == NULL)
+	return NULL;
+    todo = (int)regtime_ht.ht_used;
+    for (hi = regtime_ht.ht_array; todo > 0; ++hi)
+	if (!HASHITEM_EMPTY(hi))
+	{
+	    list[count++] = HI2RT(hi);
+	    --todo;
+	}
+    qsort((void *)list, (size_t)count, sizeof(regtime_T *), regtime_compare);
+    *countp = count;
+    return list;
+}
+
+    static void
+regtime_report(void)
+{
+    regtime_T	**list;
+    regtime_T	*rt;
+    int		count;
+    int		idx;
+    int		len;
+# ifdef FEAT_FLOAT
+    proftime_T	tm;
+# endif
+    proftime_T	total_total;
+    long	total_count = 0;
+
+    list = regtime_sorted(&count);
+    if (list == NULL)
+    {
+	msg(_("No patterns were matched"));
+	return;
+    }
+
+    profile_zero(&total_total);
+    msg_puts_title(_("  TOTAL      COUNT  MATCH   SLOWEST     AVERAGE   FALLBACK  ENGINE        PATTERN"));
+    msg_puts("\n");
+    for (idx = 0; idx < count && !got_int; ++idx)
+    {
+	rt = list[idx];
+	profile_add(&total_total, &rt->rt_total);
+	total_count += rt->rt_count;
+
+	msg_puts(profile_msg(&rt->rt_total));
+	msg_puts(" "); // make sure there is always a separating space
+	msg_advance(13);
+	msg_outnum(rt->rt_count);
+	msg_puts(" ");
+	msg_advance(20);
+	msg_outnum(rt->rt_match);
+	msg_puts(" ");
+	msg_advance(26);
+	msg_puts(profile_msg(&rt->rt_slowest));
+	msg_puts(" ");
+	msg_advance(38);
+# ifdef FEAT_FLOAT
+	profile_divide(&rt->rt_total, (int)rt->rt_count, &tm);
+	msg_puts(profile_msg(&tm));
+	msg_puts(" ");
+# endif
+	msg_advance(50);
+	msg_outnum(rt->rt_fallback);
+	msg_puts(" ");
+	msg_advance(60);
+	msg_puts(rt->rt_engine);
+	msg_puts(" ");
+
+	msg_advance(74);
+	if (Columns < 80)
+	    len = 20; // will wrap anyway
+	else
+	    len = Columns - 75;
+	if (len > (int)STRLEN(rt->rt_pattern))
+	    len = (int)STRLEN(rt->rt_pattern);
+	msg_outtrans_len(rt->rt_pattern, len);
+	msg_puts("\n");
+    }
+    vim_free(list);
+    if (!got_int)
+    {
+	msg_puts("\n");
+	msg_puts(profile_msg(&total_total));
+	msg_advance(13);
+	msg_outnum(total_count);
+	msg_puts("\n");
+    }
+}
+
+/*
+ * ":regtime {on,off,clear,report}"
+ */
+    void
+ex_regtime(exarg_T *eap)
+{
+    if (STRCMP(eap->arg, "on") == 0)
+	regtime_on = TRUE;
+    else if (STRCMP(eap->arg, "off") == 0)
+	regtime_on = FALSE;
+    else if (STRCMP(eap->arg, "clear") == 0)
+	regtime_clear();
+    else if (STRCMP(eap->arg, "report") == 0)
+	regtime_report();
+    else
+	semsg(_(e_invarg2), eap->arg);
+}
+
+# if defined(FEAT_EVAL) || defined(PROTO)
+/*
+ * "regtimeinfo()" function
+ */
+    void
+f_regtimeinfo(typval_T *argvars UNUSED, typval_T *rettv)
+{
+    regtime_T	**list;
+    regtime_T	*rt;
+    dict_T	*d;
+    int		count;
+    int		idx;
+
+    if (rettv_list_alloc(rettv) == FAIL)
+	return;
+    list = regtime_sorted(&count);
+    for (idx = 0; idx < count; ++idx)
+    {
+	rt = list[idx];
+	d = dict_alloc();
+	if (d == NULL)
+	    break;
+	list_append_dict(rettv->vval.v_list, d);
+	dict_add_string(d, "pattern", rt->rt_pattern);
+	dict_add_number(d, "count", rt->rt_count);
+	dict_add_number(d, "match", rt->rt_match);
+	dict_add_number(d, "fallback", rt->rt_fallback);
+	dict_add_string(d, "engine", (char_u *)rt->rt_engine);
+#  ifdef FEAT_FLOAT
+	dict_add_float(d, "total", profile_float(&rt->rt_total));
+	dict_add_float(d, "slowest", profile_float(&rt->rt_slowest));
+#  endif
+    }
+    vim_free(list);
+}
+# endif
+#endif
+
 #if (defined(FEAT_X11) && (defined(FEAT_TITLE) || defined(FEAT_XCLIPBOARD))) \
 	|| defined(PROTO)
 /*
@@ -2709,6 +4136,10 @@ vim_regexec_string(
     int		result;
     regexec_T	rex_save;
     int		rex_in_use_save = rex_in_use;
+#ifdef FEAT_PROFILE
+    regtime_T	*rt = NULL;
+    proftime_T	pt;
+#endif
 
     // Cannot use the same prog recursively, it contains state.
     if (rmp->regprog->re_in_use)
@@ -2717,6 +4148,13 @@ vim_regexec_string(
 	return FALSE;
     }
     rmp->regprog->re_in_use = TRUE;
+#ifdef FEAT_PROFILE
+    if (regtime_on)
+    {
+	rt = regtime_find(rmp->regprog);
+	profile_start(&pt);
+    }
+#endif
 
     if (rex_in_use)
 	// Being called recursively, save the state.
@@ -2741,6 +4179,10 @@ vim_regexec_string(
 
 	p_re = BACKTRACKING_ENGINE;
 	vim_regfree(rmp->regprog);
+#ifdef FEAT_PROFILE
+	if (rt != NULL)
+	    ++rt->rt_fallback;
+#endif
 	if (pat != NULL)
 	{
 #ifdef FEAT_EVAL
@@ -2758,6 +4200,10 @@ vim_regexec_string(
 
 	p_re = save_p_re;
     }
+#ifdef FEAT_PROFILE
+    if (rt != NULL)
+	regtime_add(rt, &pt, rmp->regprog, result > 0);
+#endif
 
     rex_in_use = rex_in_use_save;
     if (rex_in_use)
@@ -2830,6 +4276,10 @@ vim_regexec_multi(
     int		result;
     regexec_T	rex_save;
     int		rex_in_use_save = rex_in_use;
+#ifdef FEAT_PROFILE
+    regtime_T	*rt = NULL;
+    proftime_T	pt;
+#endif
 
     // Cannot use the same prog recursively, it contains state.
     if (rmp->regprog->re_in_use)
@@ -2838,6 +4288,13 @@ vim_regexec_multi(
 	return FALSE;
     }
     rmp->regprog->re_in_use = TRUE;
+#ifdef FEAT_PROFILE
+    if (regtime_on)
+    {
+	rt = regtime_find(rmp->regprog);
+	profile_start(&pt);
+    }
+#endif
 
     if (rex_in_use)
 	// Being called recursively, save the state.
@@ -2858,6 +4315,10 @@ vim_regexec_multi(
 
 	p_re = BACKTRACKING_ENGINE;
 	vim_regfree(rmp->regprog);
+#ifdef FEAT_PROFILE
+	if (rt != NULL)
+	    ++rt->rt_fallback;
+#endif
 	if (pat != NULL)
 	{
 #ifdef FEAT_EVAL
@@ -2884,6 +4345,10 @@ vim_regexec_multi(
 	}
 	p_re = save_p_re;
     }
+#ifdef FEAT_PROFILE
+    if (rt != NULL)
+	regtime_add(rt, &pt, rmp->regprog, result > 0);
+#endif
 
     rex_in_use = rex_in_use_save;
     if (rex_in_use)
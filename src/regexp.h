@@ -38,6 +38,7 @@
 #define	    AUTOMATIC_ENGINE	0
 #define	    BACKTRACKING_ENGINE	1
 #define	    NFA_ENGINE		2
+#define	    BITPARALLEL_ENGINE	3
 
 typedef struct regengine regengine_T;
 
@@ -53,6 +54,12 @@ typedef struct regprog
     unsigned		re_engine;   // automatic, backtracking or nfa engine
     unsigned		re_flags;    // second argument for vim_regcomp()
     int			re_in_use;   // prog is being executed
+    int			re_refcount; // number of references, including the
+				     // cache, see vim_regfree()
+#ifdef FEAT_PROFILE
+    char_u		*re_expr;    // pattern as given to vim_regcomp(),
+				     // for ":regtime"
+#endif
 } regprog_T;
 
 /*
@@ -68,6 +75,10 @@ typedef struct
     unsigned		re_engine;
     unsigned		re_flags;
     int			re_in_use;
+    int			re_refcount;
+#ifdef FEAT_PROFILE
+    char_u		*re_expr;
+#endif
 
     int			regstart;
     char_u		reganch;
@@ -94,6 +105,12 @@ struct nfa_state
     int			val;
 };
 
+// Lazily built DFA, defined in regexp_nfa.c.
+typedef struct nfa_dfa nfa_dfa_T;
+
+// Bit-parallel matcher, defined in regexp_nfa.c.
+typedef struct nfa_bp nfa_bp_T;
+
 /*
  * Structure used by the NFA matcher.
  */
@@ -105,12 +122,18 @@ typedef struct
     unsigned		re_engine;
     unsigned		re_flags;
     int			re_in_use;
+    int			re_refcount;
+#ifdef FEAT_PROFILE
+    char_u		*re_expr;
+#endif
 
     nfa_state_T		*start;		// points into state[]
 
     int			reganch;	// pattern starts with ^
     int			regstart;	// char at start of pattern
     char_u		*match_text;	// plain text to match with
+    char_u		*must_text;	// literal text every match contains
+    int			must_len;	// length of "must_text"
 
     int			has_zend;	// pattern contains \ze
     int			has_backref;	// pattern contains \1 .. \9
@@ -119,6 +142,10 @@ typedef struct
 #endif
     char_u		*pattern;
     int			nsubexp;	// number of ()
+    int			dfa_usable;	// the lazy DFA can be used
+    nfa_dfa_T		*dfa;		// lazy DFA, NULL when not used yet
+    nfa_bp_T		*bp;		// bit-parallel matcher, NULL when it
+					// cannot be used
     int			nstate;
     nfa_state_T		state[1];	// actually longer..
 } nfa_regprog_T;
@@ -164,6 +191,20 @@ typedef struct
     char_u		*matches[NSUBEXP];
 } reg_extmatch_T;
 
+/*
+ * Used to save the state of regexp_timeout_start().
+ */
+typedef struct
+{
+#ifdef FEAT_RELTIME
+    proftime_T		rt_tm;
+    int			rt_active;
+    int			rt_timed_out;
+#else
+    int			rt_dummy;
+#endif
+} regtimeout_T;
+
 struct regengine
 {
     regprog_T	*(*regcomp)(char_u*, int);
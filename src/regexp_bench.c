@@ -0,0 +1,353 @@
+/* vi:set ts=8 sts=4 sw=4 noet:
+ *
+ * VIM - Vi IMproved	by Bram Moolenaar
+ *
+ * Do ":help uganda"  in Vim to read copying and usage conditions.
+ * Do ":help credits" in Vim to see a list of people who contributed.
+ * See README.txt for an overview of the Vim source code.
+ */
+
+/*
+ * regexp_bench.c: Benchmarks for the regexp engines
+ *
+ * Matches a fixed set of patterns against every line of generated text that
+ * looks like source code, a log file and UTF-8 prose, with each engine.
+ * Reports the throughput and the number of matching lines, which must be the
+ * same for all engines.  Run with "make bench_regexp", optionally with
+ * BENCH_REGEXP_LINES set to the number of lines of each text.
+ */
+
+// Must include main.c because it contains much more than just main()
+#define NO_VIM_MAIN
+#include "main.c"
+
+#if defined(FEAT_RELTIME) && defined(FEAT_FLOAT)
+
+static long_u	    bench_seed;
+
+/*
+ * Return a number between 0 and "max" - 1.  A simple linear congruential
+ * generator is used, so that every run uses the same text.
+ */
+    static int
+bench_rand(int max)
+{
+    bench_seed = bench_seed * 1103515245UL + 12345UL;
+    return (int)((bench_seed >> 8) % (long_u)max);
+}
+
+#define BENCH_LEN(a)	((int)(sizeof(a) / sizeof((a)[0])))
+#define PICK(a)		(a)[bench_rand(BENCH_LEN(a))]
+
+static char *names[] = {"buf", "lnum", "user_id", "count", "ptr", "len",
+			"retval", "session_id", "idx", "node"};
+
+// Each line is formatted with the same arguments: a variable name "v", two
+// other names "a" and "b", "v" again and a number.
+static char *source_lines[] = {
+    "    static int",
+    "%s_check(char_u *%s, int %s)",
+    "{",
+    "    int\t\t%s = 0;",
+    "    // TODO: check %s before using it",
+    "    if (%s == NULL)",
+    "\treturn FAIL;",
+    "    for (%s = 0; %s < %s; ++%s)",
+    "\t%s += %s[%s];",
+    "    %s = %s(%s, %s, %s);  // FIXME: may overflow",
+    "    return %s;",
+    "}",
+    "",
+};
+
+static char *log_levels[] = {"INFO", "INFO", "INFO", "DEBUG", "WARN",
+								     "ERROR"};
+static char *log_parts[] = {"http", "db", "cache", "auth", "scheduler"};
+static char *log_msgs[] = {
+    "request GET /api/v1/users/%d took %d ms",
+    "connection from 10.0.%d.%d closed",
+    "query failed: timeout after %d.%d seconds",
+    "user %d logged in from 192.168.%d.%d",
+    "cache miss for key session_%d (%d entries)",
+};
+
+static char *prose_words[] = {
+    "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog",
+    "caf\303\251", "na\303\257ve", "gr\303\274\303\237e", "\303\274ber",
+    "stra\303\237e", "\316\261\316\273\317\206\316\254",
+    "\316\262\316\256\317\204\316\261", "\320\274\320\270\321\200",
+    "\346\227\245\346\234\254\350\252\236", "\346\226\207\345\255\227",
+    "na\303\257ve", "the", "and", "of", "\342\202\254%d",
+};
+
+/*
+ * Fill "buf" with "lines" lines of source code.
+ */
+    static void
+bench_source(buf_T *buf, long lines)
+{
+    char_u  line[200];
+    char    num[20];
+    long    n;
+    char    *fmt;
+    char    *v = NULL;
+    char    *a;
+    char    *b;
+
+    for (n = 0; n < lines; ++n)
+    {
+	fmt = source_lines[n % BENCH_LEN(source_lines)];
+	if (n % BENCH_LEN(source_lines) == 0)
+	    v = PICK(names);
+	a = PICK(names);
+	b = PICK(names);
+	vim_snprintf(num, sizeof(num), "%d", bench_rand(100));
+	vim_snprintf((char *)line, sizeof(line), fmt, v, a, b, v, num);
+	ml_append_buf(buf, (linenr_T)n, line, (colnr_T)0, FALSE);
+    }
+}
+
+/*
+ * Fill "buf" with "lines" lines of a log file.
+ */
+    static void
+bench_log(buf_T *buf, long lines)
+{
+    char_u  line[300];
+    char_u  msgbuf[200];
+    long    n;
+    char    *fmt;
+    int	    r1, r2, r3;
+    char    *level;
+    char    *part;
+
+    for (n = 0; n < lines; ++n)
+    {
+	// Every message format uses up to three numbers.
+	fmt = PICK(log_msgs);
+	r1 = bench_rand(100000);
+	r2 = bench_rand(1000);
+	r3 = bench_rand(256);
+	vim_snprintf((char *)msgbuf, sizeof(msgbuf), fmt, r1, r2, r3);
+	r1 = bench_rand(1000);
+	level = PICK(log_levels);
+	part = PICK(log_parts);
+	vim_snprintf((char *)line, sizeof(line),
+		"2021-%02d-%02d %02d:%02d:%02d.%03d [%s] %s: %s",
+		(int)(n / 100000) % 12 + 1, (int)(n / 4000) % 28 + 1,
+		(int)(n / 3600) % 24, (int)(n / 60) % 60, (int)(n % 60),
+		r1, level, part, msgbuf);
+	ml_append_buf(buf, (linenr_T)n, line, (colnr_T)0, FALSE);
+    }
+}
+
+/*
+ * Fill "buf" with "lines" lines of UTF-8 prose.
+ */
+    static void
+bench_prose(buf_T *buf, long lines)
+{
+    char_u  line[400];
+    char_u  word[40];
+    int	    len;
+    int	    words;
+    long    n;
+
+    for (n = 0; n < lines; ++n)
+    {
+	len = 0;
+	for (words = 4 + bench_rand(12); words > 0; --words)
+	{
+	    char *fmt = PICK(prose_words);
+
+	    vim_snprintf((char *)word, sizeof(word), fmt, bench_rand(100));
+	    len += vim_snprintf((char *)line + len, sizeof(line) - len,
+					   "%s%s", len == 0 ? "" : " ", word);
+	}
+	// Now and then repeat the last word, for the back reference.
+	if (n % 7 == 0)
+	    vim_snprintf((char *)line + len, sizeof(line) - len, " %s.",
+									 word);
+	ml_append_buf(buf, (linenr_T)n, line, (colnr_T)0, FALSE);
+    }
+}
+
+typedef struct
+{
+    char    *name;	// name of the text
+    void    (*fill)(buf_T *, long);
+} corpus_T;
+
+static corpus_T corpora[] = {
+    {"source code", bench_source},
+    {"log", bench_log},
+    {"UTF-8 prose", bench_prose},
+};
+
+typedef struct
+{
+    char    *name;	// kind of pattern
+    char    *pat;	// the pattern
+} benchpat_T;
+
+static benchpat_T patterns[] = {
+    {"literal",		"return"},
+    {"literal",		"ERROR"},
+    {"ignore case",	"\\cuser"},
+    {"class",		"[0-9]\\+\\.[0-9]\\+"},
+    {"word",		"\\<\\h\\w*_id\\>"},
+    {"alternation",	"TODO\\|FIXME\\|WARN\\|ERROR"},
+    {"multi-line",	"NULL)\\n\\s*return"},
+    {"multi-line",	"{\\_s*int"},
+    {"back reference",	"\\(\\<\\k\\+\\>\\) \\1"},
+    {"multibyte",	"[\303\244\303\266\303\274\303\237]\\w*"},
+    {"complex",		"\\v(\\w+\\s+){3}\\d+"},
+};
+
+typedef struct
+{
+    char    *name;	// engine name
+    char    *prefix;	// pattern prefix to select it
+} engine_T;
+
+static engine_T engines[] = {
+    {"backtracking", "\\%#=1"},
+    {"nfa", "\\%#=2"},
+    {"bitparallel", "\\%#=3"},
+};
+
+#define ENGINE_COUNT	BENCH_LEN(engines)
+
+/*
+ * Match "pat" with engine "engine" against every line of "buf".
+ * Returns the number of matching lines, -1 when the pattern can't be
+ * compiled.  "*secs" is set to the time spent.
+ */
+    static long
+bench_match(buf_T *buf, char *pat, engine_T *engine, float_T *secs)
+{
+    char_u	patbuf[200];
+    regmmatch_T	regmatch;
+    linenr_T	lnum;
+    long	count = 0;
+    proftime_T	tm;
+
+    vim_snprintf((char *)patbuf, sizeof(patbuf), "%s%s", engine->prefix,
+									  pat);
+    profile_start(&tm);
+    regmatch.regprog = vim_regcomp(patbuf, RE_MAGIC);
+    if (regmatch.regprog == NULL)
+	return -1;
+    regmatch.rmm_ic = FALSE;
+    regmatch.rmm_maxcol = 0;
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count; ++lnum)
+    {
+	if (vim_regexec_multi(&regmatch, NULL, buf, lnum, (colnr_T)0,
+							     NULL, NULL) > 0)
+	    ++count;
+	if (regmatch.regprog == NULL)
+	    break;
+    }
+    vim_regfree(regmatch.regprog);
+    profile_end(&tm);
+    *secs = profile_float(&tm);
+    return count;
+}
+
+/*
+ * Run all patterns with all engines on the text of "corpus".
+ * Returns the number of patterns for which the engines did not agree.
+ */
+    static int
+bench_corpus(corpus_T *corpus, long lines)
+{
+    buf_T	*buf;
+    linenr_T	lnum;
+    long	bytes = 0;
+    float_T	mbytes;
+    float_T	secs;
+    long	count[ENGINE_COUNT];
+    int		p;
+    int		e;
+    int		mismatch = 0;
+
+    buf = buflist_new(NULL, NULL, (linenr_T)1, BLN_LISTED);
+    if (buf == NULL || ml_open(buf) == FAIL)
+    {
+	printf("  cannot create a buffer\n");
+	return 0;
+    }
+    // Patterns are compiled for the current buffer.
+    curbuf = buf;
+    buf_init_chartab(buf, FALSE);
+    bench_seed = 1;
+    corpus->fill(buf, lines);
+    for (lnum = 1; lnum <= buf->b_ml.ml_line_count; ++lnum)
+	bytes += ml_get_buf_len(buf, lnum) + 1;
+    mbytes = (float_T)bytes / (1024.0 * 1024.0);
+
+    printf("%s: %ld lines, %.1f Mbyte, Mbyte/s:\n", corpus->name,
+				   (long)buf->b_ml.ml_line_count, (double)mbytes);
+    printf("  %-15s %-28s", "pattern", "");
+    for (e = 0; e < ENGINE_COUNT; ++e)
+	printf(" %12s", engines[e].name);
+    printf(" %8s\n", "lines");
+
+    for (p = 0; p < BENCH_LEN(patterns); ++p)
+    {
+	printf("  %-15s %-28s", patterns[p].name, patterns[p].pat);
+	fflush(stdout);
+	for (e = 0; e < ENGINE_COUNT; ++e)
+	{
+	    count[e] = bench_match(buf, patterns[p].pat, &engines[e], &secs);
+	    if (count[e] < 0)
+		printf(" %12s", "error");
+	    else
+		printf(" %12.1f", (double)(mbytes / secs));
+	    fflush(stdout);
+	}
+	printf(" %8ld", count[0]);
+	for (e = 1; e < ENGINE_COUNT; ++e)
+	    if (count[e] != count[0])
+	    {
+		printf(" MISMATCH: %s %ld", engines[e].name, count[e]);
+		++mismatch;
+	    }
+	printf("\n");
+    }
+
+    ml_close(buf, TRUE);
+    curbuf = firstbuf;
+    return mismatch;
+}
+
+    int
+main(int argc, char **argv)
+{
+    long	lines = 100000L;
+    int		i;
+    int		mismatch = 0;
+
+    vim_memset(&params, 0, sizeof(params));
+    params.argc = 1;
+    params.argv = argv;
+    common_init(&params);
+    set_option_value((char_u *)"encoding", 0L, (char_u *)"utf-8", 0);
+
+    if (argc > 1)
+	lines = atol(argv[1]);
+    for (i = 0; i < BENCH_LEN(corpora); ++i)
+	mismatch += bench_corpus(&corpora[i], lines);
+    return mismatch > 0 ? 1 : 0;
+}
+
+#else
+
+    int
+main(void)
+{
+    printf("regexp_bench needs the +reltime and +float features\n");
+    return 0;
+}
+
+#endif
@@ -1346,18 +1346,22 @@ regatom(int *flagp)
 		// pattern -- regardless of whether or not it makes sense.
 		case '^':
 		    ret = regnode(RE_BOF);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case '$':
 		    ret = regnode(RE_EOF);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case '#':
 		    ret = regnode(CURSOR);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case 'V':
 		    ret = regnode(RE_VISUAL);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case 'C':
@@ -1480,6 +1484,7 @@ regatom(int *flagp)
 				  // "\%'m", "\%<'m" and "\%>'m": Mark
 				  c = getchr();
 				  ret = regnode(RE_MARK);
+				  regflags |= RF_VOLATILE;
 				  if (ret == JUST_CALC_SIZE)
 				      regsize += 2;
 				  else
@@ -1494,13 +1499,17 @@ regatom(int *flagp)
 				  if (c == 'l')
 				  {
 				      ret = regnode(RE_LNUM);
+				      regflags |= RF_VOLATILE;
 				      if (save_prev_at_start)
 					  at_start = TRUE;
 				  }
 				  else if (c == 'c')
 				      ret = regnode(RE_COL);
 				  else
+				  {
 				      ret = regnode(RE_VCOL);
+				      regflags |= RF_VOLATILE;
+				  }
 				  if (ret == JUST_CALC_SIZE)
 				      regsize += 5;
 				  else
@@ -3043,9 +3052,7 @@ restore_subexpr(regbehind_T *bp)
  */
     static int
 regmatch(
-    char_u	*scan,		    // Current node.
-    proftime_T	*tm UNUSED,	    // timeout limit or NULL
-    int		*timed_out UNUSED)  // flag set on timeout or NULL
+    char_u	*scan)		// Current node.
 {
   char_u	*next;		// Next node.
   int		op;
@@ -3053,9 +3060,6 @@ regmatch(
   regitem_T	*rp;
   int		no;
   int		status;		// one of the RA_ values:
-#ifdef FEAT_RELTIME
-  int		tm_count = 0;
-#endif
 
   // Make "regstack" and "backpos" empty.  They are allocated and freed in
   // bt_regexec_both() to reduce malloc()/free() calls.
@@ -3065,10 +3069,6 @@ regmatch(
   // Repeat until "regstack" is empty.
   for (;;)
   {
-    // Some patterns may take a long time to match, e.g., "\([a-z]\+\)\+Q".
-    // Allow interrupting them with CTRL-C.
-    fast_breakcheck();
-
 #ifdef DEBUG
     if (scan != NULL && regnarrate)
     {
@@ -3081,25 +3081,14 @@ regmatch(
     // regstack.
     for (;;)
     {
-	if (got_int || scan == NULL)
+	// Some patterns may take a long time to match, e.g.,
+	// "\([a-z]\+\)\+Q".  Allow interrupting them with CTRL-C and stop
+	// at the time limit.
+	if (scan == NULL || reg_check_abort())
 	{
 	    status = RA_FAIL;
 	    break;
 	}
-#ifdef FEAT_RELTIME
-	// Check for timeout once in a 100 times to avoid overhead.
-	if (tm != NULL && ++tm_count == 100)
-	{
-	    tm_count = 0;
-	    if (profile_passed_limit(tm))
-	    {
-		if (timed_out != NULL)
-		    *timed_out = TRUE;
-		status = RA_FAIL;
-		break;
-	    }
-	}
-#endif
 	status = RA_CONT;
 
 #ifdef DEBUG
@@ -4519,9 +4508,7 @@ regmatch(
     static long
 regtry(
     bt_regprog_T	*prog,
-    colnr_T		col,
-    proftime_T		*tm,		// timeout limit or NULL
-    int			*timed_out)	// flag set on timeout or NULL
+    colnr_T		col)
 {
     rex.input = rex.line + col;
     rex.need_clear_subexpr = TRUE;
@@ -4530,7 +4517,7 @@ regtry(
     rex.need_clear_zsubexpr = (prog->reghasz == REX_SET);
 #endif
 
-    if (regmatch(prog->program + 1, tm, timed_out) == 0)
+    if (regmatch(prog->program + 1) == 0)
 	return 0;
 
     cleanup_subexpr();
@@ -4602,14 +4589,18 @@ regtry(
     static long
 bt_regexec_both(
     char_u	*line,
-    colnr_T	col,		// column to start looking for match
-    proftime_T	*tm,		// timeout limit or NULL
-    int		*timed_out)	// flag set on timeout or NULL
+    colnr_T	col,			// column to start looking for match
+    proftime_T	*tm UNUSED,		// timeout limit or NULL
+    int		*timed_out UNUSED)	// flag set on timeout or NULL
 {
     bt_regprog_T    *prog;
     char_u	    *s;
     long	    retval = 0L;
 
+#ifdef FEAT_RELTIME
+    reg_set_time_limit(tm, timed_out);
+#endif
+
     // Create "regstack" and "backpos" if they are not allocated yet.
     // We allocate *_INITIAL amount of bytes first and then set the grow size
     // to much bigger value to avoid many malloc calls in case of deep regular
@@ -4669,42 +4660,50 @@ bt_regexec_both(
     if (prog->regflags & RF_ICOMBINE)
 	rex.reg_icombine = TRUE;
 
-    // If there is a "must appear" string, look for it.
+    // If there is a "must appear" string, look for it.  First try the fast
+    // byte-wise search.
     if (prog->regmust != NULL)
     {
 	int c;
+	int found;
 
-	if (has_mbyte)
-	    c = (*mb_ptr2char)(prog->regmust);
-	else
-	    c = *prog->regmust;
 	s = line + col;
-
-	// This is used very often, esp. for ":global".  Use three versions of
-	// the loop to avoid overhead of conditions.
-	if (!rex.reg_ic && !has_mbyte)
-	    while ((s = vim_strbyte(s, c)) != NULL)
-	    {
-		if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
-		    break;		// Found it.
-		++s;
-	    }
-	else if (!rex.reg_ic || (!enc_utf8 && mb_char2len(c) > 1))
-	    while ((s = vim_strchr(s, c)) != NULL)
-	    {
-		if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
-		    break;		// Found it.
-		MB_PTR_ADV(s);
-	    }
-	else
-	    while ((s = cstrchr(s, c)) != NULL)
-	    {
-		if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
-		    break;		// Found it.
-		MB_PTR_ADV(s);
-	    }
-	if (s == NULL)		// Not present.
+	found = reg_find_literal(s, prog->regmust, prog->regmlen);
+	if (found == FAIL)
 	    goto theend;
+	if (found == MAYBE)
+	{
+	    if (has_mbyte)
+		c = (*mb_ptr2char)(prog->regmust);
+	    else
+		c = *prog->regmust;
+
+	    // This is used very often, esp. for ":global".  Use three
+	    // versions of the loop to avoid overhead of conditions.
+	    if (!rex.reg_ic && !has_mbyte)
+		while ((s = vim_strbyte(s, c)) != NULL)
+		{
+		    if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
+			break;		// Found it.
+		    ++s;
+		}
+	    else if (!rex.reg_ic || (!enc_utf8 && mb_char2len(c) > 1))
+		while ((s = vim_strchr(s, c)) != NULL)
+		{
+		    if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
+			break;		// Found it.
+		    MB_PTR_ADV(s);
+		}
+	    else
+		while ((s = cstrchr(s, c)) != NULL)
+		{
+		    if (cstrncmp(s, prog->regmust, &prog->regmlen) == 0)
+			break;		// Found it.
+		    MB_PTR_ADV(s);
+		}
+	    if (s == NULL)		// Not present.
+		goto theend;
+	}
     }
 
     rex.line = line;
@@ -4726,17 +4725,14 @@ bt_regexec_both(
 		    && (((enc_utf8 && utf_fold(prog->regstart) == utf_fold(c)))
 			|| (c < 255 && prog->regstart < 255 &&
 			    MB_TOLOWER(prog->regstart) == MB_TOLOWER(c)))))
-	    retval = regtry(prog, col, tm, timed_out);
+	    retval = regtry(prog, col);
 	else
 	    retval = 0;
     }
     else
     {
-#ifdef FEAT_RELTIME
-	int tm_count = 0;
-#endif
 	// Messy cases:  unanchored match.
-	while (!got_int)
+	for (;;)
 	{
 	    if (prog->regstart != NUL)
 	    {
@@ -4761,7 +4757,7 @@ bt_regexec_both(
 		break;
 	    }
 
-	    retval = regtry(prog, col, tm, timed_out);
+	    retval = regtry(prog, col);
 	    if (retval > 0)
 		break;
 
@@ -4777,19 +4773,8 @@ bt_regexec_both(
 		col += (*mb_ptr2len)(rex.line + col);
 	    else
 		++col;
-#ifdef FEAT_RELTIME
-	    // Check for timeout once in a twenty times to avoid overhead.
-	    if (tm != NULL && ++tm_count == 20)
-	    {
-		tm_count = 0;
-		if (profile_passed_limit(tm))
-		{
-		    if (timed_out != NULL)
-			*timed_out = TRUE;
-		    break;
-		}
-	    }
-#endif
+	    if (reg_check_abort())
+		break;
 	}
     }
 
@@ -501,6 +501,216 @@ nfa_get_match_text(nfa_state_T *start)
     return ret;
 }
 
+// Maximum number of NFA states for finding the required literal text, it
+// takes time proportional to the square of the number of states.
+#define NFA_MUST_MAX_STATES	300
+
+/*
+ * Return TRUE if "c" is a character that nfa_get_must_text() can use.  In
+ * UTF-8 an illegal byte matches a character below 0x100, avoid those.
+ */
+    static int
+nfa_must_char(int c)
+{
+    if (c <= 0)
+	return FALSE;
+    if (enc_utf8)
+	return c < 0x80 || c >= 0x100;
+    return c < 0x100;
+}
+
+/*
+ * Store the states that may follow "state" in "next[]", skipping over what
+ * is inside a collection, look-around and composing characters.
+ * Returns the number of states.
+ */
+    static int
+nfa_must_next(nfa_state_T *state, nfa_state_T **next)
+{
+    switch (state->c)
+    {
+	case NFA_MATCH:
+	    return 0;
+
+	case NFA_SPLIT:
+	    next[0] = state->out;
+	    next[1] = state->out1;
+	    return 2;
+
+	case NFA_START_COLL:
+	case NFA_START_NEG_COLL:
+	case NFA_START_INVISIBLE:
+	case NFA_START_INVISIBLE_FIRST:
+	case NFA_START_INVISIBLE_NEG:
+	case NFA_START_INVISIBLE_NEG_FIRST:
+	case NFA_START_INVISIBLE_BEFORE:
+	case NFA_START_INVISIBLE_BEFORE_FIRST:
+	case NFA_START_INVISIBLE_BEFORE_NEG:
+	case NFA_START_INVISIBLE_BEFORE_NEG_FIRST:
+	case NFA_START_PATTERN:
+	case NFA_COMPOSING:
+	    // out1 points to the END state
+	    next[0] = state->out1->out;
+	    return 1;
+    }
+    next[0] = state->out;
+    return next[0] == NULL ? 0 : 1;
+}
+
+/*
+ * Mark the states of "prog" that can be reached from the start, without
+ * going through "avoid" if not NULL.  "mark" and "stack" must have room for
+ * all states.  Returns FALSE when a line break may be matched.
+ */
+    static int
+nfa_must_reach(
+    nfa_regprog_T   *prog,
+    nfa_state_T	    *avoid,
+    char_u	    *mark,
+    int		    *stack)
+{
+    nfa_state_T	*state;
+    nfa_state_T	*next[2];
+    int		sp = 0;
+    int		n;
+    int		idx;
+
+    vim_memset(mark, 0, prog->nstate);
+    idx = (int)(prog->start - prog->state);
+    mark[idx] = TRUE;
+    stack[sp++] = idx;
+    while (sp > 0)
+    {
+	state = &prog->state[stack[--sp]];
+	if (state->c == NFA_NEWL
+		|| (state->c >= NFA_FIRST_NL && state->c <= NFA_LAST_NL))
+	    return FALSE;
+	for (n = nfa_must_next(state, next); --n >= 0; )
+	{
+	    if (next[n] == avoid)
+		continue;
+	    idx = (int)(next[n] - prog->state);
+	    if (!mark[idx])
+	    {
+		mark[idx] = TRUE;
+		stack[sp++] = idx;
+	    }
+	}
+    }
+    return TRUE;
+}
+
+/*
+ * Skip over states that do not consume text and have only one next state.
+ */
+    static nfa_state_T *
+nfa_must_skip(nfa_state_T *state)
+{
+    for (;;)
+    {
+	switch (state->c)
+	{
+	    case NFA_EMPTY:
+	    case NFA_NOPEN:
+	    case NFA_NCLOSE:
+	    case NFA_ZSTART:
+	    case NFA_ZEND:
+	    case NFA_BOW:
+	    case NFA_EOW:
+		break;
+	    default:
+		if (!((state->c >= NFA_MOPEN && state->c <= NFA_MCLOSE9)
+#ifdef FEAT_SYN_HL
+			    || (state->c >= NFA_ZOPEN && state->c <= NFA_ZCLOSE9)
+#endif
+			    ))
+		    return state;
+	}
+	state = state->out;
+    }
+}
+
+/*
+ * Find the longest literal text that every match of "prog" contains, also
+ * when it is somewhere in the middle of the pattern.  Not done when the
+ * pattern can match a line break.  Returns the text in allocated memory or
+ * NULL when there is none.
+ */
+    static char_u *
+nfa_get_must_text(nfa_regprog_T *prog)
+{
+    char_u	*reached = NULL;
+    char_u	*mark = NULL;
+    int		*stack = NULL;
+    nfa_state_T	*best = NULL;
+    int		best_len = 0;
+    nfa_state_T	*p;
+    int		len;
+    int		i;
+    int		match_idx = -1;
+    char_u	*ret = NULL;
+    char_u	*s;
+
+    if (prog->nstate > NFA_MUST_MAX_STATES || (has_mbyte && !enc_utf8))
+	return NULL;
+    reached = alloc(prog->nstate);
+    mark = alloc(prog->nstate);
+    stack = ALLOC_MULT(int, prog->nstate);
+    if (reached == NULL || mark == NULL || stack == NULL
+			       || !nfa_must_reach(prog, NULL, reached, stack))
+	goto theend;
+
+    for (i = 0; i < prog->nstate; ++i)
+	if (reached[i] && prog->state[i].c == NFA_MATCH)
+	    match_idx = i;
+    if (match_idx < 0)
+	goto theend;
+
+    // A character is required when NFA_MATCH cannot be reached without
+    // going through it.  The characters that directly follow it are then
+    // required as well.
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	if (!reached[i] || !nfa_must_char(prog->state[i].c))
+	    continue;
+	nfa_must_reach(prog, &prog->state[i], mark, stack);
+	if (mark[match_idx])
+	    continue;
+	len = 0;
+	for (p = &prog->state[i]; nfa_must_char(p->c);
+						   p = nfa_must_skip(p->out))
+	    len += enc_utf8 ? utf_char2len(p->c) : 1;
+	if (len > best_len)
+	{
+	    best = &prog->state[i];
+	    best_len = len;
+	}
+    }
+
+    if (best != NULL)
+    {
+	ret = alloc(best_len + 1);
+	if (ret != NULL)
+	{
+	    s = ret;
+	    for (p = best; nfa_must_char(p->c); p = nfa_must_skip(p->out))
+	    {
+		if (enc_utf8)
+		    s += utf_char2bytes(p->c, s);
+		else
+		    *s++ = p->c;
+	    }
+	    *s = NUL;
+	}
+    }
+
+theend:
+    vim_free(reached);
+    vim_free(mark);
+    vim_free(stack);
+    return ret;
+}
+
 /*
  * Allocate more space for post_start.  Called when
  * running above the estimated number of states.
@@ -1489,18 +1699,22 @@ nfa_regatom(void)
 		// pattern -- regardless of whether or not it makes sense.
 		case '^':
 		    EMIT(NFA_BOF);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case '$':
 		    EMIT(NFA_EOF);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case '#':
 		    EMIT(NFA_CURSOR);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case 'V':
 		    EMIT(NFA_VISUAL);
+		    regflags |= RF_VOLATILE;
 		    break;
 
 		case 'C':
@@ -1560,6 +1774,7 @@ nfa_regatom(void)
 				// \%{n}l  \%{n}<l  \%{n}>l
 				EMIT(cmp == '<' ? NFA_LNUM_LT :
 				     cmp == '>' ? NFA_LNUM_GT : NFA_LNUM);
+				regflags |= RF_VOLATILE;
 				if (save_prev_at_start)
 				    at_start = TRUE;
 			    }
@@ -1572,6 +1787,7 @@ nfa_regatom(void)
 				// \%{n}v  \%{n}<v  \%{n}>v
 				EMIT(cmp == '<' ? NFA_VCOL_LT :
 				     cmp == '>' ? NFA_VCOL_GT : NFA_VCOL);
+				regflags |= RF_VOLATILE;
 				limit = INT_MAX / MB_MAXBYTES;
 			    }
 			    if (n >= limit)
@@ -1587,6 +1803,7 @@ nfa_regatom(void)
 			    // \%'m  \%<'m  \%>'m
 			    EMIT(cmp == '<' ? NFA_MARK_LT :
 				 cmp == '>' ? NFA_MARK_GT : NFA_MARK);
+			    regflags |= RF_VOLATILE;
 			    EMIT(getchr());
 			    break;
 			}
@@ -3900,11 +4117,6 @@ pim_info(nfa_pim_T *pim)
 
 // Used during execution: whether a match has been found.
 static int	    nfa_match;
-#ifdef FEAT_RELTIME
-static proftime_T  *nfa_time_limit;
-static int	   *nfa_timed_out;
-static int	    nfa_time_count;
-#endif
 
 static void copy_sub(regsub_T *to, regsub_T *from);
 static int pim_equal(nfa_pim_T *one, nfa_pim_T *two);
@@ -5421,6 +5633,15 @@ skip_to_start(int c, colnr_T *colp)
     // Used often, do some work to avoid call overhead.
     if (!rex.reg_ic && !has_mbyte)
 	s = vim_strbyte(rex.line + *colp, c);
+    else if (c < 0x80 && (!has_mbyte || enc_utf8)
+	    && (!rex.reg_ic || (MB_TOLOWER(c) < 0x80 && MB_TOUPPER(c) < 0x80)))
+    {
+	// An ASCII byte cannot be part of a multi-byte character, search for
+	// the byte or its other case.
+	s = rex.line + *colp;
+	s = reg_memchr2(s, STRLEN(s), rex.reg_ic ? MB_TOLOWER(c) : c,
+					       rex.reg_ic ? MB_TOUPPER(c) : c);
+    }
     else
 	s = cstrchr(rex.line + *colp, c);
     if (s == NULL)
@@ -5486,20 +5707,6 @@ find_match_text(colnr_T startcol, int regstart, char_u *match_text)
     return 0L;
 }
 
-#ifdef FEAT_RELTIME
-    static int
-nfa_did_time_out()
-{
-    if (nfa_time_limit != NULL && profile_passed_limit(nfa_time_limit))
-    {
-	if (nfa_timed_out != NULL)
-	    *nfa_timed_out = TRUE;
-	return TRUE;
-    }
-    return FALSE;
-}
-#endif
-
 /*
  * Main matching routine.
  *
@@ -5542,14 +5749,10 @@ nfa_regmatch(
 #endif
 
     // Some patterns may take a long time to match, especially when using
-    // recursive_regmatch(). Allow interrupting them with CTRL-C.
-    fast_breakcheck();
-    if (got_int)
-	return FALSE;
-#ifdef FEAT_RELTIME
-    if (nfa_did_time_out())
+    // recursive_regmatch(). Allow interrupting them with CTRL-C and stop at
+    // the time limit.
+    if (reg_check_abort())
 	return FALSE;
-#endif
 
 #ifdef NFA_REGEXP_DEBUG_LOG
     debug = fopen(NFA_REGEXP_DEBUG_LOG, "a");
@@ -5700,17 +5903,8 @@ nfa_regmatch(
 	{
 	    // If the list gets very long there probably is something wrong.
 	    // At least allow interrupting with CTRL-C.
-	    fast_breakcheck();
-	    if (got_int)
+	    if (reg_check_abort())
 		break;
-#ifdef FEAT_RELTIME
-	    if (nfa_time_limit != NULL && ++nfa_time_count == 20)
-	    {
-		nfa_time_count = 0;
-		if (nfa_did_time_out())
-		    break;
-	    }
-#endif
 	    t = &thislist->t[listidx];
 
 #ifdef NFA_REGEXP_DEBUG_LOG
@@ -6929,19 +7123,9 @@ nextchar:
 	else
 	    break;
 
-	// Allow interrupting with CTRL-C.
-	line_breakcheck();
-	if (got_int)
+	// Allow interrupting with CTRL-C and stop at the time limit.
+	if (reg_check_abort())
 	    break;
-#ifdef FEAT_RELTIME
-	// Check for timeout once in a twenty times to avoid overhead.
-	if (nfa_time_limit != NULL && ++nfa_time_count == 20)
-	{
-	    nfa_time_count = 0;
-	    if (nfa_did_time_out())
-		break;
-	}
-#endif
     }
 
 #ifdef ENABLE_LOG
@@ -6970,9 +7154,7 @@ theend:
     static long
 nfa_regtry(
     nfa_regprog_T   *prog,
-    colnr_T	    col,
-    proftime_T	    *tm UNUSED,	// timeout limit or NULL
-    int		    *timed_out UNUSED)	// flag set on timeout or NULL
+    colnr_T	    col)
 {
     int		i;
     regsubs_T	subs, m;
@@ -6983,11 +7165,6 @@ nfa_regtry(
 #endif
 
     rex.input = rex.line + col;
-#ifdef FEAT_RELTIME
-    nfa_time_limit = tm;
-    nfa_timed_out = timed_out;
-    nfa_time_count = 0;
-#endif
 
 #ifdef ENABLE_LOG
     f = fopen(NFA_REGEXP_RUN_LOG, "a");
@@ -7103,101 +7280,1341 @@ nfa_regtry(
 }
 
 /*
- * Match a regexp against a string ("line" points to the string) or multiple
- * lines ("line" is NULL, use reg_getline()).
+ * Lazy DFA.
  *
- * Returns <= 0 for failure, number of lines contained in the match otherwise.
+ * For a pattern that only contains items which depend on the text of the
+ * line, the NFA is turned into a DFA while matching: every DFA state is a set
+ * of NFA states, a transition is only computed when a character is
+ * encountered for it the first time.  It is used to quickly reject a line
+ * without a match, when the DFA finds a match the NFA simulation is done to
+ * find the start and end of the match and the submatches.
+ *
+ * Zero-width items like "^", "\<" and "\>" are assumed to always match, thus
+ * the DFA may find a match where there is none, but never misses one.  A "$"
+ * is handled by matching it with the NUL at the end of the line.
+ * Back references, look-around, line breaks, "\%V", "\%23l" and the like
+ * cannot be handled, for such a pattern the DFA is not used.
  */
-    static long
-nfa_regexec_both(
-    char_u	*line,
-    colnr_T	startcol,	// column to start looking for match
-    proftime_T	*tm,		// timeout limit or NULL
-    int		*timed_out)	// flag set on timeout or NULL
-{
-    nfa_regprog_T   *prog;
-    long	    retval = 0L;
-    int		    i;
-    colnr_T	    col = startcol;
-
-    if (REG_MULTI)
-    {
-	prog = (nfa_regprog_T *)rex.reg_mmatch->regprog;
-	line = reg_getline((linenr_T)0);    // relative to the cursor
-	rex.reg_startpos = rex.reg_mmatch->startpos;
-	rex.reg_endpos = rex.reg_mmatch->endpos;
-    }
-    else
-    {
-	prog = (nfa_regprog_T *)rex.reg_match->regprog;
-	rex.reg_startp = rex.reg_match->startp;
-	rex.reg_endp = rex.reg_match->endp;
-    }
 
-    // Be paranoid...
-    if (prog == NULL || line == NULL)
-    {
-	emsg(_(e_null));
-	goto theend;
-    }
+// Maximum number of DFA states for a pattern.  When more are needed the
+// states are cleared and the NFA is used for the line.
+#define NFA_DFA_MAX_STATES	400
 
-    // If pattern contains "\c" or "\C": overrule value of rex.reg_ic
-    if (prog->regflags & RF_ICASE)
-	rex.reg_ic = TRUE;
-    else if (prog->regflags & RF_NOICASE)
-	rex.reg_ic = FALSE;
+// After the states were cleared this many times the DFA is not used anymore
+// for the pattern, it takes more time than it saves.
+#define NFA_DFA_MAX_FLUSH	20
 
-    // If pattern contains "\Z" overrule value of rex.reg_icombine
-    if (prog->regflags & RF_ICOMBINE)
-	rex.reg_icombine = TRUE;
+// Size of the hash table used to find a DFA state, must be a power of two.
+#define NFA_DFA_HASH_SIZE	256
 
-    rex.line = line;
-    rex.lnum = 0;    // relative to line
+typedef struct nfa_dstate nfa_dstate_T;
 
-    rex.nfa_has_zend = prog->has_zend;
-    rex.nfa_has_backref = prog->has_backref;
-    rex.nfa_nsubexpr = prog->nsubexp;
-    rex.nfa_listid = 1;
-    rex.nfa_alt_listid = 2;
-#ifdef DEBUG
-    nfa_regengine.expr = prog->pattern;
-#endif
+/*
+ * A DFA state: the set of NFA states that are active at a position.
+ */
+struct nfa_dstate
+{
+    nfa_dstate_T    *next[256];	// state after character 0 - 255, NULL when
+				// not computed yet
+    nfa_dstate_T    *hash_next;	// next state with the same hash value
+    int		    match;	// one of the NFA states is NFA_MATCH
+    int		    nstates;	// number of items in "states"
+    int		    states[1];	// sorted NFA state indexes, actually longer
+};
 
-    if (prog->reganch && col > 0)
-	return 0L;
+struct nfa_dfa
+{
+    nfa_dstate_T    *hash[NFA_DFA_HASH_SIZE];
+    nfa_dstate_T    *start;	// state at the start column, NULL when not
+				// computed yet
+    int		    count;	// number of DFA states
+    int		    flush_count; // number of times the states were cleared
+    int		    uses_chartab; // pattern uses \i, \k, \f, \p or similar
+    int		    *start_set;	// NFA states reached from prog->start
+    int		    start_len;
+    int		    *set;	// set of NFA states being built
+    int		    set_len;
+    int		    *stack;	// work stack for nfa_dfa_add_closure()
+    int		    *mark;	// "tick" when a NFA state was last visited
+    int		    tick;
+
+    // The transitions depend on these, when they change the states are
+    // cleared.
+    int		    reg_ic;
+    unsigned	    cmp_flags;
+    char_u	    buf_chartab[32]; // copy of b_chartab of rex.reg_buf, it
+				     // is swapped for ":syntax iskeyword"
+    int		    chartab_tick;
+};
 
-    rex.need_clear_subexpr = TRUE;
-#ifdef FEAT_SYN_HL
-    // Clear the external match subpointers if necessary.
-    if (prog->reghasz == REX_SET)
-    {
-	rex.nfa_has_zsubexpr = TRUE;
-	rex.need_clear_zsubexpr = TRUE;
-    }
-    else
+/*
+ * Return TRUE if NFA state "c" does not consume a character for the DFA.
+ */
+    static int
+nfa_dfa_is_epsilon(int c)
+{
+    switch (c)
     {
-	rex.nfa_has_zsubexpr = FALSE;
-	rex.need_clear_zsubexpr = FALSE;
+	case NFA_SPLIT:
+	case NFA_EMPTY:
+	case NFA_BOL:
+	case NFA_BOW:
+	case NFA_EOW:
+	case NFA_ZSTART:
+	case NFA_ZEND:
+	case NFA_NOPEN:
+	case NFA_NCLOSE:
+	case NFA_ANY_COMPOSING:
+	    return TRUE;
     }
+    return (c >= NFA_MOPEN && c <= NFA_MCLOSE9)
+#ifdef FEAT_SYN_HL
+	|| (c >= NFA_ZOPEN && c <= NFA_ZCLOSE9)
 #endif
+	;
+}
 
-    if (prog->regstart != NUL)
-    {
-	// Skip ahead until a character we know the match must start with.
-	// When there is none there is no match.
-	if (skip_to_start(prog->regstart, &col) == FAIL)
-	    return 0L;
+/*
+ * Return TRUE if the lazy DFA can be used for "prog".
+ */
+    static int
+nfa_dfa_check(nfa_regprog_T *prog)
+{
+    int	    i;
+    int	    c;
 
-	// If match_text is set it contains the full text that must match.
-	// Nothing else to try. Doesn't handle combining chars well.
-	if (prog->match_text != NULL && !rex.reg_icombine)
-	    return find_match_text(col, prog->regstart, prog->match_text);
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	c = prog->state[i].c;
+	if (c >= 0 || nfa_dfa_is_epsilon(c)
+		|| (c >= NFA_ANY && c <= NFA_NUPPER_IC)
+		|| (c >= NFA_CLASS_ALNUM && c <= NFA_CLASS_FNAME))
+	    continue;
+	switch (c)
+	{
+	    case NFA_MATCH:
+	    case NFA_EOL:
+	    case NFA_START_COLL:
+	    case NFA_START_NEG_COLL:
+	    case NFA_END_COLL:
+	    case NFA_RANGE_MIN:
+	    case NFA_RANGE_MAX:
+		break;
+	    default:
+		return FALSE;
+	}
     }
+    return TRUE;
+}
 
-    // If the start column is past the maximum column: no need to try.
+/*
+ * Return TRUE if "prog" uses an item that depends on 'iskeyword', 'isident',
+ * 'isfname' or 'isprint'.
+ */
+    static int
+nfa_dfa_uses_chartab(nfa_regprog_T *prog)
+{
+    int	    i;
+    int	    c;
+
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	c = prog->state[i].c;
+	if ((c >= NFA_IDENT && c <= NFA_SPRINT)
+		|| c == NFA_CLASS_GRAPH || c == NFA_CLASS_PRINT
+		|| c == NFA_CLASS_IDENT || c == NFA_CLASS_KEYWORD
+		|| c == NFA_CLASS_FNAME)
+	    return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+ * Add NFA state "state" and the states reached from it without consuming a
+ * character to dfa->set[].
+ */
+    static void
+nfa_dfa_add_closure(nfa_regprog_T *prog, nfa_dfa_T *dfa, nfa_state_T *state)
+{
+    int	    sp = 0;
+    int	    idx;
+    int	    i;
+    nfa_state_T *out[2];
+
+    idx = (int)(state - prog->state);
+    if (dfa->mark[idx] == dfa->tick)
+	return;
+    dfa->mark[idx] = dfa->tick;
+    dfa->stack[sp++] = idx;
+    while (sp > 0)
+    {
+	idx = dfa->stack[--sp];
+	state = &prog->state[idx];
+	if (!nfa_dfa_is_epsilon(state->c))
+	{
+	    dfa->set[dfa->set_len++] = idx;
+	    continue;
+	}
+	out[0] = state->out;
+	out[1] = state->c == NFA_SPLIT ? state->out1 : NULL;
+	for (i = 0; i < 2; ++i)
+	    if (out[i] != NULL)
+	    {
+		idx = (int)(out[i] - prog->state);
+		if (dfa->mark[idx] != dfa->tick)
+		{
+		    dfa->mark[idx] = dfa->tick;
+		    dfa->stack[sp++] = idx;
+		}
+	    }
+    }
+}
+
+/*
+ * Return the NFA state that follows "state" when it matches character "c",
+ * NULL when it does not match.  "c" is NUL at the end of the line.
+ * Must do the same as nfa_regmatch().
+ */
+    static nfa_state_T *
+nfa_dfa_next(nfa_state_T *state, int c)
+{
+    int	    result;
+
+    switch (state->c)
+    {
+	case NFA_MATCH:
+	    return NULL;
+
+	case NFA_EOL:
+	    return c == NUL ? state->out : NULL;
+
+	case NFA_START_COLL:
+	case NFA_START_NEG_COLL:
+	  {
+	    nfa_state_T	*item = state->out;
+	    int		result_if_matched = (state->c == NFA_START_COLL);
+	    int		c1, c2;
+
+	    if (c == NUL)
+		return NULL;
+	    for (;;)
+	    {
+		if (item->c == NFA_END_COLL)
+		{
+		    result = !result_if_matched;
+		    break;
+		}
+		if (item->c == NFA_RANGE_MIN)
+		{
+		    c1 = item->val;
+		    item = item->out; // advance to NFA_RANGE_MAX
+		    c2 = item->val;
+		    if (c >= c1 && c <= c2)
+		    {
+			result = result_if_matched;
+			break;
+		    }
+		    if (rex.reg_ic)
+		    {
+			int c_low = MB_TOLOWER(c);
+
+			for ( ; c1 <= c2; ++c1)
+			    if (MB_TOLOWER(c1) == c_low)
+				break;
+			if (c1 <= c2)
+			{
+			    result = result_if_matched;
+			    break;
+			}
+		    }
+		}
+		else if (item->c < 0 ? check_char_class(item->c, c)
+			: (c == item->c
+			    || (rex.reg_ic && MB_TOLOWER(c)
+						       == MB_TOLOWER(item->c))))
+		{
+		    result = result_if_matched;
+		    break;
+		}
+		item = item->out;
+	    }
+	    // next state is in out of the NFA_END_COLL
+	    return result ? state->out1->out : NULL;
+	  }
+
+	case NFA_ANY:	    result = c > 0; break;
+	case NFA_IDENT:	    result = vim_isIDc(c); break;
+	case NFA_SIDENT:    result = !VIM_ISDIGIT(c) && vim_isIDc(c); break;
+	case NFA_KWORD:	    result = vim_iswordc_buf(c, rex.reg_buf); break;
+	case NFA_SKWORD:    result = !VIM_ISDIGIT(c)
+					    && vim_iswordc_buf(c, rex.reg_buf);
+			    break;
+	case NFA_FNAME:	    result = vim_isfilec(c); break;
+	case NFA_SFNAME:    result = !VIM_ISDIGIT(c) && vim_isfilec(c); break;
+	case NFA_PRINT:	    result = vim_isprintc(c); break;
+	case NFA_SPRINT:    result = !VIM_ISDIGIT(c) && vim_isprintc(c); break;
+	case NFA_WHITE:	    result = VIM_ISWHITE(c); break;
+	case NFA_NWHITE:    result = c != NUL && !VIM_ISWHITE(c); break;
+	case NFA_DIGIT:	    result = ri_digit(c); break;
+	case NFA_NDIGIT:    result = c != NUL && !ri_digit(c); break;
+	case NFA_HEX:	    result = ri_hex(c); break;
+	case NFA_NHEX:	    result = c != NUL && !ri_hex(c); break;
+	case NFA_OCTAL:	    result = ri_octal(c); break;
+	case NFA_NOCTAL:    result = c != NUL && !ri_octal(c); break;
+	case NFA_WORD:	    result = ri_word(c); break;
+	case NFA_NWORD:	    result = c != NUL && !ri_word(c); break;
+	case NFA_HEAD:	    result = ri_head(c); break;
+	case NFA_NHEAD:	    result = c != NUL && !ri_head(c); break;
+	case NFA_ALPHA:	    result = ri_alpha(c); break;
+	case NFA_NALPHA:    result = c != NUL && !ri_alpha(c); break;
+	case NFA_LOWER:	    result = ri_lower(c); break;
+	case NFA_NLOWER:    result = c != NUL && !ri_lower(c); break;
+	case NFA_UPPER:	    result = ri_upper(c); break;
+	case NFA_NUPPER:    result = c != NUL && !ri_upper(c); break;
+	case NFA_LOWER_IC:  result = ri_lower(c)
+					      || (rex.reg_ic && ri_upper(c));
+			    break;
+	case NFA_NLOWER_IC: result = c != NUL
+				&& !(ri_lower(c) || (rex.reg_ic && ri_upper(c)));
+			    break;
+	case NFA_UPPER_IC:  result = ri_upper(c)
+					      || (rex.reg_ic && ri_lower(c));
+			    break;
+	case NFA_NUPPER_IC: result = c != NUL
+				&& !(ri_upper(c) || (rex.reg_ic && ri_lower(c)));
+			    break;
+
+	default:	// regular character
+	    result = c == state->c
+		       || (rex.reg_ic && MB_TOLOWER(c) == MB_TOLOWER(state->c));
+	    break;
+    }
+    return result ? state->out : NULL;
+}
+
+/*
+ * Set "bytes" to the bytes that a match of "prog" can start with, using
+ * "rex.reg_ic".  Used by vim_regprog_first_bytes().
+ * Returns FAIL when a match can be empty or start at the end of the line.
+ */
+    static int
+nfa_first_bytes(nfa_regprog_T *prog, char_u *bytes)
+{
+    int		    *stack;
+    char_u	    *mark;
+    int		    sp = 0;
+    int		    idx;
+    int		    i;
+    int		    b;
+    int		    last;
+    int		    uses_chartab;
+    int		    r = OK;
+    nfa_state_T	    *state;
+    nfa_state_T	    *out[2];
+    char_u	    buf[MB_MAXBYTES + 1];
+
+    if (!prog->dfa_usable)
+	return FAIL;
+    stack = ALLOC_MULT(int, prog->nstate);
+    mark = alloc_clear(prog->nstate);
+    if (stack == NULL || mark == NULL)
+    {
+	vim_free(stack);
+	vim_free(mark);
+	return FAIL;
+    }
+    vim_memset(bytes, 0, 32);
+    uses_chartab = nfa_dfa_uses_chartab(prog);
+    // In UTF-8 only ASCII is checked, any first byte of a multi-byte
+    // character is accepted unless the state is a character and case is not
+    // ignored.
+    last = enc_utf8 ? 0x7f : 0xff;
+
+    // Go over the states reached from the start without consuming a
+    // character, like nfa_dfa_add_closure() does.
+    idx = (int)(prog->start - prog->state);
+    mark[idx] = TRUE;
+    stack[sp++] = idx;
+    while (sp > 0 && r == OK)
+    {
+	state = &prog->state[stack[--sp]];
+	if (state->c == NFA_MATCH || state->c == NFA_EOL)
+	    r = FAIL;
+	else if (nfa_dfa_is_epsilon(state->c))
+	{
+	    out[0] = state->out;
+	    out[1] = state->c == NFA_SPLIT ? state->out1 : NULL;
+	    for (i = 0; i < 2; ++i)
+		if (out[i] != NULL && !mark[out[i] - prog->state])
+		{
+		    idx = (int)(out[i] - prog->state);
+		    mark[idx] = TRUE;
+		    stack[sp++] = idx;
+		}
+	}
+	else if (state->c > 0 && !rex.reg_ic)
+	{
+	    // A character, its first byte.
+	    b = state->c;
+	    if (b > last)
+	    {
+		(*mb_char2bytes)(b, buf);
+		b = buf[0];
+	    }
+	    bytes[b >> 3] |= 1 << (b & 7);
+	}
+	else
+	{
+	    // Items depending on 'iskeyword' and similar may be checked with
+	    // another buffer, accept any byte.
+	    for (b = 1; b <= last; ++b)
+		if ((uses_chartab && state->c < 0)
+					      || nfa_dfa_next(state, b) != NULL)
+		    bytes[b >> 3] |= 1 << (b & 7);
+	    for ( ; b <= 0xff; ++b)
+		bytes[b >> 3] |= 1 << (b & 7);
+	}
+    }
+    if (rex.reg_ic)
+	// Accept both cases of ASCII letters, in case 'casemap' changes.
+	for (b = 'a'; b <= 'z'; ++b)
+	    if (bytes[b >> 3] & (1 << (b & 7))
+		    || bytes[TOUPPER_ASC(b) >> 3] & (1 << (TOUPPER_ASC(b) & 7)))
+	    {
+		bytes[b >> 3] |= 1 << (b & 7);
+		bytes[TOUPPER_ASC(b) >> 3] |= 1 << (TOUPPER_ASC(b) & 7);
+	    }
+    vim_free(stack);
+    vim_free(mark);
+    return r;
+}
+
+/*
+ * Free all the states of "dfa".
+ */
+    static void
+nfa_dfa_clear(nfa_dfa_T *dfa)
+{
+    int		    i;
+    nfa_dstate_T    *ds;
+
+    for (i = 0; i < NFA_DFA_HASH_SIZE; ++i)
+	while (dfa->hash[i] != NULL)
+	{
+	    ds = dfa->hash[i];
+	    dfa->hash[i] = ds->hash_next;
+	    vim_free(ds);
+	}
+    dfa->start = NULL;
+    dfa->count = 0;
+}
+
+    static void
+nfa_dfa_free(nfa_dfa_T *dfa)
+{
+    if (dfa == NULL)
+	return;
+    nfa_dfa_clear(dfa);
+    vim_free(dfa->start_set);
+    vim_free(dfa->set);
+    vim_free(dfa->stack);
+    vim_free(dfa->mark);
+    vim_free(dfa);
+}
+
+/*
+ * Allocate the DFA for "prog".  Returns NULL when out of memory.
+ */
+    static nfa_dfa_T *
+nfa_dfa_new(nfa_regprog_T *prog)
+{
+    nfa_dfa_T	*dfa;
+
+    dfa = ALLOC_CLEAR_ONE(nfa_dfa_T);
+    if (dfa == NULL)
+	return NULL;
+    dfa->start_set = ALLOC_MULT(int, prog->nstate);
+    dfa->set = ALLOC_MULT(int, prog->nstate);
+    dfa->stack = ALLOC_MULT(int, prog->nstate);
+    dfa->mark = ALLOC_CLEAR_MULT(int, prog->nstate);
+    if (dfa->start_set == NULL || dfa->set == NULL || dfa->stack == NULL
+							   || dfa->mark == NULL)
+    {
+	nfa_dfa_free(dfa);
+	return NULL;
+    }
+    dfa->uses_chartab = nfa_dfa_uses_chartab(prog);
+
+    // The NFA states reached from the start do not depend on the text.
+    ++dfa->tick;
+    dfa->set_len = 0;
+    nfa_dfa_add_closure(prog, dfa, prog->start);
+    mch_memmove(dfa->start_set, dfa->set, sizeof(int) * dfa->set_len);
+    dfa->start_len = dfa->set_len;
+    return dfa;
+}
+
+/*
+ * Find the DFA state for the NFA states in dfa->set[], add it when it does
+ * not exist yet.  Returns NULL when there are too many states.
+ */
+    static nfa_dstate_T *
+nfa_dfa_find_state(nfa_regprog_T *prog, nfa_dfa_T *dfa)
+{
+    int		    *set = dfa->set;
+    int		    len = dfa->set_len;
+    int		    i, j;
+    int		    idx;
+    unsigned	    hash = 0;
+    nfa_dstate_T    *ds;
+
+    // Sort the set, it is usually small.
+    for (i = 1; i < len; ++i)
+    {
+	idx = set[i];
+	for (j = i; j > 0 && set[j - 1] > idx; --j)
+	    set[j] = set[j - 1];
+	set[j] = idx;
+    }
+
+    for (i = 0; i < len; ++i)
+	hash = hash * 31 + (unsigned)set[i];
+    hash &= NFA_DFA_HASH_SIZE - 1;
+    for (ds = dfa->hash[hash]; ds != NULL; ds = ds->hash_next)
+	if (ds->nstates == len
+		      && memcmp(ds->states, set, sizeof(int) * len) == 0)
+	    return ds;
+
+    if (dfa->count >= NFA_DFA_MAX_STATES)
+	return NULL;
+    ds = alloc_clear(sizeof(nfa_dstate_T) + sizeof(int) * len);
+    if (ds == NULL)
+	return NULL;
+    ds->nstates = len;
+    for (i = 0; i < len; ++i)
+    {
+	ds->states[i] = set[i];
+	if (prog->state[set[i]].c == NFA_MATCH)
+	    ds->match = TRUE;
+    }
+    ds->hash_next = dfa->hash[hash];
+    dfa->hash[hash] = ds;
+    ++dfa->count;
+    return ds;
+}
+
+/*
+ * Compute the DFA state that follows "ds" for character "c".
+ * Returns NULL when there are too many states.
+ */
+    static nfa_dstate_T *
+nfa_dfa_step(
+    nfa_regprog_T   *prog,
+    nfa_dfa_T	    *dfa,
+    nfa_dstate_T    *ds,
+    int		    c)
+{
+    int		    i;
+    nfa_state_T	    *next;
+
+    ++dfa->tick;
+    dfa->set_len = 0;
+    for (i = 0; i < ds->nstates; ++i)
+    {
+	next = nfa_dfa_next(&prog->state[ds->states[i]], c);
+	if (next != NULL)
+	    nfa_dfa_add_closure(prog, dfa, next);
+    }
+
+    // Unless the pattern starts with "^" a match may start at the next
+    // position.
+    if (!prog->reganch && c != NUL)
+	for (i = 0; i < dfa->start_len; ++i)
+	    if (dfa->mark[dfa->start_set[i]] != dfa->tick)
+	    {
+		dfa->mark[dfa->start_set[i]] = dfa->tick;
+		dfa->set[dfa->set_len++] = dfa->start_set[i];
+	    }
+
+    return nfa_dfa_find_state(prog, dfa);
+}
+
+/*
+ * Use the lazy DFA to check whether "rex.line" may contain a match for "prog"
+ * at or after column "col".  Returns FALSE when there certainly is no match.
+ */
+    static int
+nfa_dfa_may_match(nfa_regprog_T *prog, colnr_T col)
+{
+    nfa_dfa_T	    *dfa = prog->dfa;
+    nfa_dstate_T    *ds;
+    nfa_dstate_T    *next;
+    char_u	    *p;
+    int		    c;
+    int		    len;
+
+    // A double-byte encoding is not supported.  With "rex.reg_line_lbr" a
+    // "\n" in the text is a line break, which the DFA does not handle.
+    if ((has_mbyte && !enc_utf8) || rex.reg_line_lbr)
+	return TRUE;
+
+    if (dfa == NULL)
+    {
+	dfa = nfa_dfa_new(prog);
+	if (dfa == NULL)
+	{
+	    prog->dfa_usable = FALSE;
+	    return TRUE;
+	}
+	prog->dfa = dfa;
+    }
+    if (dfa->reg_ic != rex.reg_ic || dfa->cmp_flags != cmp_flags
+	    || (dfa->uses_chartab && (dfa->chartab_tick != chartab_tick
+			|| memcmp(dfa->buf_chartab, rex.reg_buf->b_chartab,
+							     (size_t)32) != 0)))
+    {
+	nfa_dfa_clear(dfa);
+	dfa->reg_ic = rex.reg_ic;
+	dfa->cmp_flags = cmp_flags;
+	mch_memmove(dfa->buf_chartab, rex.reg_buf->b_chartab, (size_t)32);
+	dfa->chartab_tick = chartab_tick;
+    }
+
+    if (dfa->start == NULL)
+    {
+	mch_memmove(dfa->set, dfa->start_set, sizeof(int) * dfa->start_len);
+	dfa->set_len = dfa->start_len;
+	dfa->start = nfa_dfa_find_state(prog, dfa);
+	if (dfa->start == NULL)
+	    return TRUE;
+    }
+
+    ds = dfa->start;
+    p = rex.line + col;
+    for (;;)
+    {
+	if (ds->match)
+	    return TRUE;
+	// Without "^" the start states are always included, the set can only
+	// become empty with "^".
+	if (ds->nstates == 0)
+	    return FALSE;
+
+	c = *p;
+	len = 1;
+	if (c >= 0x80 && enc_utf8)
+	{
+	    c = utf_ptr2char(p);
+	    // Composing characters are not handled.
+	    if (utf_iscomposing(c))
+		return TRUE;
+	    len = utf_ptr2len(p);
+	}
+
+	if (c < 256 && ds->next[c] != NULL)
+	    next = ds->next[c];
+	else
+	{
+	    next = nfa_dfa_step(prog, dfa, ds, c);
+	    if (next == NULL)
+	    {
+		// Too many states, start over for the next line.  Stop using
+		// the DFA if this keeps happening.
+		nfa_dfa_clear(dfa);
+		if (++dfa->flush_count > NFA_DFA_MAX_FLUSH)
+		{
+		    nfa_dfa_free(dfa);
+		    prog->dfa = NULL;
+		    prog->dfa_usable = FALSE;
+		}
+		return TRUE;
+	    }
+	    if (c < 256)
+		ds->next[c] = next;
+	}
+	ds = next;
+
+	if (c == NUL)
+	    return ds->match;
+	p += len;
+    }
+}
+
+/*
+ * Bit-parallel matcher.
+ *
+ * Many patterns are made of characters and character classes combined with
+ * "*", "\+", "\=" and "\|", e.g. "\<foo\>", "[A-Z_]\+" and "TODO\|FIXME".
+ * Each NFA state that consumes a character is a "position".  When there are
+ * not more positions than bits in a word, the positions that are active at a
+ * character fit in a word and going to the next character takes a few table
+ * lookups and bitwise operations (Shift-And), instead of adding states to
+ * lists like nfa_regmatch() does.
+ *
+ * This only finds the same match as nfa_regmatch() when at most one of the
+ * active positions matches a character and ending the match is always the
+ * last choice.  Then the match is the leftmost-longest one.  This is checked
+ * when compiling the pattern and, because it depends on 'ignorecase', again
+ * when the tables for the characters are built.
+ *
+ * The zero-width items "^", "$", "\<" and "\>" are handled by computing the
+ * positions reached for each combination of them.  Capturing groups, "\zs",
+ * line breaks and anything else is not handled, then the pattern is matched
+ * with nfa_regmatch().  With a multi-byte encoding that is also done when
+ * the text has a non-ASCII character.
+ */
+
+// Type used for a set of positions, one bit per position.
+typedef uvarnumber_T nfa_bits_T;
+
+#define NFA_BP_MAX_POS	((int)sizeof(nfa_bits_T) * 8)
+
+// Flags for the zero-width items that match at a column.
+#define NFA_BP_BOL	1	// "^": at the start of the line
+#define NFA_BP_EOL	2	// "$": at the end of the line
+#define NFA_BP_BOW	4	// "\<": at the start of a word
+#define NFA_BP_EOW	8	// "\>": at the end of a word
+#define NFA_BP_ANY	16	// all of them, used for the quick check
+#define NFA_BP_NCTX	17	// number of combinations
+
+typedef struct
+{
+    nfa_bits_T	mask;		// positions reached
+    int		match;		// NFA_MATCH is reached
+} nfa_bpset_T;
+
+struct nfa_bp
+{
+    int		npos;		// number of positions
+    int		*pos_state;	// index in prog->state[] for each position
+    int		uses_ctx;	// pattern contains "^", "$", "\<" or "\>"
+    nfa_bpset_T	init[NFA_BP_NCTX]; // reached from the start
+    nfa_bpset_T	*follow;	// reached after a position matched,
+				// NFA_BP_NCTX entries for each position
+    nfa_bits_T	final_any;	// positions that may be followed by a match
+    int		nchunks;	// number of tables in "follow_any"
+    nfa_bits_T	(*follow_any)[256]; // positions reached after a group of
+				// eight positions, for NFA_BP_ANY
+
+    // The tables below depend on 'ignorecase', 'iskeyword' and the
+    // encoding, they are built when matching.
+    int		ready;		// "bytes" and "usable" are valid
+    int		usable;		// matcher can be used with these tables
+    int		uses_chartab;	// pattern uses \i, \k, \f, \p or similar
+    int		reg_ic;
+    int		has_mbyte;
+    char_u	buf_chartab[32];
+    int		chartab_tick;
+    nfa_bits_T	bytes[256];	// positions that match each byte
+
+    nfa_bits_T	*dead;		// for each column the positions that were
+				// found not to lead to a match
+    int		dead_len;
+};
+
+/*
+ * Return FALSE when the zero-width items in "ctx" cannot match at the same
+ * column.
+ */
+    static int
+nfa_bp_ctx_valid(int ctx)
+{
+    if ((ctx & NFA_BP_BOW) && (ctx & (NFA_BP_EOW | NFA_BP_EOL)))
+	return FALSE;
+    if ((ctx & NFA_BP_EOW) && (ctx & NFA_BP_BOL))
+	return FALSE;
+    return TRUE;
+}
+
+/*
+ * Return the zero-width items that match at "p" in "rex.line".  Returns -1
+ * for a multi-byte character, the character before "p" must not be one.
+ * Must do the same as nfa_regmatch() for ASCII characters.
+ */
+    static int
+nfa_bp_get_ctx(char_u *p)
+{
+    int	    ctx = 0;
+    int	    this_word;
+    int	    prev_word;
+
+    if (has_mbyte && *p >= 0x80)
+	return -1;
+    this_word = *p != NUL && vim_iswordc_buf(*p, rex.reg_buf);
+    prev_word = p > rex.line && vim_iswordc_buf(p[-1], rex.reg_buf);
+    if (p == rex.line)
+	ctx |= NFA_BP_BOL;
+    if (*p == NUL)
+	ctx |= NFA_BP_EOL;
+    if (this_word && !prev_word)
+	ctx |= NFA_BP_BOW;
+    if (prev_word && !this_word)
+	ctx |= NFA_BP_EOW;
+    return ctx;
+}
+
+/*
+ * Return TRUE if NFA state "c" consumes one character and can be handled by
+ * nfa_dfa_next().
+ */
+    static int
+nfa_bp_is_position(int c)
+{
+    return c >= 0 || (c >= NFA_ANY && c <= NFA_NUPPER_IC)
+			    || c == NFA_START_COLL || c == NFA_START_NEG_COLL;
+}
+
+/*
+ * Compute in "set" the positions reached from "state" without consuming a
+ * character, when the zero-width items in "ctx" match.  New positions are
+ * added to "bp".  The states are visited in the order nfa_regmatch() adds
+ * them.  Returns FAIL when an item is not supported, there are too many
+ * positions or a position comes after NFA_MATCH.
+ */
+    static int
+nfa_bp_closure(
+    nfa_regprog_T   *prog,
+    nfa_bp_T	    *bp,
+    nfa_state_T	    *state,
+    int		    ctx,
+    int		    *state_pos,	// position of each state or -1
+    int		    *stack,	// room for two entries for each state
+    int		    *visited,	// "tick" when a state was visited
+    int		    tick,
+    nfa_bpset_T	    *set)
+{
+    int	    sp = 0;
+    int	    idx;
+    int	    c;
+    int	    flag;
+
+    set->mask = 0;
+    set->match = FALSE;
+    stack[sp++] = (int)(state - prog->state);
+    while (sp > 0)
+    {
+	idx = stack[--sp];
+	if (visited[idx] == tick)
+	    continue;
+	visited[idx] = tick;
+	state = &prog->state[idx];
+	c = state->c;
+
+	if (nfa_bp_is_position(c))
+	{
+	    // A match must not be preferred over consuming a character.
+	    if (set->match)
+		return FAIL;
+	    if (state_pos[idx] < 0)
+	    {
+		if (bp->npos == NFA_BP_MAX_POS)
+		    return FAIL;
+		state_pos[idx] = bp->npos;
+		bp->pos_state[bp->npos++] = idx;
+	    }
+	    set->mask |= (nfa_bits_T)1 << state_pos[idx];
+	    continue;
+	}
+
+	switch (c)
+	{
+	    case NFA_MATCH:
+		set->match = TRUE;
+		continue;
+
+	    case NFA_SPLIT:
+		// "out" is tried first, it must be popped first
+		stack[sp++] = (int)(state->out1 - prog->state);
+		break;
+
+	    case NFA_EMPTY:
+	    case NFA_NOPEN:
+	    case NFA_NCLOSE:
+	    case NFA_MOPEN:
+	    case NFA_MCLOSE:
+		break;
+
+	    case NFA_BOL:
+	    case NFA_EOL:
+	    case NFA_BOW:
+	    case NFA_EOW:
+		flag = c == NFA_BOL ? NFA_BP_BOL : c == NFA_EOL ? NFA_BP_EOL
+			     : c == NFA_BOW ? NFA_BP_BOW : NFA_BP_EOW;
+		if ((ctx & (flag | NFA_BP_ANY)) == 0)
+		    continue;
+		break;
+
+	    default:
+		return FAIL;
+	}
+	stack[sp++] = (int)(state->out - prog->state);
+    }
+    return OK;
+}
+
+    static void
+nfa_bp_free(nfa_bp_T *bp)
+{
+    if (bp == NULL)
+	return;
+    vim_free(bp->pos_state);
+    vim_free(bp->follow);
+    vim_free(bp->follow_any);
+    vim_free(bp->dead);
+    vim_free(bp);
+}
+
+/*
+ * Set "prog->bp" when the bit-parallel matcher can be used for "prog".
+ */
+    static void
+nfa_bp_compile(nfa_regprog_T *prog)
+{
+    nfa_bp_T	*bp;
+    nfa_bpset_T	*follow = NULL;
+    int		*state_pos = NULL;
+    int		*stack = NULL;
+    int		*visited = NULL;
+    int		tick = 0;
+    int		i, k, v;
+    int		ctx;
+    nfa_state_T	*state;
+    nfa_state_T	*next;
+
+    prog->bp = NULL;
+    bp = ALLOC_CLEAR_ONE(nfa_bp_T);
+    if (bp == NULL)
+	return;
+    bp->pos_state = ALLOC_MULT(int, NFA_BP_MAX_POS);
+    follow = ALLOC_CLEAR_MULT(nfa_bpset_T, NFA_BP_MAX_POS * NFA_BP_NCTX);
+    state_pos = ALLOC_MULT(int, prog->nstate);
+    stack = ALLOC_MULT(int, prog->nstate * 2 + 1);
+    visited = ALLOC_CLEAR_MULT(int, prog->nstate);
+    if (bp->pos_state == NULL || follow == NULL || state_pos == NULL
+					     || stack == NULL || visited == NULL)
+	goto fail;
+
+    for (i = 0; i < prog->nstate; ++i)
+    {
+	state_pos[i] = -1;
+	switch (prog->state[i].c)
+	{
+	    case NFA_BOL:
+	    case NFA_EOL:
+	    case NFA_BOW:
+	    case NFA_EOW:
+		bp->uses_ctx = TRUE;
+		break;
+	}
+    }
+
+    // Compute the positions reached from the start and, while new positions
+    // are found, the positions reached after each position.  Without
+    // zero-width items only the first context and NFA_BP_ANY are used.
+    for (i = -1; i < bp->npos; ++i)
+    {
+	if (i < 0)
+	    next = prog->start;
+	else
+	{
+	    state = &prog->state[bp->pos_state[i]];
+	    if (state->c == NFA_START_COLL || state->c == NFA_START_NEG_COLL)
+		next = state->out1->out;  // out of the NFA_END_COLL
+	    else
+		next = state->out;
+	}
+	for (ctx = 0; ctx < NFA_BP_NCTX; ++ctx)
+	{
+	    if (ctx != NFA_BP_ANY && (bp->uses_ctx ? !nfa_bp_ctx_valid(ctx)
+								 : ctx != 0))
+		continue;
+	    if (nfa_bp_closure(prog, bp, next, ctx, state_pos, stack, visited,
+			++tick, i < 0 ? &bp->init[ctx]
+				     : &follow[i * NFA_BP_NCTX + ctx]) == FAIL)
+		goto fail;
+	}
+    }
+
+    bp->follow = ALLOC_MULT(nfa_bpset_T, bp->npos * NFA_BP_NCTX + 1);
+    bp->nchunks = (bp->npos + 7) / 8;
+    bp->follow_any = alloc(sizeof(nfa_bits_T) * 256 * bp->nchunks + 1);
+    if (bp->follow == NULL || bp->follow_any == NULL)
+	goto fail;
+    mch_memmove(bp->follow, follow,
+			      sizeof(nfa_bpset_T) * bp->npos * NFA_BP_NCTX);
+
+    // Table to find the positions reached after any of eight positions with
+    // one lookup.
+    for (k = 0; k < bp->nchunks; ++k)
+    {
+	bp->follow_any[k][0] = 0;
+	for (v = 1; v < 256; ++v)
+	{
+	    int		b = 0;
+	    nfa_bits_T	m = 0;
+
+	    while ((v & (1 << b)) == 0)
+		++b;
+	    if (k * 8 + b < bp->npos)
+		m = bp->follow[(k * 8 + b) * NFA_BP_NCTX + NFA_BP_ANY].mask;
+	    bp->follow_any[k][v] = bp->follow_any[k][v & (v - 1)] | m;
+	}
+    }
+    for (i = 0; i < bp->npos; ++i)
+	if (bp->follow[i * NFA_BP_NCTX + NFA_BP_ANY].match)
+	    bp->final_any |= (nfa_bits_T)1 << i;
+
+    bp->uses_chartab = nfa_dfa_uses_chartab(prog);
+    prog->bp = bp;
+    bp = NULL;
+
+fail:
+    nfa_bp_free(bp);
+    vim_free(follow);
+    vim_free(state_pos);
+    vim_free(stack);
+    vim_free(visited);
+}
+
+/*
+ * Return TRUE when at most one position in "set" matches each character.
+ */
+    static int
+nfa_bp_set_unique(nfa_bp_T *bp, nfa_bpset_T *set, int maxc)
+{
+    int		c;
+    nfa_bits_T	m;
+
+    for (c = 1; c < maxc; ++c)
+    {
+	m = set->mask & bp->bytes[c];
+	if ((m & (m - 1)) != 0)
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Build the tables of "bp" for the positions matching each byte, unless they
+ * are still valid.  Returns FALSE when the matcher cannot be used, because
+ * more than one position can match a character.
+ */
+    static int
+nfa_bp_prepare(nfa_regprog_T *prog, nfa_bp_T *bp)
+{
+    int		i;
+    int		c;
+    int		ctx;
+    int		maxc;
+    nfa_bits_T	m;
+
+    if (bp->ready && bp->reg_ic == rex.reg_ic && bp->has_mbyte == has_mbyte
+	    && (!bp->uses_chartab || (bp->chartab_tick == chartab_tick
+			&& memcmp(bp->buf_chartab, rex.reg_buf->b_chartab,
+							    (size_t)32) == 0)))
+	return bp->usable;
+
+    bp->ready = TRUE;
+    bp->reg_ic = rex.reg_ic;
+    bp->has_mbyte = has_mbyte;
+    mch_memmove(bp->buf_chartab, rex.reg_buf->b_chartab, (size_t)32);
+    bp->chartab_tick = chartab_tick;
+
+    // With a multi-byte encoding a byte 0x80 or above is never used.
+    maxc = has_mbyte ? 0x80 : 0x100;
+    for (c = 0; c < 256; ++c)
+    {
+	m = 0;
+	if (c > 0 && c < maxc)
+	    for (i = 0; i < bp->npos; ++i)
+		if (nfa_dfa_next(&prog->state[bp->pos_state[i]], c) != NULL)
+		    m |= (nfa_bits_T)1 << i;
+	bp->bytes[c] = m;
+    }
+
+    bp->usable = FALSE;
+    for (ctx = 0; ctx < NFA_BP_ANY; ++ctx)
+    {
+	if (bp->uses_ctx ? !nfa_bp_ctx_valid(ctx) : ctx != 0)
+	    continue;
+	if (!nfa_bp_set_unique(bp, &bp->init[ctx], maxc))
+	    return FALSE;
+	for (i = 0; i < bp->npos; ++i)
+	    if (!nfa_bp_set_unique(bp, &bp->follow[i * NFA_BP_NCTX + ctx],
+									maxc))
+		return FALSE;
+    }
+    bp->usable = TRUE;
+    return TRUE;
+}
+
+/*
+ * Return the index of the only bit set in "m".
+ */
+    static int
+nfa_bp_bit_index(nfa_bits_T m)
+{
+    int	    i = 0;
+
+    while ((m & 0xff) == 0)
+    {
+	m >>= 8;
+	i += 8;
+    }
+    while ((m & 1) == 0)
+    {
+	m >>= 1;
+	++i;
+    }
+    return i;
+}
+
+/*
+ * Find a match for "prog" in "rex.line" at or after column "col" with the
+ * bit-parallel matcher.  Returns 1 for a match, 0 for no match and -1 when
+ * the matcher cannot be used, nfa_regtry() must be used then.
+ */
+    static long
+nfa_bp_regexec(nfa_regprog_T *prog, colnr_T col)
+{
+    nfa_bp_T	*bp = prog->bp;
+    nfa_bpset_T	*set;
+    nfa_bits_T	d;
+    nfa_bits_T	mask;
+    char_u	*p;
+    int		c;
+    int		k;
+    int		ctx;
+    int		len;
+    colnr_T	s;
+    colnr_T	j;
+    colnr_T	end;
+
+    // A double-byte encoding is not supported.  With "rex.reg_line_lbr" a
+    // "\n" in the text is a line break.
+    if ((has_mbyte && !enc_utf8) || rex.reg_line_lbr || rex.reg_maxcol > 0)
+	return -1;
+    // The character before the start is used for "\<" and "\>".
+    if (has_mbyte && col > 0 && rex.line[col - 1] >= 0x80)
+	return -1;
+    if (!nfa_bp_prepare(prog, bp))
+	return -1;
+
+    // First quickly check for a match anywhere in the line, going over the
+    // text once while keeping track of all the active positions.  The
+    // zero-width items are assumed to match, the lazy DFA does check them.
+    if (bp->uses_ctx && prog->dfa_usable)
+    {
+	if (!nfa_dfa_may_match(prog, col))
+	    return 0;
+    }
+    else if (!bp->init[NFA_BP_ANY].match)
+    {
+	d = 0;
+	for (p = rex.line + col; ; ++p)
+	{
+	    c = *p;
+	    if (c >= 0x80 && has_mbyte)
+		return -1;
+	    mask = 0;
+	    for (k = 0; d != 0; ++k, d >>= 8)
+		mask |= bp->follow_any[k][d & 0xff];
+	    if (!prog->reganch || p == rex.line)
+		mask |= bp->init[NFA_BP_ANY].mask;
+	    d = mask & bp->bytes[c];
+	    if (d & bp->final_any)
+		break;
+	    if (c == NUL)
+		return 0;
+	}
+    }
+
+    // Find the leftmost start of a match.  From a start there is only one
+    // way to go, thus when going over a position at a column that was found
+    // not to lead to a match before, the rest can be skipped.
+    len = col + (int)STRLEN(rex.line + col);
+    if (bp->dead_len < len + 1)
+    {
+	vim_free(bp->dead);
+	bp->dead_len = 0;
+	bp->dead = ALLOC_MULT(nfa_bits_T, len + 1);
+	if (bp->dead == NULL)
+	    return -1;
+	bp->dead_len = len + 1;
+    }
+    vim_memset(bp->dead + col, 0, sizeof(nfa_bits_T) * (len + 1 - col));
+
+    for (s = col; s <= len; ++s)
+    {
+	ctx = bp->uses_ctx ? nfa_bp_get_ctx(rex.line + s) : 0;
+	if (ctx < 0)
+	    return -1;
+	set = &bp->init[ctx];
+	end = set->match ? s : -1;
+	mask = set->mask;
+	for (j = s; mask != 0; ++j)
+	{
+	    c = rex.line[j];
+	    if (c >= 0x80 && has_mbyte)
+		return -1;
+	    d = mask & bp->bytes[c];
+	    if (d == 0 || (bp->dead[j + 1] & d) != 0)
+		break;
+	    bp->dead[j + 1] |= d;
+	    ctx = bp->uses_ctx ? nfa_bp_get_ctx(rex.line + j + 1) : 0;
+	    if (ctx < 0)
+		return -1;
+	    set = &bp->follow[nfa_bp_bit_index(d) * NFA_BP_NCTX + ctx];
+	    if (set->match)
+		end = j + 1;
+	    mask = set->mask;
+	}
+
+	if (end >= 0)
+	{
+	    cleanup_subexpr();
+	    if (REG_MULTI)
+	    {
+		rex.reg_startpos[0].lnum = 0;
+		rex.reg_startpos[0].col = s;
+		rex.reg_endpos[0].lnum = 0;
+		rex.reg_endpos[0].col = end;
+	    }
+	    else
+	    {
+		rex.reg_startp[0] = rex.line + s;
+		rex.reg_endp[0] = rex.line + end;
+	    }
+#ifdef FEAT_SYN_HL
+	    unref_extmatch(re_extmatch_out);
+	    re_extmatch_out = NULL;
+#endif
+	    return 1;
+	}
+	if (prog->reganch)
+	    break;
+    }
+    return 0;
+}
+
+/*
+ * Match a regexp against a string ("line" points to the string) or multiple
+ * lines ("line" is NULL, use reg_getline()).
+ *
+ * Returns <= 0 for failure, number of lines contained in the match otherwise.
+ */
+    static long
+nfa_regexec_both(
+    char_u	*line,
+    colnr_T	startcol,	// column to start looking for match
+    proftime_T	*tm UNUSED,	// timeout limit or NULL
+    int		*timed_out UNUSED) // flag set on timeout or NULL
+{
+    nfa_regprog_T   *prog;
+    long	    retval = 0L;
+    int		    i;
+    colnr_T	    col = startcol;
+
+#ifdef FEAT_RELTIME
+    reg_set_time_limit(tm, timed_out);
+#endif
+
+    if (REG_MULTI)
+    {
+	prog = (nfa_regprog_T *)rex.reg_mmatch->regprog;
+	line = reg_getline((linenr_T)0);    // relative to the cursor
+	rex.reg_startpos = rex.reg_mmatch->startpos;
+	rex.reg_endpos = rex.reg_mmatch->endpos;
+    }
+    else
+    {
+	prog = (nfa_regprog_T *)rex.reg_match->regprog;
+	rex.reg_startp = rex.reg_match->startp;
+	rex.reg_endp = rex.reg_match->endp;
+    }
+
+    // Be paranoid...
+    if (prog == NULL || line == NULL)
+    {
+	emsg(_(e_null));
+	goto theend;
+    }
+
+    // If pattern contains "\c" or "\C": overrule value of rex.reg_ic
+    if (prog->regflags & RF_ICASE)
+	rex.reg_ic = TRUE;
+    else if (prog->regflags & RF_NOICASE)
+	rex.reg_ic = FALSE;
+
+    // If pattern contains "\Z" overrule value of rex.reg_icombine
+    if (prog->regflags & RF_ICOMBINE)
+	rex.reg_icombine = TRUE;
+
+    rex.line = line;
+    rex.lnum = 0;    // relative to line
+
+    rex.nfa_has_zend = prog->has_zend;
+    rex.nfa_has_backref = prog->has_backref;
+    rex.nfa_nsubexpr = prog->nsubexp;
+    rex.nfa_listid = 1;
+    rex.nfa_alt_listid = 2;
+#ifdef DEBUG
+    nfa_regengine.expr = prog->pattern;
+#endif
+
+    if (prog->reganch && col > 0)
+	return 0L;
+
+    rex.need_clear_subexpr = TRUE;
+#ifdef FEAT_SYN_HL
+    // Clear the external match subpointers if necessary.
+    if (prog->reghasz == REX_SET)
+    {
+	rex.nfa_has_zsubexpr = TRUE;
+	rex.need_clear_zsubexpr = TRUE;
+    }
+    else
+    {
+	rex.nfa_has_zsubexpr = FALSE;
+	rex.need_clear_zsubexpr = FALSE;
+    }
+#endif
+
+    if (prog->regstart != NUL)
+    {
+	// Skip ahead until a character we know the match must start with.
+	// When there is none there is no match.
+	if (skip_to_start(prog->regstart, &col) == FAIL)
+	    return 0L;
+
+	// If match_text is set it contains the full text that must match.
+	// Nothing else to try. Doesn't handle combining chars well.
+	if (prog->match_text != NULL && !rex.reg_icombine)
+	    return find_match_text(col, prog->regstart, prog->match_text);
+    }
+
+    // If the start column is past the maximum column: no need to try.
     if (rex.reg_maxcol > 0 && col >= rex.reg_maxcol)
 	goto theend;
 
+    // Check that the literal text every match contains is in the line.
+    if (prog->must_text != NULL && reg_find_literal(rex.line + col,
+					prog->must_text, prog->must_len) == FAIL)
+	goto theend;
+
+    // Use the bit-parallel matcher when it can handle the pattern and text.
+    if (prog->bp != NULL)
+    {
+	retval = nfa_bp_regexec(prog, col);
+	if (retval >= 0)
+	    goto theend;
+	retval = 0L;
+    }
+
+    // Quickly check with the lazy DFA that there is no match in the line.
+    if (prog->dfa_usable && !nfa_dfa_may_match(prog, col))
+	goto theend;
+
     // Set the "nstate" used by nfa_regcomp() to zero to trigger an error when
     // it's accidentally used during execution.
     nstate = 0;
@@ -7208,7 +8625,7 @@ nfa_regexec_both(
 	prog->state[i].lastlist[1] = 0;
     }
 
-    retval = nfa_regtry(prog, col, tm, timed_out);
+    retval = nfa_regtry(prog, col);
 
 #ifdef DEBUG
     nfa_regengine.expr = NULL;
@@ -7295,10 +8712,18 @@ nfa_regcomp(char_u *expr, int re_flags)
     prog->nsubexp = regnpar;
 
     nfa_postprocess(prog);
+    prog->dfa_usable = nfa_dfa_check(prog);
+    prog->dfa = NULL;
+    prog->bp = NULL;
 
     prog->reganch = nfa_get_reganch(prog->start, 0);
     prog->regstart = nfa_get_regstart(prog->start, 0);
     prog->match_text = nfa_get_match_text(prog->start);
+    prog->must_text = NULL;
+    if (prog->match_text == NULL)
+	prog->must_text = nfa_get_must_text(prog);
+    prog->must_len = prog->must_text == NULL ? 0
+					      : (int)STRLEN(prog->must_text);
 
 #ifdef ENABLE_LOG
     nfa_postfix_dump(expr, OK);
@@ -7338,7 +8763,10 @@ nfa_regfree(regprog_T *prog)
 {
     if (prog != NULL)
     {
+	nfa_dfa_free(((nfa_regprog_T *)prog)->dfa);
+	nfa_bp_free(((nfa_regprog_T *)prog)->bp);
 	vim_free(((nfa_regprog_T *)prog)->match_text);
+	vim_free(((nfa_regprog_T *)prog)->must_text);
 	vim_free(((nfa_regprog_T *)prog)->pattern);
 	vim_free(prog);
     }
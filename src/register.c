@@ -1988,6 +1988,26 @@ do_put(
 		    i = 1;
 		}
 
+		if (!(flags & PUT_FIXINDENT))
+		{
+		    // Append the lines all at once.  For MCHAR the last one
+		    // was already inserted above.
+		    long	n = y_size - i - (y_type == MCHAR ? 1 : 0);
+		    linenr_T	old_count = curbuf->b_ml.ml_line_count;
+
+		    if (n > 0 && ml_append_many(curbuf, lnum, y_array + i, n,
+							      FALSE) == FAIL)
+		    {
+			// Account for the lines that were appended.
+			lnum += curbuf->b_ml.ml_line_count - old_count;
+			nr_lines += curbuf->b_ml.ml_line_count - old_count;
+			goto error;
+		    }
+		    lnum += y_size - i;
+		    nr_lines += y_size - i;
+		    i = y_size;
+		}
+
 		for (; i < y_size; ++i)
 		{
 		    if ((y_type != MCHAR || i < y_size - 1)
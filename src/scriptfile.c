@@ -1214,6 +1214,9 @@ do_source(
     do_cmdline(firstline, getsourceline, (void *)&cookie,
 				     DOCMD_VERBOSE|DOCMD_NOWAIT|DOCMD_REPEAT);
     retval = OK;
+#ifdef SYN_CACHE
+    syn_cache_done(current_sctx.sc_sid);
+#endif
 
 #ifdef FEAT_PROFILE
     if (do_profiling == PROF_YES)
@@ -633,6 +633,8 @@ searchit(
     proftime_T	*tm = NULL;	// timeout limit or NULL
     int		*timed_out = NULL;  // set when timed out or NULL
 #endif
+    linenr_T	resume_lnum = 0;    // continue in this line when != 0
+    int		first_loop = 0;
 
     if (extra_arg != NULL)
     {
@@ -641,6 +643,9 @@ searchit(
 	tm = extra_arg->sa_tm;
 	timed_out = &extra_arg->sa_timed_out;
 #endif
+	resume_lnum = extra_arg->sa_resume_lnum;
+	first_loop = extra_arg->sa_resume_loop;
+	extra_arg->sa_resume_lnum = 0;
     }
 
     if (search_regcomp(pat, RE_SEARCH, pat_use,
@@ -668,7 +673,7 @@ searchit(
 						    && pos->col < MAXCOL - 2)
 	{
 	    ptr = ml_get_buf(buf, pos->lnum, FALSE);
-	    if ((int)STRLEN(ptr) <= pos->col)
+	    if ((int)ml_get_buf_len(buf, pos->lnum) <= pos->col)
 		start_char_len = 1;
 	    else
 		start_char_len = (*mb_ptr2len)(ptr + pos->col);
@@ -716,7 +721,19 @@ searchit(
 	else
 	    lnum = pos->lnum;
 
-	for (loop = 0; loop <= 1; ++loop)   // loop twice if 'wrapscan' set
+	if (resume_lnum != 0)
+	{
+	    // Continue where a previous search stopped, the lines before
+	    // "resume_lnum" have no match.
+	    lnum = resume_lnum;
+	    at_first_line = FALSE;
+	    resume_lnum = 0;
+	}
+	else
+	    first_loop = 0;
+
+	// loop twice if 'wrapscan' set
+	for (loop = first_loop; loop <= 1; ++loop)
 	{
 	    for ( ; lnum > 0 && lnum <= buf->b_ml.ml_line_count;
 					   lnum += dir, at_first_line = FALSE)
@@ -726,9 +743,15 @@ searchit(
 				       ? lnum > stop_lnum : lnum < stop_lnum))
 		    break;
 #ifdef FEAT_RELTIME
-		// Stop after passing the "tm" time limit.
+		// Stop after passing the "tm" time limit.  The search can be
+		// continued in this line.
 		if (tm != NULL && profile_passed_limit(tm))
+		{
+		    *timed_out = TRUE;
+		    extra_arg->sa_resume_lnum = lnum;
+		    extra_arg->sa_resume_loop = loop;
 		    break;
+		}
 #endif
 
 		/*
@@ -744,8 +767,9 @@ searchit(
 					     NULL, NULL
 #endif
 						      );
-		// Abort searching on an error (e.g., out of stack).
-		if (called_emsg
+		// Abort searching on an error (e.g., out of stack) or when the
+		// time limit of regexp_timeout_start() passed.
+		if (called_emsg || regexp_timed_out()
 #ifdef FEAT_RELTIME
 			|| (timed_out != NULL && *timed_out)
 #endif
@@ -987,8 +1011,7 @@ searchit(
 			    if (pos->lnum > 1)  // just in case
 			    {
 				--pos->lnum;
-				pos->col = (colnr_T)STRLEN(ml_get_buf(buf,
-							   pos->lnum, FALSE));
+				pos->col = ml_get_buf_len(buf, pos->lnum);
 			    }
 			}
 			else
@@ -1032,21 +1055,36 @@ searchit(
 		if (got_int)
 		    break;
 
+		if (loop && lnum == start_pos.lnum)
+		    break;	    // if second loop, stop where started
+
 #ifdef FEAT_SEARCH_EXTRA
 		// Cancel searching if a character was typed.  Used for
 		// 'incsearch'.  Don't check too often, that would slowdown
-		// searching too much.
+		// searching too much.  The search can be continued in the
+		// next line.
 		if ((options & SEARCH_PEEK)
 			&& ((lnum - pos->lnum) & 0x3f) == 0
 			&& char_avail())
 		{
 		    break_loop = TRUE;
+		    if (extra_arg != NULL)
+		    {
+			if (lnum + dir > 0)
+			{
+			    extra_arg->sa_resume_lnum = lnum + dir;
+			    extra_arg->sa_resume_loop = loop;
+			}
+			else if (p_ws && loop == 0)
+			{
+			    // continue at the end of the buffer
+			    extra_arg->sa_resume_lnum = buf->b_ml.ml_line_count;
+			    extra_arg->sa_resume_loop = 1;
+			}
+		    }
 		    break;
 		}
 #endif
-
-		if (loop && lnum == start_pos.lnum)
-		    break;	    // if second loop, stop where started
 	    }
 	    at_first_line = FALSE;
 
@@ -1056,6 +1094,7 @@ searchit(
 	     * twice.
 	     */
 	    if (!p_ws || stop_lnum != 0 || got_int || called_emsg
+				|| regexp_timed_out()
 #ifdef FEAT_RELTIME
 				|| (timed_out != NULL && *timed_out)
 #endif
@@ -1082,7 +1121,7 @@ searchit(
 	    if (extra_arg != NULL)
 		extra_arg->sa_wrapped = TRUE;
 	}
-	if (got_int || called_emsg
+	if (got_int || called_emsg || regexp_timed_out()
 #ifdef FEAT_RELTIME
 		|| (timed_out != NULL && *timed_out)
 #endif
@@ -1120,7 +1159,7 @@ searchit(
     if (pos->lnum > buf->b_ml.ml_line_count)
     {
 	pos->lnum = buf->b_ml.ml_line_count;
-	pos->col = (int)STRLEN(ml_get_buf(buf, pos->lnum, FALSE));
+	pos->col = ml_get_buf_len(buf, pos->lnum);
 	if (pos->col > 0)
 	    --pos->col;
     }
@@ -2326,7 +2365,7 @@ findmatchlimit(
 		    break;
 
 		linep = ml_get(pos.lnum);
-		pos.col = (colnr_T)STRLEN(linep); // pos.col on trailing NUL
+		pos.col = ml_get_len(pos.lnum); // pos.col on trailing NUL
 		do_quotes = -1;
 		line_breakcheck();
 
@@ -3038,7 +3077,7 @@ findpar(
 
 	// Put the cursor on the last character in the last line and make the
 	// motion inclusive.
-	if ((curwin->w_cursor.col = (colnr_T)STRLEN(line)) != 0)
+	if ((curwin->w_cursor.col = ml_get_len(curr)) != 0)
 	{
 	    --curwin->w_cursor.col;
 	    curwin->w_cursor.col -=
@@ -4944,8 +4983,7 @@ current_search(
 		// try again from end of buffer
 		// searching backwards, so set pos to last line and col
 		pos.lnum = curwin->w_buffer->b_ml.ml_line_count;
-		pos.col  = (colnr_T)STRLEN(
-				ml_get(curwin->w_buffer->b_ml.ml_line_count));
+		pos.col  = ml_get_len(curwin->w_buffer->b_ml.ml_line_count);
 	    }
 	}
     }
@@ -504,7 +504,10 @@ struct block_hdr
 
 #define BH_DIRTY    1
 #define BH_LOCKED   2
-    char	bh_flags;	    // BH_DIRTY or BH_LOCKED
+#define BH_REF	    4		    // used since the clock hand passed
+#define BH_COMPRESSED 8		    // bh_data is compressed
+    char	bh_flags;	    // BH_DIRTY, BH_LOCKED, BH_REF or
+				    // BH_COMPRESSED
 };
 
 /*
@@ -640,6 +643,32 @@ typedef struct
 
 #define MF_SEED_LEN	8
 
+/*
+ * A data block of a file that is loaded lazily (see 'lazyload').
+ */
+typedef struct mf_lazyblock_S
+{
+    off_T	lb_offset;	// offset of the first line in the file
+    long	lb_size;	// number of bytes, including line breaks
+    linenr_T	lb_line_count;	// number of lines in the block
+    int		lb_page_count;	// number of pages for the data block
+} mf_lazyblock_T;
+
+/*
+ * Info for a memfile of which the data blocks are read from the original
+ * file when they are needed.  Block "lz_first" is the first entry in
+ * "lz_blocks", block "lz_first - 1" the second entry, etc.  A block that is
+ * changed gets a positive number and from then on is a normal block.
+ */
+typedef struct mf_lazy_S
+{
+    int		    lz_fd;		// file descriptor of the original file
+    blocknr_T	    lz_first;		// block number of first entry
+    long	    lz_count;		// number of entries in lz_blocks
+    mf_lazyblock_T  *lz_blocks;		// allocated array of blocks
+    int		    lz_error;		// TRUE when a read error was given
+} mf_lazy_T;
+
 struct memfile
 {
     char_u	*mf_fname;		// name of the file
@@ -660,6 +689,10 @@ struct memfile
     blocknr_T	mf_infile_count;	// number of pages in the file
     unsigned	mf_page_size;		// number of bytes in a page
     int		mf_dirty;		// TRUE if there are dirty blocks
+    mf_lazy_T	*mf_lazy;		// lazily loaded file or NULL
+    long	mf_id;			// unique number of this memfile
+    long	mf_evicted;		// number of pages released from memory
+    long	mf_zcount;		// number of pages that are compressed
 #ifdef FEAT_CRYPT
     buf_T	*mf_buffer;		// buffer this memfile is for
     char_u	mf_seed[MF_SEED_LEN];	// seed for encryption
@@ -688,6 +721,19 @@ typedef struct info_pointer
     int		ip_index;	// index for block with current lnum
 } infoptr_T;	// block/index pair
 
+/*
+ * Data blocks that were used recently are kept locked, so that going back to
+ * them does not require searching the tree of pointer blocks.
+ */
+typedef struct ml_cacheblock
+{
+    bhdr_T	*mc_hp;		// locked data block
+    linenr_T	mc_low;		// first line in the block
+    linenr_T	mc_high;	// last line in the block
+} mlcache_T;
+
+#define ML_CACHE_SIZE	8	// max nr of blocks in ml_cache
+
 #ifdef FEAT_BYTEOFF
 typedef struct ml_chunksize
 {
@@ -720,9 +766,12 @@ typedef struct memline
 #define ML_LINE_DIRTY	2	// cached line was changed and allocated
 #define ML_LOCKED_DIRTY	4	// ml_locked was changed
 #define ML_LOCKED_POS	8	// ml_locked needs positive block number
+#define ML_LOCKED_NOSTACK 16	// ml_stack does not lead to ml_locked
     int		ml_flags;
 
     colnr_T	ml_line_len;	// length of the cached line, including NUL
+    colnr_T	ml_line_textlen; // length of the cached text, including NUL,
+				 // zero if not known yet
     linenr_T	ml_line_lnum;	// line number of cached line, 0 if not valid
     char_u	*ml_line_ptr;	// pointer to cached line
 
@@ -730,10 +779,20 @@ typedef struct memline
     linenr_T	ml_locked_low;	// first line in ml_locked
     linenr_T	ml_locked_high;	// last line in ml_locked
     int		ml_locked_lineadd;  // number of lines inserted in ml_locked
+
+    mlcache_T	ml_cache[ML_CACHE_SIZE]; // recently used data blocks, most
+					 // recently used first
+    int		ml_cache_count;	// number of entries in ml_cache
+    long	ml_cache_hits;	// lookups found in ml_locked or ml_cache
+    long	ml_cache_misses; // lookups that searched the tree
 #ifdef FEAT_BYTEOFF
     chunksize_T *ml_chunksize;
     int		ml_numchunks;
     int		ml_usedchunks;
+    chunksize_T *ml_chunktree;	// Fenwick tree with the sums of
+				// ml_chunksize[], index 1 is the first
+    int		ml_chunktree_len; // nr of chunks in ml_chunktree, zero when
+				  // it must be rebuilt
 #endif
 } memline_T;
 
@@ -2145,10 +2204,16 @@ typedef enum {
  * These are items normally related to a buffer.  But when using ":ownsyntax"
  * a window may have its own instance.
  */
+// Keywords compiled into a trie, defined in syntax.c.
+typedef struct kwtrie_S kwtrie_T;
+
 typedef struct {
 #ifdef FEAT_SYN_HL
     hashtab_T	b_keywtab;		// syntax keywords hash table
     hashtab_T	b_keywtab_ic;		// idem, ignore case
+    kwtrie_T	*b_kwtrie;		// b_keywtab as a trie, NULL when it
+					// needs to be built
+    kwtrie_T	*b_kwtrie_ic;		// idem, ignore case
     int		b_syn_error;		// TRUE when error occurred in HL
 # ifdef FEAT_RELTIME
     int		b_syn_slow;		// TRUE when 'redrawtime' reached
@@ -2222,6 +2287,42 @@ typedef struct {
 } synblock_T;
 
 
+#ifdef FEAT_SEARCH_EXTRA
+/*
+ * Cached result of searching for a 'hlsearch' or match pattern in a line,
+ * starting at a column.  See next_search_hl().
+ */
+typedef struct hlcache_entry_S hlcache_entry_T;
+struct hlcache_entry_S
+{
+    hlcache_entry_T *hce_next;	    // next entry in the same hash bucket
+    linenr_T	hce_lnum;	    // line searched in
+    colnr_T	hce_col;	    // column the search started at
+    long	hce_nmatched;	    // result of vim_regexec_multi()
+    lpos_T	hce_startpos;	    // start of the match, relative to lnum
+    lpos_T	hce_endpos;	    // end of the match, relative to lnum
+};
+
+#define HLCACHE_HASH_SIZE 256	// number of hash buckets, power of two
+
+/*
+ * Cached search results for one pattern in a buffer.  Entries are removed
+ * when lines change, see hlcache_changed().
+ */
+typedef struct hlcache_S hlcache_T;
+struct hlcache_S
+{
+    hlcache_T	*hc_next;	    // next pattern for the same buffer
+    regprog_T	*hc_prog;	    // the pattern, holds a reference
+    int		hc_ic;		    // "rmm_ic" used
+    colnr_T	hc_maxcol;	    // "rmm_maxcol" used
+    int		hc_chartab_tick;    // "chartab_tick" used
+    char_u	hc_chartab[32];	    // 'iskeyword' of the buffer used
+    int		hc_count;	    // number of entries
+    hlcache_entry_T *hc_hash[HLCACHE_HASH_SIZE];
+};
+#endif
+
 /*
  * buffer: structure that holds information about one file
  *
@@ -2340,6 +2441,10 @@ struct file_buffer
      */
     char_u	b_chartab[32];
 
+#ifdef FEAT_SEARCH_EXTRA
+    hlcache_T	*b_hlcache;	// cached 'hlsearch' and match results
+#endif
+
     // Table used for mappings local to a buffer.
     mapblock_T	*(b_maphash[256]);
 
@@ -3163,6 +3268,12 @@ struct window_S
     linenr_T	w_redraw_top;	    // when != 0: first line needing redraw
     linenr_T	w_redraw_bot;	    // when != 0: last line needing redraw
     int		w_redr_status;	    // if TRUE status line must be redrawn
+#ifdef SYN_TIME_LIMIT
+    linenr_T	w_syn_defer_top;    // when != 0: first line drawn without
+				    // syntax highlighting for 'syndefer'
+    linenr_T	w_syn_defer_bot;    // last line drawn like that
+    varnumber_T	w_syn_defer_tick;   // b:changedtick when they were drawn
+#endif
 
 #ifdef FEAT_CMDL_INFO
     // remember what is shown in the ruler for this window (if 'ruler' set)
@@ -3895,6 +4006,9 @@ typedef struct
     int		sa_timed_out;	// set when timed out
 #endif
     int		sa_wrapped;	// search wrapped around
+    linenr_T	sa_resume_lnum;	// when != 0: continue a search in this line;
+				// set when stopped before the search was done
+    int		sa_resume_loop;	// 'wrapscan' loop for "sa_resume_lnum"
 } searchit_arg_T;
 
 #define WRITEBUFSIZE	8192	// size of normal write buffer
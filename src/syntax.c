@@ -47,6 +47,7 @@ typedef struct syn_pattern
 {
     char	 sp_type;		/* see SPTYPE_ defines below */
     char	 sp_syncing;		/* this item used for syncing */
+    char	 sp_has_first;		// sp_first is valid
     short	 sp_syn_match_id;	/* highlight group ID of pattern */
     short	 sp_off_flags;		/* see below */
     int		 sp_offsets[SPO_COUNT];	/* offsets */
@@ -63,6 +64,7 @@ typedef struct syn_pattern
     struct sp_syn sp_syn;		/* struct passed to in_id_list() */
     char_u	*sp_pattern;		/* regexp to match, pattern */
     regprog_T	*sp_prog;		/* regexp to match, program */
+    char_u	 sp_first[32];		// bytes a match can start with
 #ifdef FEAT_PROFILE
     syn_time_T	 sp_time;
 #endif
@@ -167,6 +169,32 @@ static keyentry_T dumkey;
 #define HIKEY2KE(p)   ((keyentry_T *)((p) - (dumkey.keyword - (char_u *)&dumkey)))
 #define HI2KE(hi)      HIKEY2KE((hi)->hi_key)
 
+/*
+ * For finding keywords the keyword hashtable is compiled into a trie, so that
+ * the text can be checked without copying it and a word that doesn't start
+ * like a keyword is rejected after a few bytes.  The edges of each node are
+ * sorted by byte, the root node also has a table indexed by byte.
+ */
+typedef struct
+{
+    int		kn_edge;	// index of the first edge in kt_edges[]
+    int		kn_nedges;	// number of edges
+    keyentry_T	*kn_kp;		// keywords that end here or NULL
+} kwnode_T;
+
+typedef struct
+{
+    char_u	kw_byte;	// byte for this edge
+    int		kw_node;	// index of the node in kt_nodes[]
+} kwedge_T;
+
+struct kwtrie_S
+{
+    kwnode_T	*kt_nodes;	// kt_nodes[0] is the root
+    kwedge_T	*kt_edges;
+    int		kt_root[256];	// node for the first byte, -1 if none
+};
+
 /*
  * To reduce the time spent in keepend(), remember at which level in the state
  * stack the first item with "keepend" is present.  When "-1", there is no
@@ -267,6 +295,23 @@ static synblock_T *syn_block;		/* current buffer for highlighting */
 #ifdef FEAT_RELTIME
 static proftime_T *syn_tm;		/* timeout limit */
 #endif
+#ifdef SYN_TIME_LIMIT
+static proftime_T *syn_defer_tm;	// limit for 'syndefer'
+static int	syn_defer_drawn;	// nr of lines highlighted before it
+static int	syn_deferring;		// TRUE when past the limit
+#endif
+
+// What syn_idle_parse() was doing, to continue where it stopped.  When any
+// of the window, buffer, change or displayed lines differ it starts again.
+static win_T	    *idle_win = NULL;
+static buf_T	    *idle_buf = NULL;
+static synblock_T   *idle_block = NULL;
+static varnumber_T  idle_changedtick = 0;
+static linenr_T	    idle_topline = 0;
+static linenr_T	    idle_botline = 0;
+static linenr_T	    idle_fwd_lnum = 0;	// parsed until this line below
+static linenr_T	    idle_back_lnum = 0;	// parsed until this line above
+static int	    idle_done = FALSE;	// nothing left to do
 static linenr_T current_lnum = 0;	/* lnum of current state */
 static colnr_T	current_col = 0;	/* column of current state */
 static int	current_state_stored = 0; /* TRUE if stored current state
@@ -285,6 +330,7 @@ static int syn_match_linecont(linenr_T lnum);
 static void syn_start_line(void);
 static void syn_update_ends(int startofline);
 static void syn_stack_alloc(void);
+static int syn_stack_dist(synblock_T *block, buf_T *buf);
 static int syn_stack_cleanup(void);
 static void syn_stack_free_entry(synblock_T *block, synstate_T *p);
 static synstate_T *syn_stack_find_entry(linenr_T lnum);
@@ -324,6 +370,7 @@ static void limit_pos_zero(lpos_T *pos, lpos_T *limit);
 static void syn_add_end_off(lpos_T *result, regmmatch_T *regmatch, synpat_T *spp, int idx, int extra);
 static void syn_add_start_off(lpos_T *result, regmmatch_T *regmatch, synpat_T *spp, int idx, int extra);
 static char_u *syn_getcurline(void);
+static int syn_first_col(synpat_T *spp, int col);
 static int syn_regexec(regmmatch_T *rmp, linenr_T lnum, colnr_T col, syn_time_T *st);
 static int check_keyword_id(char_u *line, int startcol, int *endcol, long *flags, short **next_list, stateitem_T *cur_si, int *ccharp);
 static void syn_remove_pattern(synblock_T *block, int idx);
@@ -340,6 +387,7 @@ static void put_pattern(char *s, int c, synpat_T *spp, int attr);
 static int syn_list_keywords(int id, hashtab_T *ht, int did_header, int attr);
 static void syn_clear_keyword(int id, hashtab_T *ht);
 static void clear_keywtab(hashtab_T *ht);
+static void kwtrie_clear(synblock_T *block);
 static int syn_scl_namen2id(char_u *linep, int len);
 static int syn_check_cluster(char_u *pp, int len);
 static int syn_add_cluster(char_u *name);
@@ -360,6 +408,107 @@ syn_set_timeout(proftime_T *tm)
 }
 #endif
 
+#if defined(SYN_TIME_LIMIT) || defined(PROTO)
+/*
+ * Set the time limit for 'syndefer', for redrawing one window.
+ * Use NULL to reset, no limit.
+ */
+    void
+syn_set_defer(proftime_T *tm)
+{
+    syn_defer_tm = tm;
+    syn_defer_drawn = 0;
+    syn_deferring = FALSE;
+}
+
+/*
+ * Return TRUE when line "lnum" of window "wp" is to be drawn without syntax
+ * highlighting, because the 'syndefer' time has passed.  The line is
+ * remembered, syn_redraw_deferred() will draw it again later.
+ * At least one line is highlighted, so that redrawing makes progress.
+ */
+    int
+syn_defer_line(win_T *wp, linenr_T lnum)
+{
+    if (!syn_deferring)
+    {
+	if (syn_defer_tm == NULL || syn_defer_drawn == 0
+					  || !profile_passed_limit(syn_defer_tm))
+	{
+	    ++syn_defer_drawn;
+	    return FALSE;
+	}
+	syn_deferring = TRUE;
+    }
+
+    if (wp->w_syn_defer_top == 0 || wp->w_syn_defer_top > lnum)
+	wp->w_syn_defer_top = lnum;
+    if (wp->w_syn_defer_bot < lnum)
+	wp->w_syn_defer_bot = lnum;
+    wp->w_syn_defer_tick = CHANGEDTICK(wp->w_buffer);
+    return TRUE;
+}
+
+/*
+ * Return TRUE when lines are being drawn without syntax highlighting, because
+ * the 'syndefer' time has passed.
+ */
+    int
+syn_is_deferring(void)
+{
+    return syn_deferring;
+}
+
+/*
+ * Redraw the lines that were drawn without syntax highlighting because of
+ * 'syndefer'.  Called when waiting for a typed character.
+ * Returns TRUE when something was redrawn.
+ */
+    int
+syn_redraw_deferred(void)
+{
+    win_T	*wp;
+    linenr_T	top;
+    linenr_T	bot;
+    int		did_redraw = FALSE;
+
+    if (State == HITRETURN || State == ASKMORE || msg_scrolled != 0
+							       || !redrawing())
+	return FALSE;
+
+    FOR_ALL_WINDOWS(wp)
+    {
+	if (wp->w_syn_defer_top == 0)
+	    continue;
+	top = wp->w_syn_defer_top;
+	bot = wp->w_syn_defer_bot;
+	// After a change the lines may have moved, redraw until the end of
+	// the window.
+	if (wp->w_syn_defer_tick != CHANGEDTICK(wp->w_buffer))
+	    bot = MAXLNUM;
+	wp->w_syn_defer_top = 0;
+	wp->w_syn_defer_bot = 0;
+
+	if (top < wp->w_topline)
+	    top = wp->w_topline;
+	if (bot >= wp->w_botline)
+	    bot = wp->w_botline - 1;
+	if (top > bot)
+	    continue;
+	if (wp->w_redraw_top == 0 || wp->w_redraw_top > top)
+	    wp->w_redraw_top = top;
+	if (wp->w_redraw_bot < bot)
+	    wp->w_redraw_bot = bot;
+	redraw_win_later(wp, VALID);
+	did_redraw = TRUE;
+    }
+
+    if (did_redraw)
+	redraw_after_callback(TRUE);
+    return did_redraw;
+}
+#endif
+
 /*
  * Start the syntax recognition for a line.  This function is normally called
  * from the screen updating, once for each displayed line.
@@ -476,10 +625,7 @@ syntax_start(win_T *wp, linenr_T lnum)
      * Advance from the sync point or saved state until the current line.
      * Save some entries for syncing with later on.
      */
-    if (syn_block->b_sst_len <= Rows)
-	dist = 999999;
-    else
-	dist = syn_buf->b_ml.ml_line_count / (syn_block->b_sst_len - Rows) + 1;
+    dist = syn_stack_dist(syn_block, syn_buf);
     while (current_lnum < lnum)
     {
 	syn_start_line();
@@ -542,6 +688,147 @@ syntax_start(win_T *wp, linenr_T lnum)
     syn_start_line();
 }
 
+/*
+ * Find the last valid saved state for a line after "after" and not after
+ * "upto".  Returns NULL if there is none.
+ */
+    static synstate_T *
+syn_idle_find_state(synblock_T *block, linenr_T after, linenr_T upto)
+{
+    synstate_T	*p;
+    synstate_T	*found = NULL;
+
+    for (p = block->b_sst_first; p != NULL; p = p->sst_next)
+    {
+	if (p->sst_lnum > upto)
+	    break;
+	if (p->sst_lnum > after && p->sst_change_lnum == 0)
+	    found = p;
+    }
+    return found;
+}
+
+/*
+ * Use the time spent waiting for a typed character to parse the syntax of
+ * lines below and above the current window, saving states on the way.  When
+ * later jumping or scrolling there a saved state is found nearby, instead of
+ * having to sync and parse many lines.
+ * Lines below the window are parsed until the end of the buffer, lines above
+ * it for SYN_IDLE_PAGES window heights.  Lines with a valid saved state
+ * nearby are skipped.
+ * Stops after about SYN_IDLE_MSEC msec, the next call continues from there.
+ * Returns TRUE when there is more to parse.
+ */
+    int
+syn_idle_parse(void)
+{
+    win_T	*wp = curwin;
+    buf_T	*buf = wp->w_buffer;
+    synblock_T	*block = wp->w_s;
+    synstate_T	*sp;
+    linenr_T	lnum;
+    linenr_T	back_limit;
+    long	step;
+#ifdef FEAT_RELTIME
+    proftime_T	tm;
+#endif
+
+    if (!syntax_present(wp) || block->b_syn_slow || block->b_syn_error
+						  || buf->b_ml.ml_mfp == NULL)
+	return FALSE;
+
+    if (idle_win != wp || idle_buf != buf || idle_block != block
+	    || idle_changedtick != CHANGEDTICK(buf)
+	    || idle_topline != wp->w_topline
+	    || idle_botline != wp->w_botline)
+    {
+	idle_win = wp;
+	idle_buf = buf;
+	idle_block = block;
+	idle_changedtick = CHANGEDTICK(buf);
+	idle_topline = wp->w_topline;
+	idle_botline = wp->w_botline;
+	idle_fwd_lnum = wp->w_botline;
+	idle_back_lnum = wp->w_topline;
+	idle_done = FALSE;
+    }
+    if (idle_done)
+	return FALSE;
+
+    // syntax_start() allocates the state stack, needed to know the distance
+    // between saved states.
+    if (block->b_sst_array == NULL && idle_fwd_lnum <= buf->b_ml.ml_line_count)
+	syntax_start(wp, idle_fwd_lnum);
+    if (block->b_sst_array == NULL)
+	return FALSE;
+
+#ifdef FEAT_RELTIME
+    profile_setlimit(SYN_IDLE_MSEC, &tm);
+#endif
+    while (idle_fwd_lnum < buf->b_ml.ml_line_count)
+    {
+	lnum = idle_fwd_lnum + syn_stack_dist(block, buf);
+	if (lnum > buf->b_ml.ml_line_count)
+	    lnum = buf->b_ml.ml_line_count;
+	sp = syn_idle_find_state(block, idle_fwd_lnum, lnum);
+	if (sp != NULL)
+	{
+	    idle_fwd_lnum = sp->sst_lnum;
+	    continue;
+	}
+
+	// Continue with the current state when possible, otherwise start at
+	// the last parsed line, which normally loads its saved state.
+	if (INVALID_STATE(&current_state) || syn_buf != buf
+		|| syn_block != block || current_lnum != idle_fwd_lnum)
+	    syntax_start(wp, idle_fwd_lnum);
+	syntax_start(wp, lnum);
+	idle_fwd_lnum = lnum;
+	if (got_int)
+	    goto interrupted;
+#ifdef FEAT_RELTIME
+	if (profile_passed_limit(&tm))
+#endif
+	    return TRUE;
+    }
+
+    // Lines above the window are only useful to parse when syncing starts
+    // further back than a saved state found within "minlines".
+    step = block->b_syn_sync_minlines;
+    if (step > syn_stack_dist(block, buf))
+	step = syn_stack_dist(block, buf);
+    back_limit = wp->w_topline - SYN_IDLE_PAGES * wp->w_height;
+    while (step > 0 && idle_back_lnum - step > back_limit
+						    && idle_back_lnum - step >= 1)
+    {
+	sp = syn_idle_find_state(block, idle_back_lnum - step - 1,
+							  idle_back_lnum - 1);
+	if (sp != NULL)
+	{
+	    idle_back_lnum = sp->sst_lnum;
+	    continue;
+	}
+
+	idle_back_lnum -= step;
+	syntax_start(wp, idle_back_lnum);
+	if (got_int)
+	    goto interrupted;
+#ifdef FEAT_RELTIME
+	if (profile_passed_limit(&tm))
+#endif
+	    return TRUE;
+    }
+
+    idle_done = TRUE;
+    return FALSE;
+
+interrupted:
+    // The current state is wrong when parsing was interrupted.
+    invalidate_current_state();
+    idle_done = TRUE;
+    return FALSE;
+}
+
 /*
  * We cannot simply discard growarrays full of state_items or buf_states; we
  * have to manually release their extmatch pointers first.
@@ -1052,6 +1339,9 @@ syn_stack_free_block(synblock_T *block)
 	block->b_sst_first = NULL;
 	block->b_sst_len = 0;
     }
+    // The states parsed when idle are gone, need to start again.
+    if (idle_block == block)
+	idle_win = NULL;
 }
 /*
  * Free b_sst_array[] for buffer "buf".
@@ -1155,6 +1445,18 @@ syn_stack_alloc(void)
     }
 }
 
+/*
+ * Return the normal distance between saved states for lines that are not
+ * displayed.
+ */
+    static int
+syn_stack_dist(synblock_T *block, buf_T *buf)
+{
+    if (block->b_sst_len <= Rows)
+	return 999999;
+    return buf->b_ml.ml_line_count / (block->b_sst_len - Rows) + 1;
+}
+
 /*
  * Check for changes in a buffer to affect stored syntax states.  Uses the
  * b_mod_* fields.
@@ -1237,10 +1539,7 @@ syn_stack_cleanup(void)
 	return retval;
 
     /* Compute normal distance between non-displayed entries. */
-    if (syn_block->b_sst_len <= Rows)
-	dist = 999999;
-    else
-	dist = syn_buf->b_ml.ml_line_count / (syn_block->b_sst_len - Rows) + 1;
+    dist = syn_stack_dist(syn_block, syn_buf);
 
     /*
      * Go through the list to find the "tick" for the oldest entry that can
@@ -1982,6 +2281,18 @@ syn_current_attr(
 			    if (lc_col < 0)
 				lc_col = 0;
 
+			    // Start matching where the first byte of a match
+			    // is, skip the pattern when there is none.
+			    if (spp->sp_has_first)
+			    {
+				lc_col = syn_first_col(spp, lc_col);
+				if (lc_col < 0)
+				{
+				    spp->sp_startcol = MAXCOL;
+				    continue;
+				}
+			    }
+
 			    regmatch.rmm_ic = spp->sp_ic;
 			    regmatch.regprog = spp->sp_prog;
 			    r = syn_regexec(&regmatch,
@@ -3223,6 +3534,259 @@ syn_regexec(
     return FALSE;
 }
 
+/*
+ * Compare function for qsort(): sort keyword entries on their keyword.
+ */
+    static int
+kwtrie_compare(const void *s1, const void *s2)
+{
+    return STRCMP((*(keyentry_T **)s1)->keyword,
+					       (*(keyentry_T **)s2)->keyword);
+}
+
+/*
+ * Add the node for keywords "keys[lo]" to "keys[hi - 1]", which all start
+ * with the same "depth" bytes, and the nodes below it.
+ * Returns the index of the node.
+ */
+    static int
+kwtrie_add_node(
+    kwtrie_T	*trie,
+    keyentry_T	**keys,
+    int		lo,
+    int		hi,
+    int		depth,
+    int		*nodecount,
+    int		*edgecount)
+{
+    int		node = (*nodecount)++;
+    int		edge;
+    int		i, j;
+    int		n = 0;
+
+    trie->kt_nodes[node].kn_kp = NULL;
+    if (lo < hi && keys[lo]->keyword[depth] == NUL)
+	trie->kt_nodes[node].kn_kp = keys[lo++];
+
+    // The edges of a node must be together, count them first.
+    for (i = lo; i < hi; i = j)
+    {
+	for (j = i + 1; j < hi
+		  && keys[j]->keyword[depth] == keys[i]->keyword[depth]; ++j)
+	    ;
+	++n;
+    }
+    edge = *edgecount;
+    *edgecount += n;
+    trie->kt_nodes[node].kn_edge = edge;
+    trie->kt_nodes[node].kn_nedges = n;
+
+    for (i = lo; i < hi; i = j)
+    {
+	for (j = i + 1; j < hi
+		  && keys[j]->keyword[depth] == keys[i]->keyword[depth]; ++j)
+	    ;
+	trie->kt_edges[edge].kw_byte = keys[i]->keyword[depth];
+	trie->kt_edges[edge].kw_node = kwtrie_add_node(trie, keys, i, j,
+					       depth + 1, nodecount, edgecount);
+	++edge;
+    }
+    return node;
+}
+
+/*
+ * Build the trie for the keywords in hashtable "ht".
+ * Returns NULL when out of memory.
+ */
+    static kwtrie_T *
+kwtrie_build(hashtab_T *ht)
+{
+    kwtrie_T	*trie;
+    keyentry_T	**keys;
+    hashitem_T	*hi;
+    int		todo;
+    int		count = 0;
+    long	maxnodes = 1;
+    int		nodecount = 0;
+    int		edgecount = 0;
+    int		i;
+
+    keys = ALLOC_MULT(keyentry_T *, ht->ht_used);
+    trie = ALLOC_CLEAR_ONE(kwtrie_T);
+    if (keys == NULL || trie == NULL)
+    {
+	vim_free(keys);
+	vim_free(trie);
+	return NULL;
+    }
+
+    todo = (int)ht->ht_used;
+    for (hi = ht->ht_array; todo > 0; ++hi)
+	if (!HASHITEM_EMPTY(hi))
+	{
+	    --todo;
+	    keys[count++] = HI2KE(hi);
+	    maxnodes += (long)STRLEN(HI2KE(hi)->keyword);
+	}
+    qsort((void *)keys, (size_t)count, sizeof(keyentry_T *), kwtrie_compare);
+
+    // Each byte of a keyword adds at most one node and one edge.
+    trie->kt_nodes = ALLOC_MULT(kwnode_T, maxnodes);
+    trie->kt_edges = ALLOC_MULT(kwedge_T, maxnodes);
+    if (trie->kt_nodes == NULL || trie->kt_edges == NULL)
+    {
+	vim_free(trie->kt_nodes);
+	vim_free(trie->kt_edges);
+	vim_free(trie);
+	vim_free(keys);
+	return NULL;
+    }
+    (void)kwtrie_add_node(trie, keys, 0, count, 0, &nodecount, &edgecount);
+    vim_free(keys);
+
+    for (i = 0; i < 256; ++i)
+	trie->kt_root[i] = -1;
+    for (i = 0; i < trie->kt_nodes[0].kn_nedges; ++i)
+	trie->kt_root[trie->kt_edges[i].kw_byte] = trie->kt_edges[i].kw_node;
+    return trie;
+}
+
+/*
+ * Free one keyword trie.
+ */
+    static void
+kwtrie_free(kwtrie_T **trie)
+{
+    if (*trie != NULL)
+    {
+	vim_free((*trie)->kt_nodes);
+	vim_free((*trie)->kt_edges);
+	VIM_CLEAR(*trie);
+    }
+}
+
+/*
+ * Free the keyword tries of "block", they are built again when needed.
+ * Must be called when keywords are added or removed.
+ */
+    static void
+kwtrie_clear(synblock_T *block)
+{
+    kwtrie_free(&block->b_kwtrie);
+    kwtrie_free(&block->b_kwtrie_ic);
+}
+
+/*
+ * Return the node below "node" for byte "c", -1 if there is none.
+ */
+    static int
+kwtrie_next(kwtrie_T *trie, int node, int c)
+{
+    kwedge_T	*edges;
+    int		lo, hi, mid;
+
+    if (node == 0)
+	return trie->kt_root[c];
+    edges = trie->kt_edges + trie->kt_nodes[node].kn_edge;
+    hi = trie->kt_nodes[node].kn_nedges;
+    if (hi == 1)
+	return edges[0].kw_byte == c ? edges[0].kw_node : -1;
+    lo = 0;
+    while (lo < hi)
+    {
+	mid = (lo + hi) / 2;
+	if (edges[mid].kw_byte == c)
+	    return edges[mid].kw_node;
+	if (edges[mid].kw_byte < c)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return -1;
+}
+
+/*
+ * Find the keyword that starts at "kwp" in "trie".  When "ic" is TRUE each
+ * character is case-folded like str_foldcase() does.
+ * Returns the list of keyword entries and sets "*kwlenp" to the length of the
+ * keyword in the text.  Returns NULL when not found.
+ */
+    static keyentry_T *
+kwtrie_find(kwtrie_T *trie, char_u *kwp, int ic, int *kwlenp)
+{
+    int		node = 0;
+    int		kwlen = 0;
+    int		clen;
+    char_u	*s;
+    int		slen;
+    char_u	folded[MB_MAXBYTES + 1];
+    int		c, lc;
+    int		i;
+
+    do
+    {
+	s = kwp + kwlen;
+	if (*s < 0x80 && !(ic && ASCII_ISUPPER(*s)))
+	{
+	    // Fast path: ASCII that does not need folding.
+	    node = kwtrie_next(trie, node, *s);
+	    if (node < 0)
+		return NULL;
+	    ++kwlen;
+	    continue;
+	}
+	clen = has_mbyte ? (*mb_ptr2len)(s) : 1;
+	slen = clen;
+	if (ic)
+	{
+	    if (enc_utf8)
+	    {
+		c = utf_ptr2char(s);
+		lc = utf_tolower(c);
+		if ((c < 0x80 || clen > 1) && c != lc)
+		{
+		    slen = utf_char2bytes(lc, folded);
+		    s = folded;
+		}
+	    }
+	    else if (clen == 1)
+	    {
+		folded[0] = TOLOWER_LOC(*s);
+		s = folded;
+	    }
+	}
+	for (i = 0; i < slen; ++i)
+	{
+	    node = kwtrie_next(trie, node, s[i]);
+	    if (node < 0)
+		return NULL;
+	}
+	kwlen += clen;
+    }
+    while (vim_iswordp_buf(kwp + kwlen, syn_buf));
+
+    if (kwlen > MAXKEYWLEN)
+	return NULL;
+    *kwlenp = kwlen;
+    return trie->kt_nodes[node].kn_kp;
+}
+
+/*
+ * Return the first column at or after "col" in the current line where a
+ * match of "spp" can start, using "sp_first".  Returns -1 when there is none.
+ */
+    static int
+syn_first_col(synpat_T *spp, int col)
+{
+    char_u	*line = syn_getcurline();
+    char_u	*p;
+
+    for (p = line + col; *p != NUL; ++p)
+	if (spp->sp_first[*p >> 3] & (1 << (*p & 7)))
+	    return (int)(p - line);
+    return -1;
+}
+
 /*
  * Check one position in a line for a matching keyword.
  * The caller must check if a keyword can start at startcol.
@@ -3241,32 +3805,13 @@ check_keyword_id(
     keyentry_T	*kp;
     char_u	*kwp;
     int		round;
-    int		kwlen;
+    int		kwlen = 0;
     char_u	keyword[MAXKEYWLEN + 1]; /* assume max. keyword len is 80 */
     hashtab_T	*ht;
+    kwtrie_T	**trie;
     hashitem_T	*hi;
 
-    /* Find first character after the keyword.  First character was already
-     * checked. */
     kwp = line + startcol;
-    kwlen = 0;
-    do
-    {
-	if (has_mbyte)
-	    kwlen += (*mb_ptr2len)(kwp + kwlen);
-	else
-	    ++kwlen;
-    }
-    while (vim_iswordp_buf(kwp + kwlen, syn_buf));
-
-    if (kwlen > MAXKEYWLEN)
-	return 0;
-
-    /*
-     * Must make a copy of the keyword, so we can add a NUL and make it
-     * lowercase.
-     */
-    vim_strncpy(keyword, kwp, kwlen);
 
     /*
      * Try twice:
@@ -3278,8 +3823,35 @@ check_keyword_id(
 	ht = round == 1 ? &syn_block->b_keywtab : &syn_block->b_keywtab_ic;
 	if (ht->ht_used == 0)
 	    continue;
-	if (round == 2)	/* ignore case */
-	    (void)str_foldcase(kwp, kwlen, keyword, MAXKEYWLEN + 1);
+	trie = round == 1 ? &syn_block->b_kwtrie : &syn_block->b_kwtrie_ic;
+	if (*trie == NULL)
+	    *trie = kwtrie_build(ht);
+	if (*trie != NULL)
+	    kp = kwtrie_find(*trie, kwp, round == 2, &kwlen);
+	else
+	{
+	    // Out of memory, use the hashtable: make a copy of the keyword,
+	    // so we can add a NUL and make it lowercase.
+	    if (kwlen == 0)
+	    {
+		do
+		{
+		    if (has_mbyte)
+			kwlen += (*mb_ptr2len)(kwp + kwlen);
+		    else
+			++kwlen;
+		}
+		while (vim_iswordp_buf(kwp + kwlen, syn_buf));
+	    }
+	    if (kwlen > MAXKEYWLEN)
+		return 0;
+	    if (round == 1)
+		vim_strncpy(keyword, kwp, kwlen);
+	    else
+		(void)str_foldcase(kwp, kwlen, keyword, MAXKEYWLEN + 1);
+	    hi = hash_find(ht, keyword);
+	    kp = HASHITEM_EMPTY(hi) ? NULL : HI2KE(hi);
+	}
 
 	/*
 	 * Find keywords that match.  There can be several with different
@@ -3288,26 +3860,24 @@ check_keyword_id(
 	 *  Accept a not-contained keyword at toplevel.
 	 *  Accept a keyword at other levels only if it is in the contains list.
 	 */
-	hi = hash_find(ht, keyword);
-	if (!HASHITEM_EMPTY(hi))
-	    for (kp = HI2KE(hi); kp != NULL; kp = kp->ke_next)
+	for ( ; kp != NULL; kp = kp->ke_next)
+	{
+	    if (current_next_list != 0
+		    ? in_id_list(NULL, current_next_list, &kp->k_syn, 0)
+		    : (cur_si == NULL
+			? !(kp->flags & HL_CONTAINED)
+			: in_id_list(cur_si, cur_si->si_cont_list,
+				  &kp->k_syn, kp->flags & HL_CONTAINED)))
 	    {
-		if (current_next_list != 0
-			? in_id_list(NULL, current_next_list, &kp->k_syn, 0)
-			: (cur_si == NULL
-			    ? !(kp->flags & HL_CONTAINED)
-			    : in_id_list(cur_si, cur_si->si_cont_list,
-				      &kp->k_syn, kp->flags & HL_CONTAINED)))
-		{
-		    *endcolp = startcol + kwlen;
-		    *flagsp = kp->flags;
-		    *next_listp = kp->next_list;
+		*endcolp = startcol + kwlen;
+		*flagsp = kp->flags;
+		*next_listp = kp->next_list;
 #ifdef FEAT_CONCEAL
-		    *ccharp = kp->k_char;
+		*ccharp = kp->k_char;
 #endif
-		    return kp->k_syn.id;
-		}
+		return kp->k_syn.id;
 	    }
+	}
     }
     return 0;
 }
@@ -3484,6 +4054,7 @@ syntax_clear(synblock_T *block)
     /* free the keywords */
     clear_keywtab(&block->b_keywtab);
     clear_keywtab(&block->b_keywtab_ic);
+    kwtrie_clear(block);
 
     /* free the syntax patterns */
     for (i = block->b_syn_patterns.ga_len; --i >= 0; )
@@ -3706,6 +4277,7 @@ syn_clear_one(int id, int syncing)
     {
 	(void)syn_clear_keyword(id, &curwin->w_s->b_keywtab);
 	(void)syn_clear_keyword(id, &curwin->w_s->b_keywtab_ic);
+	kwtrie_clear(curwin->w_s);
     }
 
     /* clear the patterns for "id" */
@@ -4411,6 +4983,7 @@ add_keyword(
 	ht = &curwin->w_s->b_keywtab_ic;
     else
 	ht = &curwin->w_s->b_keywtab;
+    kwtrie_clear(curwin->w_s);
 
     hash = hash_hash(kp->keyword);
     hi = hash_lookup(ht, kp->keyword, hash);
@@ -5583,6 +6156,295 @@ init_syn_patterns(void)
     curwin->w_s->b_syn_patterns.ga_growsize = 10;
 }
 
+#if defined(SYN_CACHE) || defined(PROTO)
+/*
+ * Cache of compiled patterns for a syntax script in 'syncachedir'.  The cache
+ * file is read when the first pattern is compiled while sourcing the script.
+ * When a pattern was not found in it, the file is written again after the
+ * script was sourced, see syn_cache_done().  Patterns that did not compile or
+ * were compiled with the backtracking engine are not cached.
+ */
+# define SYN_CACHE_MAGIC	"VimSynCache"
+# define SYN_CACHE_VERSION	1
+
+// Header of a cache file, followed by the saved programs.
+typedef struct
+{
+    char	sh_magic[12];		// SYN_CACHE_MAGIC
+    int		sh_version;		// SYN_CACHE_VERSION
+    int		sh_patch;		// highest_patch()
+    int		sh_exe_id;		// vim_regprog_save_id()
+    int		sh_byteorder;		// 0x01020304 in native byte order
+    time_T	sh_mtime;		// modification time of the script
+    off_T	sh_size;		// size of the script
+    hash_T	sh_hash;		// checksum of the programs that follow
+} syncache_head_T;
+
+typedef struct
+{
+    scid_T	    sc_sid;		// ID of the script being sourced
+    char_u	    *sc_fname;		// cache file name, NULL when not used
+    syncache_head_T sc_head;		// header for the script
+    char_u	    *sc_data;		// contents of the cache file
+    garray_T	    sc_entries;		// pointers to the programs in sc_data
+    int		    sc_next;		// index in sc_entries expected next
+    int		    sc_used;		// number of programs used
+    garray_T	    sc_new;		// programs for the new cache file
+    int		    sc_dirty;		// sc_new differs from the file
+} syncache_T;
+
+// Caches of the scripts being sourced, a script may source another one.
+static garray_T syn_caches = {0, 0, sizeof(syncache_T *), 4, NULL};
+
+/*
+ * Return the checksum of "len" bytes at "p".
+ */
+    static hash_T
+syn_cache_hash(char_u *p, size_t len)
+{
+    hash_T	hash = 0;
+    size_t	i;
+
+    for (i = 0; i < len; ++i)
+	hash = hash * 101 + p[i];
+    return hash;
+}
+
+/*
+ * Read the cache file of "sc", if it exists and is valid for the script.
+ * A damaged file is not used, the programs in it are also checked when
+ * loading them.
+ */
+    static void
+syn_cache_read(syncache_T *sc)
+{
+    FILE	*fd;
+    stat_T	st;
+    char_u	*p;
+    char_u	*end;
+    int		len;
+
+    if (mch_stat((char *)sc->sc_fname, &st) < 0
+	    || st.st_size < (off_T)sizeof(syncache_head_T)
+	    || st.st_size > 0x7fffffffL)
+	return;
+    fd = mch_fopen((char *)sc->sc_fname, READBIN);
+    if (fd == NULL)
+	return;
+    sc->sc_data = alloc(st.st_size);
+    if (sc->sc_data != NULL)
+    {
+	size_t	data_len = (size_t)st.st_size - sizeof(syncache_head_T);
+
+	if (fread(sc->sc_data, 1, (size_t)st.st_size, fd)
+							!= (size_t)st.st_size)
+	    VIM_CLEAR(sc->sc_data);
+	else
+	{
+	    sc->sc_head.sh_hash = syn_cache_hash(
+			     sc->sc_data + sizeof(syncache_head_T), data_len);
+	    if (memcmp(sc->sc_data, &sc->sc_head,
+					       sizeof(syncache_head_T)) != 0)
+		VIM_CLEAR(sc->sc_data);
+	}
+    }
+    fclose(fd);
+    if (sc->sc_data == NULL)
+	return;
+
+    // A truncated entry at the end is ignored.
+    p = sc->sc_data + sizeof(syncache_head_T);
+    end = sc->sc_data + st.st_size;
+    while (p < end && ga_grow(&sc->sc_entries, 1) == OK)
+    {
+	len = vim_regprog_saved_len(p, (int)(end - p));
+	if (len == 0)
+	    break;
+	((char_u **)sc->sc_entries.ga_data)[sc->sc_entries.ga_len++] = p;
+	p += len;
+    }
+}
+
+/*
+ * Return the cache for the script that is being sourced.  Returns NULL when
+ * not sourcing a script or 'syncachedir' is empty.
+ */
+    static syncache_T *
+syn_cache_get(void)
+{
+    scid_T	sid = current_sctx.sc_sid;
+    syncache_T	*sc;
+    char_u	*name;
+    char_u	*p;
+    stat_T	st;
+    int		i;
+
+    // "sc_lnum" is zero when executing the script itself, not a function
+    // defined in it.
+    if (*p_scd == NUL || sid <= 0 || sid > script_items.ga_len
+	    || current_sctx.sc_lnum != 0 || SCRIPT_ITEM(sid).sn_name == NULL)
+	return NULL;
+    for (i = 0; i < syn_caches.ga_len; ++i)
+    {
+	sc = ((syncache_T **)syn_caches.ga_data)[i];
+	if (sc->sc_sid == sid)
+	    return sc->sc_fname == NULL ? NULL : sc;
+    }
+
+    if (ga_grow(&syn_caches, 1) == FAIL)
+	return NULL;
+    sc = ALLOC_CLEAR_ONE(syncache_T);
+    if (sc == NULL)
+	return NULL;
+    sc->sc_sid = sid;
+    ga_init2(&sc->sc_entries, sizeof(char_u *), 50);
+    ga_init2(&sc->sc_new, 1, 4096);
+    ((syncache_T **)syn_caches.ga_data)[syn_caches.ga_len++] = sc;
+
+    name = SCRIPT_ITEM(sid).sn_name;
+    if (!mch_isdir(p_scd) || mch_stat((char *)name, &st) < 0)
+	return NULL;
+    STRNCPY(sc->sc_head.sh_magic, SYN_CACHE_MAGIC, sizeof(SYN_CACHE_MAGIC));
+    sc->sc_head.sh_version = SYN_CACHE_VERSION;
+    sc->sc_head.sh_patch = highest_patch();
+    sc->sc_head.sh_exe_id = vim_regprog_save_id();
+    sc->sc_head.sh_byteorder = 0x01020304;
+    sc->sc_head.sh_mtime = st.st_mtime;
+    sc->sc_head.sh_size = st.st_size;
+
+    // The cache file name is the full path of the script, with path
+    // separators replaced with "%", like for 'undodir'.
+    name = vim_strsave(name);
+    if (name == NULL)
+	return NULL;
+    for (p = name; *p != NUL; MB_PTR_ADV(p))
+	if (vim_ispathsep(*p))
+	    *p = '%';
+    sc->sc_fname = concat_fnames(p_scd, name, TRUE);
+    vim_free(name);
+    if (sc->sc_fname == NULL)
+	return NULL;
+
+    syn_cache_read(sc);
+    return sc;
+}
+
+/*
+ * Compile "pat" for a syntax item.  Uses the cache of the script that is
+ * being sourced when possible.
+ */
+    static regprog_T *
+syn_regcomp(char_u *pat)
+{
+    syncache_T	*sc = syn_cache_get();
+    regprog_T	*prog = NULL;
+    char_u	*p;
+    int		len;
+    int		n;
+    int		idx = 0;
+    int		i;
+
+    // "~" is the previous substitute string, which may differ next time.
+    if (sc == NULL || vim_strchr(pat, '~') != NULL)
+	return vim_regcomp(pat, RE_MAGIC);
+
+    // The patterns are usually compiled in the same order as last time.
+    n = sc->sc_entries.ga_len;
+    for (i = 0; i < n && prog == NULL; ++i)
+    {
+	idx = (sc->sc_next + i) % n;
+	p = ((char_u **)sc->sc_entries.ga_data)[idx];
+	len = vim_regprog_saved_len(p, INT_MAX);
+	prog = vim_regprog_load(p, len, pat, RE_MAGIC);
+    }
+    if (prog != NULL)
+    {
+	if (idx != sc->sc_next)
+	    sc->sc_dirty = TRUE;
+	sc->sc_next = idx + 1;
+	++sc->sc_used;
+	if (ga_grow(&sc->sc_new, len) == OK)
+	{
+	    mch_memmove((char_u *)sc->sc_new.ga_data + sc->sc_new.ga_len,
+							       p, (size_t)len);
+	    sc->sc_new.ga_len += len;
+	}
+	return prog;
+    }
+
+    prog = vim_regcomp(pat, RE_MAGIC);
+    if (vim_regprog_save(prog, pat, RE_MAGIC, &sc->sc_new) == OK)
+	sc->sc_dirty = TRUE;
+    return prog;
+}
+
+/*
+ * Called when done sourcing script "sid": write its cache file when it
+ * changed.
+ */
+    void
+syn_cache_done(scid_T sid)
+{
+    syncache_T	*sc = NULL;
+    char_u	*tempname;
+    int		fd;
+    FILE	*fp;
+    int		ok;
+    int		i;
+
+    for (i = 0; i < syn_caches.ga_len; ++i)
+    {
+	sc = ((syncache_T **)syn_caches.ga_data)[i];
+	if (sc->sc_sid == sid)
+	    break;
+    }
+    if (i == syn_caches.ga_len)
+	return;
+    mch_memmove((syncache_T **)syn_caches.ga_data + i,
+		(syncache_T **)syn_caches.ga_data + i + 1,
+		(syn_caches.ga_len - i - 1) * sizeof(syncache_T *));
+    --syn_caches.ga_len;
+
+    if (sc->sc_fname != NULL && sc->sc_new.ga_len > 0
+	    && (sc->sc_dirty || sc->sc_used != sc->sc_entries.ga_len))
+    {
+	sc->sc_head.sh_hash = syn_cache_hash(sc->sc_new.ga_data,
+						    (size_t)sc->sc_new.ga_len);
+
+	// Write a temp file and rename it, so that another Vim never reads a
+	// partly written file.
+	tempname = alloc(STRLEN(sc->sc_fname) + 30);
+	if (tempname != NULL)
+	{
+	    sprintf((char *)tempname, "%s.%ld.tmp", sc->sc_fname,
+							       mch_get_pid());
+	    mch_remove(tempname);
+	    fd = mch_open((char *)tempname,
+			O_CREAT|O_EXTRA|O_EXCL|O_WRONLY|O_NOFOLLOW, 0644);
+	    fp = fd < 0 ? NULL : fdopen(fd, WRITEBIN);
+	    if (fp == NULL && fd >= 0)
+		close(fd);
+	    if (fp != NULL)
+	    {
+		ok = fwrite(&sc->sc_head, sizeof(syncache_head_T), 1, fp) == 1
+		    && fwrite(sc->sc_new.ga_data, (size_t)sc->sc_new.ga_len,
+								    1, fp) == 1;
+		if (fclose(fp) != 0 || !ok
+			       || vim_rename(tempname, sc->sc_fname) != 0)
+		    mch_remove(tempname);
+	    }
+	    vim_free(tempname);
+	}
+    }
+
+    vim_free(sc->sc_fname);
+    vim_free(sc->sc_data);
+    ga_clear(&sc->sc_entries);
+    ga_clear(&sc->sc_new);
+    vim_free(sc);
+}
+#endif
+
 /*
  * Get one pattern for a ":syntax match" or ":syntax region" command.
  * Stores the pattern and program in a synpat_T.
@@ -5613,12 +6475,18 @@ get_syn_pattern(char_u *arg, synpat_T *ci)
     /* Make 'cpoptions' empty, to avoid the 'l' flag */
     cpo_save = p_cpo;
     p_cpo = (char_u *)"";
+#ifdef SYN_CACHE
+    ci->sp_prog = syn_regcomp(ci->sp_pattern);
+#else
     ci->sp_prog = vim_regcomp(ci->sp_pattern, RE_MAGIC);
+#endif
     p_cpo = cpo_save;
 
     if (ci->sp_prog == NULL)
 	return NULL;
     ci->sp_ic = curwin->w_s->b_syn_ic;
+    ci->sp_has_first = vim_regprog_first_bytes(ci->sp_prog, ci->sp_ic,
+							ci->sp_first) == OK;
 #ifdef FEAT_PROFILE
     syn_clear_time(&ci->sp_time);
 #endif
@@ -6569,7 +7437,7 @@ syntime_clear(void)
 
 /*
  * Function given to ExpandGeneric() to obtain the possible arguments of the
- * ":syntime {on,off,clear,report}" command.
+ * ":syntime {on,off,clear,report}" and ":regtime" commands.
  */
     char_u *
 get_syntime_arg(expand_T *xp UNUSED, int idx)
@@ -161,6 +161,7 @@ NEW_TESTS = \
 	test_lambda \
 	test_langmap \
 	test_largefile \
+	test_lazyload \
 	test_let \
 	test_lineending \
 	test_lispwords \
@@ -366,6 +367,7 @@ NEW_TESTS_RES = \
 	test_json.res \
 	test_jumplist.res \
 	test_langmap.res \
+	test_lazyload.res \
 	test_let.res \
 	test_lineending.res \
 	test_listchars.res \
@@ -35,7 +35,7 @@ include Make_all.mak
 
 SCRIPTS = $(SCRIPTS_ALL) $(SCRIPTS_MORE1) $(SCRIPTS_MORE4) $(SCRIPTS_WIN32)
 
-SCRIPTS_BENCH = bench_re_freeze.out
+SCRIPTS_BENCH = bench_re_freeze.out bench_memcompress.out
 
 # Must run test1 first to create small.vim.
 $(SCRIPTS) $(SCRIPTS_GUI) $(SCRIPTS_WIN32) $(NEW_TESTS_RES): $(SCRIPTS_FIRST)
@@ -111,6 +111,9 @@ nolog:
 	-@if exist messages $(DEL) messages
 
 bench_re_freeze.out: bench_re_freeze.vim
+bench_memcompress.out: bench_memcompress.vim
+
+$(SCRIPTS_BENCH):
 	-$(DEL) benchmark.out
 	$(VIMPROG) -u dos.vim $(NO_INITS) $*.in
 	$(CAT) benchmark.out
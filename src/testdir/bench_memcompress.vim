@@ -0,0 +1,19 @@
+"Benchmark for getting lines from compressed blocks of a buffer
+
+so small.vim
+if !has("reltime") | finish | endif
+func! Measure(lines, count, mcp)
+	let &memcompress = a:mcp
+	new
+	setlocal noswapfile
+	call setline(1, map(range(1, a:lines), {i, v -> printf('line %d: %s', v, repeat('text ', v % 20))}))
+	let info = getbufinfo('%')[0].memline
+	let seed = srand(1)
+	let sstart = reltime()
+	for i in range(a:count)
+	    call getline(rand(seed) % a:lines + 1)
+	endfor
+	let time = reltimestr(reltime(sstart))
+	bwipe!
+	$put =printf('lines: %d, memcompress: %d, pages: %d, compressed: %d, time: %s', a:lines, a:mcp, info.resident, info.compressed, time)
+endfunc
@@ -35,10 +35,12 @@ let test_values = {
       \ 'iminsert': [[0, 1], [-1, 3, 999]],
       \ 'imsearch': [[-1, 0, 1], [-2, 3, 999]],
       \ 'imstyle': [[0, 1], [-1, 2, 999]],
+      \ 'lazyload': [[0, 1, 65536], [-1]],
       \ 'lines': [[2, 24], [-1, 0, 1]],
       \ 'linespace': [[0, 2, 4], ['']],
       \ 'numberwidth': [[1, 4, 8, 10, 11, 20], [-1, 0, 21]],
-      \ 'regexpengine': [[0, 1, 2], [-1, 3, 999]],
+      \ 'regexpengine': [[0, 1, 2, 3], [-1, 4, 999]],
+      \ 'regexptimeout': [[0, 1, 100, 9999], [-1]],
       \ 'report': [[0, 1, 2, 9999], [-1]],
       \ 'scroll': [[0, 1, 2, 20], [-1]],
       \ 'scrolljump': [[-50, -1, 0, 1, 2, 20], [999]],
@@ -46,6 +48,7 @@ let test_values = {
       \ 'shiftwidth': [[0, 1, 8, 999], [-1]],
       \ 'sidescroll': [[0, 1, 8, 999], [-1]],
       \ 'sidescrolloff': [[0, 1, 8, 999], [-1]],
+      \ 'syndefer': [[0, 1, 100, 9999], [-1]],
       \ 'tabstop': [[1, 4, 8, 12], [-1, 0]],
       \ 'textwidth': [[0, 1, 8, 99], [-1]],
       \ 'timeoutlen': [[0, 8, 99999], [-1]],
@@ -94,6 +94,83 @@ func Test_appendbufline()
   exe "bwipe! " . b
 endfunc
 
+" Many lines are appended at once
+func Test_appendbufline_many()
+  new
+  let b = bufnr('%')
+  call setline(1, ['first', 'last'])
+  hide
+  let lines = map(range(1, 5000), {i, v -> 'line ' .. v .. ' ' .. repeat('x', v % 90)})
+  call assert_equal(0, appendbufline(b, 1, lines))
+  call assert_equal(['first'] + lines + ['last'], getbufline(b, 1, '$'))
+  call assert_equal(0, appendbufline(b, 0, lines))
+  call assert_equal(lines + ['first'] + lines + ['last'], getbufline(b, 1, '$'))
+
+  exe 'buf ' .. b
+  call assert_equal(len(join(getline(1, 7000), "\n")) + 2, line2byte(7001))
+  call assert_equal(len(join(getline(1, '$'), "\n")) - len(getline('$')) + 1,
+        \ line2byte('$'))
+
+  " numbers are converted, appending stops at an invalid item
+  %d
+  call assert_equal(0, append(0, ['one', 2, 3.0->string()]))
+  call assert_equal(['one', '2', '3.0', ''], getline(1, '$'))
+  call assert_fails("call append(1, ['a', 'b', [], 'c'])", 'E730:')
+  call assert_equal(['one', 'a', 'b', '2', '3.0', ''], getline(1, '$'))
+  call assert_equal(len(join(getline(1, 5), "\n")) + 2, line2byte(6))
+
+  " setline() beyond the last line
+  let &undolevels = &undolevels
+  call setline(5, lines)
+  call assert_equal(['one', 'a', 'b', '2'] + lines, getline(1, '$'))
+  undo
+  call assert_equal(['one', 'a', 'b', '2', '3.0', ''], getline(1, '$'))
+  bwipe!
+endfunc
+
+" Check line2byte() for every line of the current buffer.
+func s:CheckLine2byte()
+  let off = 1
+  for lnum in range(1, line('$'))
+    call assert_equal(off, line2byte(lnum), 'line ' .. lnum)
+    let off += len(getline(lnum)) + 1
+  endfor
+endfunc
+
+" Appending many lines in the middle of the buffer keeps the byte offsets
+func Test_append_many_line2byte()
+  new
+  call setline(1, map(range(1, 1400),
+        \ '"line " .. v:val .. repeat("x", v:val % 37)'))
+  for k in range(30)
+    call append(100 + k * 37, map(range(300 + k * 13),
+          \ '"app " .. v:val .. repeat("y", v:val % 11)'))
+    call s:CheckLine2byte()
+  endfor
+  bwipe!
+endfunc
+
+" Appending many lines moves the recently used blocks that follow
+func Test_append_many_cached_blocks()
+  new
+  let lines = map(range(1, 20000), {i, v -> 'line ' .. v})
+  call setline(1, lines)
+  2,40d
+  call remove(lines, 1, 39)
+  " use more blocks than are cached, then go back to the first one
+  for lnum in range(1, 19000, 50)
+    call getline(lnum)
+  endfor
+  call getline(2)
+  call append(1, ['x', 'y', 'z'])
+  call extend(lines, ['x', 'y', 'z'], 1)
+  call assert_equal(lines[18952], getline(18953))
+  call setline(18953, 'changed')
+  let lines[18952] = 'changed'
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+endfunc
+
 func Test_appendbufline_no_E315()
   let after =<< trim [CODE]
     set stl=%f ls=2
@@ -154,3 +154,50 @@ function Test_getbufinfo_lastused()
   call assert_equal(getbufinfo('Xtestfile2')[0].lastused, 7654321)
   call test_settime(0)
 endfunc
+
+func Test_getbufinfo_memline()
+  new
+  let lines = map(range(1, 20000), {i, v -> 'line ' .. v})
+  call setline(1, lines)
+  let info = getbufinfo('%')[0].memline
+  call assert_equal(['cachehits', 'cachemisses', 'compressed', 'evicted', 'resident'],
+        \ sort(keys(info)))
+
+  " going back and forth between a few lines uses the cached blocks
+  for lnum in [10, 5000, 10000, 15000, 19990, 10, 5000, 10000, 15000]
+    call assert_equal(lines[lnum - 1], getline(lnum))
+  endfor
+  call assert_true(getbufinfo('%')[0].memline.cachehits > info.cachehits)
+
+  " lines inserted or deleted in the locked block move the cached blocks
+  call assert_equal(lines[14999], getline(15000))
+  call assert_equal(lines[9], getline(10))
+  call append(10, 'inserted')
+  call insert(lines, 'inserted', 10)
+  call assert_equal(lines[11999], getline(12000))
+  call assert_equal(lines[19], getline(20))
+  call deletebufline('', 20)
+  call remove(lines, 19)
+  call assert_equal(lines[11999], getline(12000))
+  call assert_equal(lines[14999], getline(15000))
+
+  " changes in between are found back
+  call setline(5000, 'changed')
+  let lines[4999] = 'changed'
+  call assert_equal(lines[9], getline(10))
+  call append(9, ['one', 'two'])
+  call extend(lines, ['one', 'two'], 9)
+  call assert_equal(lines[4999], getline(5000))
+  call assert_equal('changed', getline(5002))
+  15000,15010d
+  call remove(lines, 14999, 15009)
+  call assert_equal(lines[-1], getline('$'))
+  call assert_equal(lines[9], getline(10))
+  call assert_equal(lines, getline(1, '$'))
+
+  bwipe!
+
+  badd Xnotloaded
+  call assert_false(has_key(getbufinfo('Xnotloaded')[0], 'memline'))
+  bwipe Xnotloaded
+endfunc
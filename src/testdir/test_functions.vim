@@ -937,6 +937,35 @@ func Test_byte2line_line2byte()
   bw!
 endfunc
 
+" Byte offsets in a buffer that spans many chunks, after edits in the middle.
+func Test_byte2line_line2byte_many_lines()
+  new
+  call setline(1, map(range(1, 20000), 'repeat("x", v:val % 37)'))
+  20,40d
+  call append(9000, map(range(300), '"yy"'))
+  call setline(15000, repeat('z', 100))
+  12000,12010d
+  let lines = getline(1, '$')
+  for ff in ['unix', 'dos']
+    let &fileformat = ff
+    let eol = ff == 'dos' ? 2 : 1
+    let off = 1
+    for lnum in range(1, len(lines))
+      if lnum % 97 == 0 || lnum == len(lines)
+        call assert_equal(off, line2byte(lnum))
+        call assert_equal(lnum, byte2line(off))
+        call assert_equal(lnum, byte2line(off + len(lines[lnum - 1])))
+      endif
+      let off += len(lines[lnum - 1]) + eol
+    endfor
+    call assert_equal(off, line2byte(len(lines) + 1))
+    exe 'goto ' .. (line2byte(5000) + 1)
+    call assert_equal(5000, line('.'))
+  endfor
+  set fileformat&
+  bw!
+endfunc
+
 func Test_byteidx()
   let a = '.é.' " one char of two bytes
   call assert_equal(0, byteidx(a, 0))
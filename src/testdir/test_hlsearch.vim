@@ -63,3 +63,72 @@ func Test_hlsearch_eol_highlight()
   set nohlsearch
   bwipe!
 endfunc
+
+" The 'hlsearch' results are cached per line, check that the highlighting is
+" updated when the text changes.
+func Test_hlsearch_cached_results()
+  new
+  call setline(1, ['foo', 'bar', 'foo', 'bar'])
+  set hlsearch nolazyredraw
+  let @/ = 'foo'
+  redraw
+  let attr = screenattr(1, 1)
+  let normal = screenattr(2, 1)
+  call assert_notequal(attr, normal)
+  call assert_equal(attr, screenattr(3, 1))
+
+  " change a line
+  call setline(2, 'xfoo')
+  redraw
+  call assert_equal(attr, screenattr(2, 2))
+  call setline(1, 'xxx')
+  redraw
+  call assert_equal(normal, screenattr(1, 1))
+
+  " lines inserted and deleted above a cached line
+  call append(0, ['aaa', 'aaa'])
+  redraw
+  call assert_equal([normal, attr, attr], [screenattr(1, 1), screenattr(4, 2),
+	\ screenattr(5, 1)])
+  let &undolevels = &undolevels
+  1,2delete
+  redraw
+  call assert_equal([normal, attr, attr], [screenattr(1, 1), screenattr(2, 2),
+	\ screenattr(3, 1)])
+  undo
+  redraw
+  call assert_equal([normal, normal, attr], [screenattr(1, 1),
+	\ screenattr(3, 1), screenattr(5, 1)])
+
+  " a change in one line affects a match over a line break
+  %delete
+  call setline(1, ['foo', 'bar'])
+  let @/ = 'foo\nbar'
+  redraw
+  call assert_equal(attr, screenattr(1, 1))
+  call setline(2, 'baz')
+  redraw
+  call assert_equal(normal, screenattr(1, 1))
+
+  " the result of "\k" depends on 'iskeyword'
+  call setline(1, ['a-b', 'a-b'])
+  let @/ = '\k\+'
+  redraw
+  call assert_equal(normal, screenattr(1, 2))
+  setlocal iskeyword+=45
+  redraw!
+  call assert_equal(attr, screenattr(1, 2))
+  setlocal iskeyword&
+
+  " the result of "\%#" depends on the cursor position
+  let @/ = '\%#a'
+  call cursor(1, 1)
+  redraw
+  call assert_equal([attr, normal], [screenattr(1, 1), screenattr(2, 1)])
+  call cursor(2, 1)
+  redraw!
+  call assert_equal([normal, attr], [screenattr(1, 1), screenattr(2, 1)])
+
+  set nohlsearch
+  bwipe!
+endfunc
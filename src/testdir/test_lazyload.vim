@@ -0,0 +1,134 @@
+" Tests for loading a file lazily with 'lazyload'
+
+func s:MakeLines(count)
+  return map(range(1, a:count), {i, v -> 'line ' .. v .. ' ' .. repeat('x', v % 70)})
+endfunc
+
+func Test_lazyload_basic()
+  let lines = s:MakeLines(20000)
+  call writefile(lines, 'Xlazy')
+  set lazyload=1
+
+  e Xlazy
+  call assert_equal(20000, line('$'))
+  call assert_equal(lines[0], getline(1))
+  call assert_equal(lines[12344], getline(12345))
+  call assert_equal(lines[-1], getline('$'))
+  call assert_equal(lines, getline(1, '$'))
+  call assert_equal(1, &eol)
+  call assert_equal('unix', &ff)
+  call assert_equal(0, &modified)
+
+  " byte offsets
+  call assert_equal(len(join(lines[: 14998], "\n")) + 2, line2byte(15000))
+  call assert_equal(15000, byte2line(line2byte(15000)))
+  call assert_equal(len(join(lines, "\n")) + 2, line2byte('$') + len(lines[-1]) + 1)
+
+  " change, insert and delete lines
+  call setline(10000, 'changed')
+  let lines[9999] = 'changed'
+  15000,15099d
+  call remove(lines, 14999, 15098)
+  call append(3, ['one', 'two'])
+  call extend(lines, ['one', 'two'], 3)
+  call assert_equal(lines, getline(1, '$'))
+  call assert_equal(len(join(lines[: 14998], "\n")) + 2, line2byte(15000))
+
+  " undo the changes
+  silent undo 0
+  call assert_equal(s:MakeLines(20000), getline(1, '$'))
+
+  call setline(20, 'twenty')
+  let lines = s:MakeLines(20000)
+  let lines[19] = 'twenty'
+  w! Xlazy2
+  call assert_equal(lines, readfile('Xlazy2'))
+
+  bwipe!
+  set lazyload&
+  call delete('Xlazy')
+  call delete('Xlazy2')
+endfunc
+
+" Writing the buffer to the file it was read from
+func Test_lazyload_overwrite()
+  let lines = s:MakeLines(20000)
+  call writefile(lines, 'Xlazy')
+  set lazyload=1
+
+  e Xlazy
+  call setline(5000, 'five thousand')
+  let lines[4999] = 'five thousand'
+  w
+  call assert_equal(lines, readfile('Xlazy'))
+  call assert_equal(lines, getline(1, '$'))
+
+  bwipe!
+  set lazyload&
+  call delete('Xlazy')
+endfunc
+
+func Test_lazyload_text()
+  set lazyload=1
+
+  " last line without a line break, the NUL is read as a NL
+  let lines = s:MakeLines(5000) + ["with\nnul", 'last']
+  call writefile(lines, 'Xlazy', 'b')
+  e Xlazy
+  call assert_equal(5002, line('$'))
+  call assert_equal(0, &eol)
+  call assert_equal(lines, getline(1, '$'))
+  setlocal nofixeol
+  w! Xlazy2
+  call assert_equal(readfile('Xlazy', 'b'), readfile('Xlazy2', 'b'))
+  bwipe!
+
+  " a very long line in between
+  let lines = s:MakeLines(3000) + [repeat('long', 10000)] + s:MakeLines(3000)
+  call writefile(lines, 'Xlazy')
+  e Xlazy
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+
+  " an illegal byte: read normally with the next encoding
+  let lines = s:MakeLines(5000) + ["bad\xffbyte"]
+  call writefile(lines, 'Xlazy')
+  e Xlazy
+  call assert_equal('latin1', &fenc)
+  call assert_equal(5001, line('$'))
+  call assert_equal(lines[0], getline(1))
+  bwipe!
+
+  set lazyload&
+  call delete('Xlazy')
+  call delete('Xlazy2')
+endfunc
+
+func Test_lazyload_small_file()
+  let lines = s:MakeLines(10)
+  call writefile(lines, 'Xlazy')
+  set lazyload=1000
+  e Xlazy
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+  set lazyload=0
+  e Xlazy
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+  set lazyload&
+  call delete('Xlazy')
+endfunc
+
+" When the file is truncated lines can't be read.
+func Test_lazyload_truncated()
+  call writefile(s:MakeLines(20000), 'Xlazy')
+  set lazyload=1
+  e Xlazy
+  call writefile(['short'], 'Xlazy')
+  call assert_fails('call getline(10000)', 'E998:')
+  bwipe!
+  set lazyload&
+  call delete('Xlazy')
+endfunc
+
+" vim: shiftwidth=2 sts=2 expandtab
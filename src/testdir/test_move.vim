@@ -38,3 +38,95 @@ func Test_move()
 
   %bwipeout!
 endfunc
+
+" Check line2byte() for every line of the current buffer.
+func s:CheckLine2byte()
+  let off = 1
+  for lnum in range(1, line('$'))
+    call assert_equal(off, line2byte(lnum), 'line ' .. lnum)
+    let off += len(getline(lnum)) + 1
+  endfor
+endfunc
+
+" Moving and copying many lines spans many blocks, also when undone.
+func Test_move_copy_many_lines()
+  new
+  let lines = range(1, 20000)->map('"line " .. v:val .. repeat("x", v:val % 37)')
+  call setline(1, lines)
+  let &undolevels = &undolevels
+
+  2001,12000move $
+  call assert_equal(lines[:1999] + lines[12000:] + lines[2000:11999],
+        \ getline(1, '$'))
+  call assert_equal(20000, line('.'))
+  call s:CheckLine2byte()
+  let &undolevels = &undolevels
+
+  let copied = getline(8001, 18000)
+  8001,18000copy 10000
+  call assert_equal(30000, line('$'))
+  call assert_equal(20000, line('.'))
+  call assert_equal(copied[:1999], getline(8001, 10000))
+  call assert_equal(copied, getline(10001, 20000))
+  call assert_equal(copied[2000:], getline(20001, 28000))
+  call s:CheckLine2byte()
+  let &undolevels = &undolevels
+
+  undo
+  call assert_equal(lines[:1999] + lines[12000:] + lines[2000:11999],
+        \ getline(1, '$'))
+  call s:CheckLine2byte()
+  undo
+  call assert_equal(lines, getline(1, '$'))
+  call s:CheckLine2byte()
+  redo
+  redo
+  call assert_equal(30000, line('$'))
+  undo
+  undo
+  call assert_equal(lines, getline(1, '$'))
+
+  " a smaller move in the middle of the buffer
+  833,1410move 462
+  call assert_equal(lines[:461] + lines[832:1409] + lines[462:831]
+        \ + lines[1410:], getline(1, '$'))
+  call s:CheckLine2byte()
+  undo
+
+  " deleting all lines and undoing it
+  let &undolevels = &undolevels
+  %d
+  call assert_equal([''], getline(1, '$'))
+  call assert_equal(1, line2byte(1))
+  undo
+  call assert_equal(lines, getline(1, '$'))
+  call s:CheckLine2byte()
+  redo
+  call assert_equal([''], getline(1, '$'))
+  call assert_equal(1, line2byte(1))
+  undo
+  call assert_equal(lines, getline(1, '$'))
+  call s:CheckLine2byte()
+  bwipe!
+endfunc
+
+" Deleting lines in bulk moves the recently used blocks that follow
+func Test_delete_many_cached_blocks()
+  new
+  let lines = range(1, 20000)->map('"line " .. v:val')
+  call setline(1, lines)
+  let &undolevels = &undolevels
+  call append(10, ['a', 'b', 'c', 'd', 'e'])
+  let &undolevels = &undolevels
+  " use more blocks than are cached, then go back to the first one
+  for lnum in range(1, 19000, 50)
+    call getline(lnum)
+  endfor
+  call getline(12)
+  undo
+  call assert_equal(lines[18951], getline(18952))
+  call setline(18952, 'changed')
+  let lines[18951] = 'changed'
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+endfunc
@@ -3755,6 +3755,51 @@ func Test_vimgrep_autocmd_cd()
   call delete('Xdir', 'rf')
 endfunc
 
+" Files without the text that every match contains are not loaded by :vimgrep
+func Test_vimgrep_skip_nomatch()
+  call writefile(['one', 'two three'], 'Xvgr1.txt')
+  call writefile(['four', 'TWO'], 'Xvgr2.txt')
+  call writefile(['five'], 'Xvgr3.txt')
+  " UTF-16 with a BOM has NUL bytes, it must be loaded to check for a match
+  call writefile(0zFEFF0074007700F6, 'Xvgr4.txt')
+  %bwipe
+  let g:read_files = []
+  autocmd BufRead Xvgr* call add(g:read_files, expand('<afile>'))
+
+  vimgrep /tw[oö]/j Xvgr*.txt
+  call assert_equal(['Xvgr1.txt', 'Xvgr4.txt'], g:read_files)
+  call assert_equal([[2, 'two three'], [1, 'twö']],
+        \ map(getqflist(), '[v:val.lnum, v:val.text]'))
+
+  let g:read_files = []
+  set ignorecase
+  vimgrep /two/j Xvgr*.txt
+  set noignorecase
+  call assert_equal(['Xvgr1.txt', 'Xvgr2.txt', 'Xvgr4.txt'], g:read_files)
+  call assert_equal(2, len(getqflist()))
+
+  " A pattern without required text loads all the files.
+  let g:read_files = []
+  vimgrep /^\a/j Xvgr*.txt
+  call assert_equal(4, len(g:read_files))
+  call assert_equal(6, len(getqflist()))
+
+  " A BufReadPre autocommand may change how the file is read.
+  let g:read_files = []
+  autocmd BufReadPre Xvgr3.txt let g:pre = 1
+  vimgrep /two/j Xvgr*.txt
+  call assert_equal(['Xvgr1.txt', 'Xvgr3.txt', 'Xvgr4.txt'], g:read_files)
+
+  autocmd! BufReadPre Xvgr3.txt
+  autocmd! BufRead Xvgr*
+  unlet g:read_files g:pre
+  %bwipe
+  for i in range(1, 4)
+    call delete('Xvgr' .. i .. '.txt')
+  endfor
+  call setqflist([], 'f')
+endfunc
+
 " The following test used to crash Vim
 func Test_lhelpgrep_autocmd()
   lhelpgrep quickfix
@@ -2,6 +2,8 @@
 set encoding=latin1
 scriptencoding latin1
 
+source check.vim
+
 func s:equivalence_test()
   let str = "A B C D E F G H I J K L M N O P Q R S T U V W X Y Z a b c d e f g h i j k l m n o p q r s t u v w x y z"
   let groups = split(str)
@@ -31,6 +33,11 @@ func Test_equivalence_re2()
   call s:equivalence_test()
 endfunc
 
+func Test_equivalence_re3()
+  set re=3
+  call s:equivalence_test()
+endfunc
+
 func Test_recursive_substitute()
   new
   s/^/\=execute("s#^##gn")
@@ -93,7 +100,8 @@ endfunc
 
 func Test_out_of_memory()
   new
-  s/^/,n
+  " Include the ";" so that the line is not skipped without matching.
+  s/^/,n;
   " This will be slow...
   call assert_fails('call search("\\v((n||<)+);")', 'E363:')
 endfunc
@@ -141,3 +149,142 @@ func Test_pattern_compile_speed()
   call assert_inrange(0.01, 10.0, reltimefloat(reltime(start)))
   set spc=
 endfunc
+
+" Compiled patterns are taken from the cache when used again.
+func Test_regexp_cache()
+  let info = regexpcacheinfo()
+  for i in range(20)
+    call assert_equal('xbcx', substitute('abca', 'a\|d\+', 'x', 'g'))
+  endfor
+  let newinfo = regexpcacheinfo()
+  call assert_inrange(info.compiles, info.compiles + 1, newinfo.compiles)
+  call assert_equal(info.hits + 19, newinfo.hits)
+  call assert_inrange(1, newinfo.size, newinfo.count)
+  let entry = filter(copy(newinfo.entries), {_, e -> e.pattern == 'a\|d\+'})
+  call assert_equal([{'pattern': 'a\|d\+', 'refcount': 0}], entry)
+
+  " A pattern in use is compiled again when used recursively.
+  call assert_equal('[x]bc[x]', substitute('abca', 'a\|d\+',
+        \ '\=substitute(submatch(0), "a\\|d\\+", "[x]", "")', 'g'))
+
+  " The effect of 'magic', 'iskeyword' and the engine is not mixed up.
+  new
+  call setline(1, ['abc', 'a.c', 'a-b'])
+  set nomagic
+  call assert_equal(2, search('a.c'))
+  set magic
+  call assert_equal(1, search('a.c'))
+  for re in range(1, 2)
+    exe 'set re=' .. re
+    call assert_equal(0, search('a[[:keyword:]]b'))
+    setlocal iskeyword+=-
+    call assert_equal(3, search('a[[:keyword:]]b'))
+    setlocal iskeyword&
+  endfor
+  set re=0
+
+  " The same pattern used for syntax with its own 'iskeyword' and for
+  " searching.
+  syn iskeyword @,-
+  syn match Word '^a\k\+b$'
+  call assert_equal(0, search('^a\k\+b$'))
+  call assert_equal('Word', synIDattr(synID(3, 1, 0), 'name'))
+  call assert_equal(0, search('^a\k\+b$'))
+  syn clear
+  bwipe!
+
+  for re in range(3)
+    exe 'set re=' .. re
+    call assert_equal('xbcx', substitute('abca', 'a\|d\+', 'x', 'g'))
+  endfor
+  set re=0
+
+  " A pattern with an error gives the error every time.
+  for i in range(2)
+    call assert_fails("call substitute('abc', 'a\\(', 'x', '')", 'E54:')
+  endfor
+endfunc
+
+" Matching a pattern with an exponential number of steps stops at the time
+" limit.
+func Test_regexp_timeout()
+  CheckFeature reltime
+  let text = repeat('a', 40)
+  let pat = '\%#=1\v^(a|a)*b'
+
+  let start = reltime()
+  call assert_fails('call match(text, pat, 0, 1, 100)', 'E1000:')
+  call assert_fails('call matchstr([text], pat, 0, 1, 100)', 'E1000:')
+  call assert_inrange(0.0, 10.0, reltimefloat(reltime(start)))
+  call assert_fails('call match(text, pat, 0, 1, -1)', 'E487:')
+  call assert_equal('b', matchstr('abc', 'b', 0, 1, 100))
+
+  new
+  call setline(1, [text, text . 'b', text])
+  set regexptimeout=100
+  call assert_fails('call substitute(text, pat, "x", "")', 'E1000:')
+  call assert_fails('s/' . pat . '/x/', 'E1000:')
+  call assert_equal(text, getline(1))
+  call assert_fails('g/' . pat . '/d', 'E1000:')
+  call assert_equal(3, line('$'))
+  call assert_fails('v/' . pat . '/d', 'E1000:')
+  call assert_equal(3, line('$'))
+  call assert_fails('sort /' . pat . '/', 'E1000:')
+  call assert_equal(text . 'b', getline(2))
+  1
+  call assert_fails('call search(pat)', 'E1000:')
+  " An explicit timeout is silent.
+  call assert_equal(0, search(pat, '', 0, 100))
+  " The time limit applies per command, not per line.
+  call assert_inrange(0.0, 10.0, reltimefloat(reltime(start)))
+
+  " Without a time limit a cheap pattern works as before.
+  set regexptimeout=0
+  %s/a\+b/x/
+  call assert_equal('x', getline(2))
+  call assert_fails('set regexptimeout=-1', 'E487:')
+
+  set regexptimeout&
+  bwipe!
+endfunc
+
+" Patterns used anywhere are measured with ":regtime".
+func Test_regtime()
+  CheckFeature profile
+  regtime clear
+  call assert_equal("\nNo patterns were matched", execute('regtime report'))
+
+  regtime on
+  new
+  call setline(1, ['one two', 'two three'])
+  %s/two/2/g
+  call assert_equal(-1, match('abc', '\%#=1x'))
+  call assert_equal(-1, match('abc', '\%#=1x'))
+  regtime off
+  call assert_equal(-1, match('abc', 'not counted'))
+
+  let info = regtimeinfo()
+  call assert_equal(['\%#=1x', 'two'], sort(map(copy(info), 'v:val.pattern')))
+  let d = filter(copy(info), 'v:val.pattern == "two"')[0]
+  " Line 1 is tried again after the match.
+  call assert_equal(3, d.count)
+  call assert_equal(2, d.match)
+  call assert_equal(0, d.fallback)
+  call assert_match('nfa\|bitparallel', d.engine)
+  call assert_equal(v:t_float, type(d.total))
+  let d = filter(copy(info), 'v:val.pattern == ''\%#=1x''')[0]
+  call assert_equal(2, d.count)
+  call assert_equal(0, d.match)
+  call assert_equal('backtracking', d.engine)
+
+  let a = execute('regtime report')
+  call assert_match('^  TOTAL *COUNT *MATCH *SLOWEST *AVERAGE *FALLBACK *ENGINE *PATTERN', a)
+  call assert_match(' 3 \+2 .* two\n', a)
+
+  regtime clear
+  call assert_equal([], regtimeinfo())
+  call assert_fails('regtime abc', 'E475:')
+  call feedkeys(":regtime \<C-A>\<C-B>\"\<CR>", 'tx')
+  call assert_equal('"regtime clear off on report', @:)
+  bwipe!
+endfunc
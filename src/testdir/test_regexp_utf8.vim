@@ -31,6 +31,12 @@ func Test_equivalence_re2()
   set re=0
 endfunc
 
+func Test_equivalence_re3()
+  set re=3
+  call s:equivalence_test()
+  set re=0
+endfunc
+
 func s:classes_test()
   set isprint=@,161-255
   call assert_equal('Motörhead', matchstr('Motörhead', '[[:print:]]\+'))
@@ -190,8 +196,14 @@ func Test_classes_re2()
   set re=0
 endfunc
 
+func Test_classes_re3()
+  set re=3
+  call s:classes_test()
+  set re=0
+endfunc
+
 func Test_reversed_range()
-  for re in range(0, 2)
+  for re in range(0, 3)
     exe 'set re=' . re
     call assert_fails('call match("abc def", "[c-a]")', 'E944:')
   endfor
@@ -215,3 +227,119 @@ func Test_optmatch_toolong()
   set re=0
 endfunc
 
+
+" The NFA engine uses a DFA to quickly reject lines without a match, check it
+" gives the same results.
+func Test_nfa_dfa_reject()
+  for [pat, text, expected] in [
+        \ ['foo$', 'foo bar foo', 8],
+        \ ['foo$', 'foo bar', -1],
+        \ ['^foo', 'xfoo', -1],
+        \ ['^\s*foo', '  foo', 0],
+        \ ['\<bar', 'foobar bar', 7],
+        \ ['\cFOO', 'xfoo', 1],
+        \ ['\d\{3}', 'ab12c123', 5],
+        \ ['[à-é]x', 'aàéx', 3],
+        \ ['[^[:alpha:] ]\+', 'ab c-d', 4],
+        \ ["é", "xé", 1],
+        \ ['ab\+c', "a\u0301bc abbc", 6],
+        \ ['a\|$', 'bbb', 3],
+        \ ['x*', 'abc', 0],
+        \ ]
+    call assert_equal(expected, match(text, '\%#=1' .. pat), pat)
+    call assert_equal(expected, match(text, '\%#=2' .. pat), pat)
+  endfor
+
+  new
+  set re=2
+  call setline(1, map(range(1000), 'v:val % 7 ? "abc " .. v:val : "x_" .. v:val'))
+  let g:count = 0
+  g/\<x_\d\+$/let g:count += 1
+  call assert_equal(143, g:count)
+  set ic
+  let g:count = 0
+  g/X_\d\+$/let g:count += 1
+  call assert_equal(143, g:count)
+  set noic
+
+  " Changing 'iskeyword' while the pattern is used.
+  call setline(1, ['x-ab!', 'x-!'])
+  3,$d
+  %s/\k\+!$/\=execute('setlocal isk+=-') .. 'X'/
+  call assert_equal(['x-X', 'X'], getline(1, '$'))
+
+  unlet g:count
+  set re=0
+  bwipe!
+endfunc
+
+" Simple patterns are matched with the bit-parallel matcher, check it gives the
+" same results.
+func Test_bitparallel_engine()
+  for [pat, text, expected] in [
+        \ ['\<foo\>', 'foobar foo', ['foo', 7, 10]],
+        \ ['[A-Z_]\+', 'abc DEF_G', ['DEF_G', 4, 9]],
+        \ ['TODO\|FIXME', 'x FIXME TODO', ['FIXME', 2, 7]],
+        \ ['\s\+$', "ab \t c  ", ['  ', 6, 8]],
+        \ ['^\s*#', '  #if', ['  #', 0, 3]],
+        \ ['^\s*#', 'x #if', ['', -1, -1]],
+        \ ['ab\|abc', 'xabc', ['ab', 1, 3]],
+        \ ['a*', 'baa', ['', 0, 0]],
+        \ ['a*ab', 'xaaab', ['aaab', 1, 5]],
+        \ ['\<\h\w*(', 'x = foo(1)', ['foo(', 4, 8]],
+        \ ['\>', 'ab cd', ['', 2, 2]],
+        \ ['o$\|^f', 'foo', ['f', 0, 1]],
+        \ ['\<ab', 'éab ab', ['ab', 5, 7]],
+        \ ['b\+', 'àbb', ['bb', 2, 4]],
+        \ ['[éa]b', 'xéb', ['éb', 1, 4]],
+        \ ]
+    for re in range(1, 3)
+      call assert_equal(expected, matchstrpos(text, '\%#=' .. re .. pat), re .. ': ' .. pat)
+    endfor
+  endfor
+
+  " Starting halfway the line.
+  call assert_equal(['foo', 9, 12], matchstrpos('foo xfoo foo', '\%#=3\<foo\>', 1))
+  call assert_equal(['', -1, -1], matchstrpos('foo', '\%#=3^f', 1))
+
+  new
+  set re=3
+  call setline(1, ['Foo_1 = bar', 'x', 'foo-bar FOO', 'foo_1'])
+  call assert_equal(4, search('foo_\d'))
+  set ic
+  call assert_equal(1, search('foo_\d'))
+  call assert_equal(['FOO', 8, 11], matchstrpos(getline(3), '\<foo\>', 1))
+  set noic
+  " Changing 'iskeyword' changes where a word starts and ends.
+  call assert_equal(['foo', 0, 3], matchstrpos(getline(3), '\<foo\>'))
+  setlocal iskeyword+=-
+  call assert_equal(['', -1, -1], matchstrpos(getline(3), '\<foo\>'))
+  call assert_equal(['foo-bar', 0, 7], matchstrpos(getline(3), '\k\+'))
+  setlocal iskeyword&
+  call assert_equal(['foo', 0, 3], matchstrpos(getline(3), '\k\+'))
+  set re=0
+  bwipe!
+endfunc
+
+" Lines without the literal text that every match contains are skipped
+" quickly, check that matches are still found.
+func Test_required_literal()
+  for [pat, text, expected] in [
+        \ ['\w\+_ab\d', 'x_ab x_ab1', 5],
+        \ ['\(\w\)\1_ab', 'x_ab xx_ab', 5],
+        \ ['\(x\)\@<=yo', 'yo xyo', 4],
+        \ ['o\(ab\)\@!', 'oab ox', 4],
+        \ ['\(ab\)\@>co', 'ab co abco', 6],
+        \ ['\%(ab\)\?cd', 'xcd', 1],
+        \ ['\w\+ǅé', 'aǅ aǅé', 4],
+        \ ['\cAB\w', 'xaBc', 1],
+        \ ['\c\w\+_Ab', 'x_AB', 0],
+        \ ['\Zx\w\+e', "xyé", 0],
+        \ ]
+    call assert_equal(expected, match(text, '\%#=1' .. pat), pat)
+    call assert_equal(expected, match(text, '\%#=2' .. pat), pat)
+  endfor
+
+  " With 'ignorecase' the Kelvin sign matches "k".
+  call assert_equal(0, match("ax\u212a1", '\%#=2\c\w\+xk\d'))
+endfunc
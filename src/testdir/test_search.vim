@@ -867,6 +867,74 @@ func Test_incsearch_search_dump()
   call delete('Xis_search_script')
 endfunc
 
+" An 'incsearch' search that stops at the time limit continues until a match
+" is found.  With a time limit of one msec searching the buffer takes many
+" slices, the match is only found when each one continues the previous one.
+func Test_incsearch_continue_search()
+  CheckOption incsearch
+  CheckFeature reltime
+  CheckRunVimInTerminal
+
+  call writefile([
+	\ 'set incsearch nohlsearch',
+	\ 'call test_override("incsearch_time", 1)',
+	\ 'call setline(1, repeat([repeat("need ", 40)], 5000))',
+	\ 'call append("$", "needle")',
+	\ ], 'Xis_continue_script')
+  let buf = RunVimInTerminal('-S Xis_continue_script', {'rows': 6, 'cols': 60})
+  " Give Vim a chance to handle the terminal responses, they would postpone
+  " the search.
+  call WaitForAssert({-> assert_match('1,1', term_getline(buf, 6))})
+  sleep 500m
+
+  call term_sendkeys(buf, '/needl')
+  call term_sendkeys(buf, 'e')
+  call WaitForAssert({-> assert_equal('needle', term_getline(buf, 5))}, 20000)
+  call term_sendkeys(buf, "\<CR>")
+  call WaitForAssert({-> assert_match('5001,1', term_getline(buf, 6))})
+
+  call StopVimInTerminal(buf)
+  call delete('Xis_continue_script')
+endfunc
+
+" An 'incsearch' search that stopped does not continue when the text was
+" changed in the meantime.
+func Test_incsearch_continue_changed()
+  CheckOption incsearch
+  CheckFeature timers
+  CheckRunVimInTerminal
+
+  call writefile([
+	\ 'set incsearch nohlsearch',
+	\ 'call setline(1, repeat([repeat("need ", 40)], 500000))',
+	\ 'call append("$", "needle at the end")',
+	\ 'let @a = "e"',
+	\ 'func Change(timer)',
+	\ '  if getcmdline() ==# "needl" && getline(20) !~# "needle"',
+	\ '    call setline(20, "needle added")',
+	\ '  endif',
+	\ 'endfunc',
+	\ 'call timer_start(10, "Change", {"repeat": -1})',
+	\ ], 'Xis_changed_script')
+  let buf = RunVimInTerminal('-S Xis_changed_script', {'rows': 6, 'cols': 60})
+  call WaitForAssert({-> assert_match('1,1', term_getline(buf, 6))})
+  sleep 500m
+
+  " CTRL-R stops the search and waits for a register name, the timer
+  " changes the text then.
+  call term_sendkeys(buf, '/needl')
+  sleep 100m
+  call term_sendkeys(buf, "\<C-R>")
+  sleep 100m
+  call term_sendkeys(buf, 'a')
+  call WaitForAssert({-> assert_match('needle added',
+	\ join(map(range(1, 5), {_, r -> term_getline(buf, r)})))})
+  call term_sendkeys(buf, "\<Esc>")
+
+  call StopVimInTerminal(buf)
+  call delete('Xis_changed_script')
+endfunc
+
 func Test_incsearch_substitute()
   if !exists('+incsearch')
     return
@@ -309,3 +309,92 @@ func Test_swap_recover_ext()
   augroup END
   augroup! test_swap_recover_ext
 endfunc
+
+" When 'updatecount' is reached the swap file is synced.  Flushing it to disk
+" is done in the background, editing goes on while it is pending.
+func Test_swap_sync_updatecount()
+  if test_getvalue('swap_sync_pending') < 0
+    throw 'Skipped: swap file is not flushed in the background'
+  endif
+  new Xswapsync
+  set updatecount=3
+  let swapfile_name = swapname('%')
+  call WaitForAssert({-> assert_equal(0, test_getvalue('swap_sync_pending'))})
+
+  call test_override('swap_sync_hold', 1)
+  call feedkeys("ione two three\<Esc>", 'xt')
+  call assert_match('one two three', readfile(swapfile_name, 'b')->join())
+  call assert_equal(1, test_getvalue('swap_sync_pending'))
+  " Another request for the same file is merged with the waiting one.
+  call feedkeys("ofour five\<Esc>", 'xt')
+  call assert_match('four five', readfile(swapfile_name, 'b')->join())
+  call assert_equal(1, test_getvalue('swap_sync_pending'))
+
+  call test_override('swap_sync_hold', 0)
+  call WaitForAssert({-> assert_equal(0, test_getvalue('swap_sync_pending'))})
+
+  set updatecount&
+  bwipe!
+endfunc
+
+" When 'maxmemtot' is reached blocks of hidden buffers are released.
+func Test_swap_maxmemtot_hidden()
+  set hidden maxmemtot=300
+  let lines = map(range(1, 10000), {i, v -> 'line ' .. v .. ' ' .. repeat('x', 40)})
+  edit Xmaxmem0
+  call setline(1, lines[: 999])
+  let small = bufnr()
+  call assert_equal(0, getbufinfo(small)[0].memline.evicted)
+
+  let bufs = []
+  for i in range(1, 3)
+    exe 'edit Xmaxmem' .. i
+    call setline(1, lines)
+    call add(bufs, bufnr())
+  endfor
+  let info = getbufinfo(small)[0].memline
+  call assert_true(info.evicted > 0)
+  call assert_true(info.resident < 300 * 1024 / 4096)
+
+  " released blocks are read back from the swap file
+  call assert_equal(lines[: 999], getbufline(small, 1, '$'))
+  for buf in bufs
+    call assert_equal(lines, getbufline(buf, 1, '$'))
+  endfor
+
+  set nohidden maxmemtot&
+  for buf in bufs + [small]
+    exe 'bwipe! ' .. buf
+  endfor
+endfunc
+
+" Without a swap file blocks are compressed when 'maxmem' is reached.
+func Test_swap_memcompress()
+  set maxmem=100
+  let lines = map(range(1, 20000), {i, v -> 'line ' .. v .. ' ' .. repeat('x', v % 50)})
+  new
+  setlocal noswapfile
+  call setline(1, lines)
+  let info = getbufinfo('%')[0].memline
+  call assert_true(info.compressed > 0)
+  call assert_equal(0, info.evicted)
+  call assert_equal(lines, getline(1, '$'))
+
+  " changing compressed text
+  call setline(10, 'changed')
+  let lines[9] = 'changed'
+  call deletebufline('%', 15000, 15099)
+  call remove(lines, 14999, 15098)
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+
+  set nomemcompress
+  new
+  setlocal noswapfile
+  call setline(1, lines)
+  call assert_equal(0, getbufinfo('%')[0].memline.compressed)
+  call assert_equal(lines, getline(1, '$'))
+  bwipe!
+
+  set maxmem& memcompress&
+endfunc
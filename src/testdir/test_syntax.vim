@@ -531,6 +531,154 @@ func Test_synstack_synIDtrans()
   bw!
 endfunc
 
+" Check finding keywords, with and without matching case.
+func Test_syntax_keyword_lookup()
+  new
+  call setline(1, ['foo foobar fo food Bar BAR bar',
+	\ 'ÄPFEL äpfel Äpfelx', 'one two', 'two'])
+  syn keyword KwFoo foo food
+  syn case ignore
+  syn keyword KwBar bar
+  syn keyword KwApple äpfel
+  syn case match
+  syn keyword KwOne one nextgroup=KwTwo skipwhite
+  syn keyword KwTwo two contained
+  let Name = {l, c -> synIDattr(synID(l, c, 0), 'name')}
+
+  call assert_equal(['KwFoo', '', '', 'KwFoo', 'KwBar', 'KwBar', 'KwBar'],
+	\ map([1, 5, 12, 15, 20, 24, 28], {_, c -> Name(1, c)}))
+  call assert_equal(['KwApple', 'KwApple', ''],
+	\ map([1, 8, 15], {_, c -> Name(2, c)}))
+  call assert_equal(['KwOne', 'KwTwo', ''],
+	\ [Name(3, 1), Name(3, 5), Name(4, 1)])
+
+  " Adding and clearing keywords after they were used.
+  syn keyword KwFoo fo
+  call assert_equal('KwFoo', Name(1, 12))
+  syn clear KwFoo
+  call assert_equal(['', '', 'KwBar'], [Name(1, 1), Name(1, 12), Name(1, 20)])
+
+  syn clear
+  bwipe!
+endfunc
+
+" Patterns that cannot match in a line are skipped, matching starts where a
+" match can start.
+func Test_syntax_first_byte()
+  new
+  call setline(1, ['abc Foo fOO 12 xäy', 'nothing here', '=x=y'])
+  syn match FbFoo /foo/
+  syn match FbDigit /[0-9]\+/
+  syn match FbUml /ä/
+  syn match FbEnd /y$/
+  syn match FbOffset /=\zsx/
+  syn match FbAny /^n\|q/
+  let Name = {l, c -> synIDattr(synID(l, c, 1), 'name')}
+
+  call assert_equal(['', '', '', 'FbDigit', 'FbUml', ''],
+	\ map([1, 5, 9, 13, 17, 16], {_, c -> Name(1, c)}))
+  call assert_equal('FbEnd', Name(1, 19))
+  call assert_equal(['FbAny', ''], [Name(2, 1), Name(2, 2)])
+  call assert_equal(['', 'FbOffset', '', 'FbEnd'],
+	\ map(range(1, 4), {_, c -> Name(3, c)}))
+
+  syn case ignore
+  syn match FbFooIc /foo/
+  call assert_equal(['FbFooIc', 'FbFooIc'], [Name(1, 5), Name(1, 9)])
+
+  syn clear
+  bwipe!
+endfunc
+
+" Check compiled patterns are cached in 'syncachedir'.
+func Test_syntax_cache()
+  CheckOption syncachedir
+  call mkdir('Xsyncache')
+  set syncachedir=Xsyncache
+  let lines = ['syn match XcNumber /\<\d\+\>/',
+	\ 'syn region XcString start=/"/ end=/"/',
+	\ 'syn region XcHere start=/<<\z(\w\+\)$/ end=/^\z1$/',
+	\ 'syn keyword XcKeyword if else']
+  call writefile(lines, 'Xsyncache.vim')
+  new
+  call setline(1, ['if', '3a', '123', '"str"', '<<EOF', 'x', 'EOF', 'y'])
+  let Items = {-> map(range(1, 8), {_, l -> synIDattr(synID(l, 1, 1), 'name')})}
+  let expected = ['XcKeyword', '', 'XcNumber', 'XcString',
+	\ 'XcHere', 'XcHere', 'XcHere', '']
+
+  source Xsyncache.vim
+  call assert_equal(expected, Items())
+  let files = glob('Xsyncache/*', 0, 1)
+  call assert_equal(1, len(files))
+  call assert_match('Xsyncache.vim$', files[0])
+  let cache = readfile(files[0], 'B')
+
+  " Loading from the cache gives the same result and does not write it.
+  syn clear
+  source Xsyncache.vim
+  call assert_equal(expected, Items())
+  call assert_equal(cache, readfile(files[0], 'B'))
+
+  " Changing the script is noticed.
+  let lines[0] = 'syn match XcNumber /\d\+/'
+  call writefile(lines, 'Xsyncache.vim')
+  syn clear
+  source Xsyncache.vim
+  let expected[1] = 'XcNumber'
+  call assert_equal(expected, Items())
+  call assert_notequal(cache, readfile(files[0], 'B'))
+
+  " A damaged cache file is not used.
+  call writefile(readfile(files[0], 'B')[:100], files[0])
+  syn clear
+  source Xsyncache.vim
+  call assert_equal(expected, Items())
+  call writefile(0z00112233, files[0])
+  syn clear
+  source Xsyncache.vim
+  call assert_equal(expected, Items())
+
+  " Overwriting any field with a bogus value must not cause a crash or wrong
+  " highlighting.
+  let cache = readfile(files[0], 'B')
+  call assert_true(len(cache) > 100)
+  for val in [0x00, 0x7f, 0xff]
+    for idx in range(0, len(cache) - 4, 4)
+      let bad = copy(cache)
+      let bad[idx : idx + 3] = 0z00000000
+      for i in range(4)
+	let bad[idx + i] = val
+      endfor
+      if bad == cache
+	continue
+      endif
+      call writefile(bad, files[0])
+      syn clear
+      source Xsyncache.vim
+      call assert_equal(expected, Items(), 'offset ' .. idx)
+    endfor
+  endfor
+
+  " "~" uses the previous substitute string, the pattern is not cached.
+  call writefile(['syn match XcTilde /a~b/'], 'Xsyncache2.vim')
+  call setline(1, ['x', 'aZZb', 'aQQb'])
+  1s/x/ZZ/
+  source Xsyncache2.vim
+  call assert_equal(['', 'XcTilde', ''],
+	\ map(range(1, 3), {_, l -> synIDattr(synID(l, 1, 1), 'name')}))
+  1s/ZZ/QQ/
+  syn clear
+  source Xsyncache2.vim
+  call assert_equal(['', '', 'XcTilde'],
+	\ map(range(1, 3), {_, l -> synIDattr(synID(l, 1, 1), 'name')}))
+
+  set syncachedir&
+  bwipe!
+  call delete('Xsyncache2.vim')
+  call delete('Xsyncache.vim')
+  call delete('Xsyncache', 'rf')
+endfunc
+
 " Check highlighting for a small piece of C code with a screen dump.
 func Test_syntax_c()
   if !CanRunVimInTerminal()
@@ -577,6 +725,67 @@ func Test_syntax_c()
   call delete('Xtest.c')
 endfun
 
+" Check that lines below the window are parsed while waiting for a key.
+func Test_syntax_idle_parse()
+  CheckRunVimInTerminal
+  CheckFeature profile
+  let lines = ['/* start'] + map(range(2000), '"line " .. v:val')
+	\ + ['end */', 'int x;']
+  call writefile(lines, 'Xidle.c')
+  let buf = RunVimInTerminal('Xidle.c', {})
+  call term_sendkeys(buf, ":syn clear | regtime on\r")
+  call term_sendkeys(buf, ":syn region Comment start=+/\\*+ end=+\\*/+\r")
+  call term_sendkeys(buf, ":syn keyword Type int | syn sync fromstart\r")
+
+  " The end pattern is tried in every line, without moving the cursor.
+  func s:EndCount(buf)
+    call term_sendkeys(a:buf, ":call writefile([max(map(regtimeinfo(), "
+	  \ .. "'v:val.count'))], 'Xidlecount')\r")
+    call term_wait(a:buf)
+    let l = filereadable('Xidlecount') ? readfile('Xidlecount') : []
+    return empty(l) ? 0 : l[0]
+  endfunc
+  call WaitForAssert({-> assert_inrange(2000, 100000, s:EndCount(buf))})
+
+  " The syntax at the end is found from the saved states.
+  call term_sendkeys(buf, ":call writefile([synIDattr(synID(2001, 1, 0), "
+	\ .. "'name'), synIDattr(synID(2003, 1, 0), 'name')], 'Xidlecount')\r")
+  call WaitForAssert({-> assert_equal(['Comment', 'Type'],
+	\ readfile('Xidlecount'))})
+
+  call StopVimInTerminal(buf)
+  delfunc s:EndCount
+  call delete('Xidle.c')
+  call delete('Xidlecount')
+endfunc
+
+" Check that lines drawn without highlighting for 'syndefer' are highlighted
+" while waiting for a key.
+func Test_syntax_defer()
+  CheckRunVimInTerminal
+  let line = repeat('word ', 400)
+  call writefile(repeat([line], 100), 'Xdefer')
+  let buf = RunVimInTerminal('Xdefer', {})
+  call term_sendkeys(buf, ":hi Slow ctermfg=red | set nowrap syndefer=1\r")
+  call term_sendkeys(buf, ":syn match Slow /\\%#=1\\<\\(w\\|o\\|r\\|d\\)\\+\\>/\r")
+
+  " Right after redrawing the last line is not highlighted yet.
+  call term_sendkeys(buf, ":redraw! | call writefile(map([1, 19], "
+	\ .. "'screenattr(v:val, 1)'), 'Xdeferattr')\r")
+  call WaitForAssert({-> assert_true(filereadable('Xdeferattr'))})
+  call WaitForAssert({-> assert_equal(2, len(readfile('Xdeferattr')))})
+  let attr = readfile('Xdeferattr')
+  call assert_notequal(attr[0], attr[1])
+
+  " Later it is.
+  call WaitForAssert({-> assert_equal(term_scrape(buf, 1)[0].fg,
+	\ term_scrape(buf, 19)[0].fg)})
+
+  call StopVimInTerminal(buf)
+  call delete('Xdefer')
+  call delete('Xdeferattr')
+endfunc
+
 " Using \z() in a region with NFA failing should not crash.
 func Test_syn_wrong_z_one()
   new
@@ -661,6 +661,8 @@ f_test_getvalue(typval_T *argvars, typval_T *rettv)
 
 	if (STRCMP(name, (char_u *)"need_fileinfo") == 0)
 	    rettv->vval.v_number = need_fileinfo;
+	else if (STRCMP(name, (char_u *)"swap_sync_pending") == 0)
+	    rettv->vval.v_number = mf_sync_pending();
 	else
 	    semsg(_(e_invarg2), name);
     }
@@ -728,6 +730,10 @@ f_test_override(typval_T *argvars, typval_T *rettv UNUSED)
 	    no_query_mouse_for_testing = val;
 	else if (STRCMP(name, (char_u *)"no_wait_return") == 0)
 	    no_wait_return = val;
+	else if (STRCMP(name, (char_u *)"swap_sync_hold") == 0)
+	    mf_sync_hold(val);
+	else if (STRCMP(name, (char_u *)"incsearch_time") == 0)
+	    incsearch_time_for_testing = val;
 	else if (STRCMP(name, (char_u *)"ALL") == 0)
 	{
 	    disable_char_avail_for_testing = FALSE;
@@ -735,6 +741,8 @@ f_test_override(typval_T *argvars, typval_T *rettv UNUSED)
 	    ignore_redraw_flag_for_testing = FALSE;
 	    nfa_fail_for_testing = FALSE;
 	    no_query_mouse_for_testing = FALSE;
+	    mf_sync_hold(FALSE);
+	    incsearch_time_for_testing = 0;
 	    if (save_starting >= 0)
 	    {
 		starting = save_starting;
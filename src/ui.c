@@ -276,6 +276,9 @@ inchar_loop(
     int		did_start_blocking = FALSE;
     long	wait_time;
     long	elapsed_time = 0;
+#ifdef FEAT_SYN_HL
+    int		syn_busy = FALSE;
+#endif
 #ifdef ELAPSED_FUNC
     elapsed_T	start_tv;
 
@@ -376,6 +379,19 @@ inchar_loop(
 	    // for a character, need to check often.
 	    wait_time = 100L;
 #endif
+#ifdef FEAT_SYN_HL
+	// Going to wait for the user to type something: use the time to
+	// highlight lines that were drawn without it and to parse syntax
+	// outside of the window, a bit at a time.  Only check for a character
+	// in between.
+	syn_busy = wtime < 0 && wait_time != 0 && (
+# ifdef SYN_TIME_LIMIT
+		syn_redraw_deferred() ||
+# endif
+		syn_idle_parse());
+	if (syn_busy)
+	    wait_time = 0L;
+#endif
 
 	// Wait for a character to be typed or another event, such as the winch
 	// signal or an event on the monitored file descriptors.
@@ -410,6 +426,9 @@ inchar_loop(
 #endif
 #ifdef MESSAGE_QUEUE
 		|| interrupted
+#endif
+#ifdef FEAT_SYN_HL
+		|| syn_busy
 #endif
 		|| wait_time > 0
 		|| (wtime < 0 && !did_start_blocking))
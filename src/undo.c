@@ -2633,6 +2633,7 @@ u_undoredo(int undo)
     visualinfo_T visualinfo;
     int		empty_buffer;		    /* buffer became empty */
     u_header_T	*curhead = curbuf->b_u_curhead;
+    char_u	**lines;
 
     /* Don't want autocommands using the undo structures here, they are
      * invalid till the end. */
@@ -2735,18 +2736,18 @@ u_undoredo(int undo)
 		}
 		break;
 	    }
-	    // delete backwards, it goes faster in most cases
-	    for (lnum = bot - 1, i = oldsize; --i >= 0; --lnum)
+	    for (lnum = bot - oldsize, i = 0; i < oldsize; ++i, ++lnum)
 	    {
 		// what can we do when we run out of memory?
 		if (u_save_line(&newarray[i], lnum) == FAIL)
 		    do_outofmem_msg((long_u)0);
-		// remember we deleted the last line in the buffer, and a
-		// dummy empty line will be inserted
-		if (curbuf->b_ml.ml_line_count == 1)
-		    empty_buffer = TRUE;
-		ml_delete(lnum, FALSE);
 	    }
+	    // remember we deleted the last line in the buffer, and a
+	    // dummy empty line will be inserted
+	    if (oldsize >= curbuf->b_ml.ml_line_count)
+		empty_buffer = TRUE;
+	    // delete the lines at once, whole blocks are freed
+	    ml_delete_many(bot - oldsize, oldsize, FALSE);
 	}
 	else
 	    newarray = NULL;
@@ -2759,7 +2760,24 @@ u_undoredo(int undo)
 	 */
 	if (newsize)
 	{
-	    for (lnum = top, i = 0; i < newsize; ++i, ++lnum)
+	    i = 0;
+	    if (!empty_buffer
+#ifdef FEAT_PROP_POPUP
+		    && !curbuf->b_has_textprop
+#endif
+		    && (lines = ALLOC_MULT(char_u *, newsize)) != NULL)
+	    {
+		// Without text properties the lines end in a NUL, append them
+		// at once.
+		for (i = 0; i < newsize; ++i)
+		    lines[i] = uep->ue_array[i].ul_line;
+		ml_append_many(curbuf, top, lines, (long)newsize, FALSE);
+		for (i = 0; i < newsize; ++i)
+		    vim_free(uep->ue_array[i].ul_line);
+		vim_free(lines);
+		i = newsize;
+	    }
+	    for (lnum = top + i; i < newsize; ++i, ++lnum)
 	    {
 		// If the file is empty, there is an empty line 1 that we
 		// should get rid of, by replacing it with the new line.
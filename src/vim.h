@@ -884,6 +884,8 @@ extern int (*dyn_libintl_wputenv)(const wchar_t *envstring);
 # define SST_FIX_STATES	 7	// size of sst_stack[].
 # define SST_DIST	 16	// normal distance between entries
 # define SST_INVALID	(synstate_T *)-1	// invalid syn_state pointer
+# define SYN_IDLE_MSEC	 10	// msec to parse syntax when idle, at a time
+# define SYN_IDLE_PAGES	 10	// window heights to parse above the window
 
 # define HL_CONTAINED	0x01	// not used on toplevel
 # define HL_TRANSP	0x02	// has no highlighting
@@ -1078,6 +1080,7 @@ extern int (*dyn_libintl_wputenv)(const wchar_t *envstring);
 #define MFS_STOP	2	// stop syncing when a character is available
 #define MFS_FLUSH	4	// flushed file to disk
 #define MFS_ZERO	8	// only write block 0
+#define MFS_ASYNC	16	// flush to disk in the background if possible
 
 // flags for buf_copy_options()
 #define BCO_ENTER	1	// going to enter the buffer